@@ -71,6 +71,11 @@ static PyObject* OpenMote_getState(OpenMote* self) {
    PyObject* scheduler_vars;
 #if SCHEDULER_DEBUG_ENABLE
    PyObject* scheduler_dbg;
+#if SCHEDULER_BACKPRESSURE
+   PyObject* numDropped;
+   PyObject* numCoalesced;
+   int       prio;
+#endif
 #endif
    
    returnVal = PyDict_New();
@@ -185,7 +190,18 @@ static PyObject* OpenMote_getState(OpenMote* self) {
    // scheduler_dbg
 #if SCHEDULER_DEBUG_ENABLE
    scheduler_dbg = PyDict_New();
-   // TODO
+   PyDict_SetItemString(scheduler_dbg, "numTasksCur", PyInt_FromLong(self->scheduler_dbg.numTasksCur));
+   PyDict_SetItemString(scheduler_dbg, "numTasksMax", PyInt_FromLong(self->scheduler_dbg.numTasksMax));
+#if SCHEDULER_BACKPRESSURE
+   numDropped   = PyList_New(SCHEDULER_NUM_PRIOS);
+   numCoalesced = PyList_New(SCHEDULER_NUM_PRIOS);
+   for (prio=0;prio<SCHEDULER_NUM_PRIOS;prio++) {
+      PyList_SetItem(numDropped,   prio, PyInt_FromLong(self->scheduler_dbg.numDropped[prio]));
+      PyList_SetItem(numCoalesced, prio, PyInt_FromLong(self->scheduler_dbg.numCoalesced[prio]));
+   }
+   PyDict_SetItemString(scheduler_dbg, "numDropped", numDropped);
+   PyDict_SetItemString(scheduler_dbg, "numCoalesced", numCoalesced);
+#endif
    PyDict_SetItemString(returnVal, "scheduler_dbg", scheduler_dbg);
 #endif
    return returnVal;
@@ -407,4 +423,22 @@ PyMODINIT_FUNC initREPLACE_BY_PROJ_NAME(void) {
       "OpenMote",
       (PyObject*)&openwsn_OpenMoteType
    );
+   
+   // report the size of a packet buffer, with and without the metadata which
+   // is only attached on demand
+   PyModule_AddIntConstant(
+      openwsn_module,
+      "SIZEOF_OPENQUEUEENTRY",
+      sizeof(OpenQueueEntry_t)
+   );
+   PyModule_AddIntConstant(
+      openwsn_module,
+      "SIZEOF_OPENQUEUEENTRY_WITH_METADATA",
+      sizeof(OpenQueueEntry_t)+sizeof(OpenQueueMetadata_t)
+   );
+   PyModule_AddIntConstant(
+      openwsn_module,
+      "SIZEOF_OPENQUEUE",
+      sizeof(openqueue_vars_t)
+   );
 }
@@ -10,6 +10,25 @@ Source: http://is.gd/o9RSPq
 #ifndef OPENWSN_AES128_H
 #define OPENWSN_AES128_H
 
+#include "opendefs.h"
+
+//=========================== typedef =========================================
+
+/**
+\brief Key context, i.e. the key schedule expanded once and used for many blocks.
+
+With the crypto engine, it is the secret key itself.
+*/
+typedef struct {
+#if BOARD_CRYPTOENGINE_ENABLED
+    uint8_t roundKeys[16];      // the crypto engine expands the key itself
+#elif BOARD_AES_TTABLE
+    uint32_t roundKeys[44];     // 11 round keys of 4 big-endian words
+#else
+    uint8_t roundKeys[176];     // 11 round keys of 16 octets
+#endif
+} aes128_ctx_t;
+
 //=========================== prototypes ======================================
 
 /**
@@ -21,4 +40,20 @@ Source: http://is.gd/o9RSPq
 */
 owerror_t aes128_enc(uint8_t *buffer, uint8_t *key);
 
+/**
+\brief Expand a secret key into a key context.
+\param[out] ctx Key context to initialize.
+\param[in] key Buffer containing the secret key (16 octets).
+*/
+void aes128_ctx_init(aes128_ctx_t *ctx, uint8_t *key);
+
+/**
+\brief AES encryption of a single 16-octet block with a previously expanded key.
+\param[in,out] buffer Single block plaintext. Will be overwritten by ciphertext.
+\param[in] ctx Key context initialized with aes128_ctx_init().
+
+\returns E_SUCCESS when the encryption was successful.
+*/
+owerror_t aes128_ctx_enc(uint8_t *buffer, aes128_ctx_t *ctx);
+
 #endif /* OPENWSN_AES128_H */
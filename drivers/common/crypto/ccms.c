@@ -14,37 +14,14 @@
 
 //=========================== defines =========================================
 
-
 //=========================== prototypes ======================================
 
-#if !BOARD_CRYPTOENGINE_ENABLED
-
-static owerror_t aes_cbc_mac(uint8_t *a,
-                             uint8_t len_a,
-                             uint8_t *m,
-                             uint8_t len_m,
-                             uint8_t *nonce,
-                             uint8_t key[16],
-                             uint8_t *mac,
-                             uint8_t len_mac,
-                             uint8_t l);
-
-static owerror_t aes_ctr_enc(uint8_t *m,
-                             uint8_t len_m,
-                             uint8_t *nonce,
-                             uint8_t key[16],
-                             uint8_t *mac,
-                             uint8_t len_mac,
-                             uint8_t l);
+static void ccms_absorb(aes128_ccms_state_t *state, uint8_t octet);
 
-owerror_t aes_cbc_enc_raw(uint8_t *buffer, uint8_t len, uint8_t key[16], uint8_t iv[16]);
-
-owerror_t aes_ctr_enc_raw(uint8_t *buffer, uint8_t len, uint8_t key[16], uint8_t iv[16]);
+static void ccms_pad(aes128_ccms_state_t *state);
 
 static void inc_counter(uint8_t *counter);
 
-#endif
-
 //=========================== public ==========================================
 
 owerror_t aes128_ccms_enc(uint8_t *a,
@@ -59,22 +36,11 @@ owerror_t aes128_ccms_enc(uint8_t *a,
 #if BOARD_CRYPTOENGINE_ENABLED
     return cryptoengine_aes_ccms_enc(a, len_a, m, len_m, nonce, l, key, len_mac);
 #else
-    uint8_t mac[CBC_MAX_MAC_SIZE];
+    aes128_ctx_t ctx;
 
-    if ((len_mac > CBC_MAX_MAC_SIZE) || (l != 2)) {
-        return E_FAIL;
-    }
+    aes128_ctx_init(&ctx, key);
 
-    if (aes_cbc_mac(a, len_a, m, *len_m, nonce, key, mac, len_mac, l) == E_SUCCESS) {
-        if (aes_ctr_enc(m, *len_m, nonce, key, mac, len_mac, l) == E_SUCCESS) {
-            memcpy(&m[*len_m], mac, len_mac);
-            *len_m += len_mac;
-
-            return E_SUCCESS;
-        }
-    }
-
-    return E_FAIL;
+    return aes128_ccms_ctx_enc(a, len_a, m, len_m, nonce, l, &ctx, len_mac);
 #endif
 }
 
@@ -90,251 +56,236 @@ owerror_t aes128_ccms_dec(uint8_t *a,
 #if BOARD_CRYPTOENGINE_ENABLED
     return cryptoengine_aes_ccms_dec(a, len_a, m, len_m, nonce, l, key, len_mac);
 #else
-    uint8_t mac[CBC_MAX_MAC_SIZE];
-    uint8_t orig_mac[CBC_MAX_MAC_SIZE];
+    aes128_ctx_t ctx;
+
+    aes128_ctx_init(&ctx, key);
+
+    return aes128_ccms_ctx_dec(a, len_a, m, len_m, nonce, l, &ctx, len_mac);
+#endif
+}
+
+owerror_t aes128_ccms_ctx_enc(uint8_t *a,
+                              uint8_t len_a,
+                              uint8_t *m,
+                              uint8_t *len_m,
+                              uint8_t *nonce,
+                              uint8_t l,
+                              aes128_ctx_t *ctx,
+                              uint8_t len_mac) {
+
+#if BOARD_CRYPTOENGINE_ENABLED
+    return cryptoengine_aes_ccms_enc(a, len_a, m, len_m, nonce, l, ctx->roundKeys, len_mac);
+#else
+    aes128_ccms_state_t state;
 
-    if ((len_mac > CBC_MAX_MAC_SIZE) || (l != 2)) {
+    if (aes128_ccms_init(&state, ctx, nonce, l, len_a, *len_m, len_mac, TRUE) == E_FAIL) {
         return E_FAIL;
     }
 
-    *len_m -= len_mac;
-    memcpy(mac, &m[*len_m], len_mac);
+    aes128_ccms_update_a(&state, a, len_a);
+    aes128_ccms_update_m(&state, m, *len_m);
 
-    if (aes_ctr_enc(m, *len_m, nonce, key, mac, len_mac, l) == E_SUCCESS) {
-        if (aes_cbc_mac(a, len_a, m, *len_m, nonce, key, orig_mac, len_mac, l) == E_SUCCESS) {
-            if (memcmp(mac, orig_mac, len_mac) == 0) {
-                return E_SUCCESS;
-            }
-        }
+    // the tag is appended to the ciphertext
+    if (aes128_ccms_final(&state, &m[*len_m]) == E_FAIL) {
+        return E_FAIL;
     }
+    *len_m += len_mac;
 
-    return E_FAIL;
+    return E_SUCCESS;
 #endif
 }
 
-//=========================== private =========================================
-#if !BOARD_CRYPTOENGINE_ENABLED
+owerror_t aes128_ccms_ctx_dec(uint8_t *a,
+                              uint8_t len_a,
+                              uint8_t *m,
+                              uint8_t *len_m,
+                              uint8_t *nonce,
+                              uint8_t l,
+                              aes128_ctx_t *ctx,
+                              uint8_t len_mac) {
 
-/**
-\brief CBC-MAC generation specific to CCM*.
-\param[in] a Pointer to the authentication only data.
-\param[in] len_a Length of authentication only data.
-\param[in] m Pointer to the data that is both authenticated and encrypted.
-\param[in] len_m Length of data that is both authenticated and encrypted.
-\param[in] nonce Buffer containing nonce (13 octets).
-\param[in] key Buffer containing the secret key (16 octets).
-\param[out] mac Buffer where the value of the CBC-MAC tag will be written.
-\param[in] len_mac Length of the CBC-MAC tag. Must be 4, 8 or 16 octets.
-\param[in] l CCM parameter L that allows selection of different nonce length.
-
-\returns E_SUCCESS when the generation was successful, E_FAIL otherwise. 
-*/
-static owerror_t aes_cbc_mac(uint8_t *a,
-                             uint8_t len_a,
-                             uint8_t *m,
-                             uint8_t len_m,
-                             uint8_t *nonce,
-                             uint8_t key[16],
-                             uint8_t *mac,
-                             uint8_t len_mac,
-                             uint8_t l) {
-
-    uint8_t pad_len;
-    uint8_t len;
-    uint8_t cbc_mac_iv[16];
-    uint8_t buffer[128 + 16 + 16]; // max buffer plus IV
-
-    // asserts here
-    if (!((len_mac == 0) || (len_mac == 4) || (len_mac == 8) || (len_mac == 16))) {
-        return E_FAIL;
-    }
+#if BOARD_CRYPTOENGINE_ENABLED
+    return cryptoengine_aes_ccms_dec(a, len_a, m, len_m, nonce, l, ctx->roundKeys, len_mac);
+#else
+    aes128_ccms_state_t state;
 
-    if ((len_a > 127) || (len_m > 127) || ((len_a + len_m) > 127)) {
+    if (*len_m < len_mac) {
         return E_FAIL;
     }
+    *len_m -= len_mac;
 
-    if (mac == 0) {
+    if (aes128_ccms_init(&state, ctx, nonce, l, len_a, *len_m, len_mac, FALSE) == E_FAIL) {
         return E_FAIL;
     }
 
-    memset(cbc_mac_iv, 0x00, 16); // CBC-MAC Initialization Vector is a zero string
+    aes128_ccms_update_a(&state, a, len_a);
+    aes128_ccms_update_m(&state, m, *len_m);
 
-    // IV: flags (1B) | SADDR (8B) | ASN (5B) | len(m) (2B)
-    // X0 xor IV in first 16 bytes of buffer: set buffer[:16] as IV)
-    buffer[0] = 0x00; // set flags to zero including reserved
-    buffer[0] |= 0x07 & (l - 1); // field L
-    // (len_mac - 2)/2 shifted left 3 times corresponds to (len_mac - 2) << 2
-    buffer[0] |= len_mac == 0 ? 0 : (0x07 & (len_mac - 2)) << 2; // field M
-    buffer[0] |= len_a != 0 ? 0x40 : 0; // field Adata
+    // the received tag follows the ciphertext
+    return aes128_ccms_final(&state, &m[*len_m]);
+#endif
+}
 
-    memcpy(&buffer[1], nonce, 13);
+owerror_t aes128_ccms_init(aes128_ccms_state_t *state,
+                           aes128_ctx_t *ctx,
+                           uint8_t *nonce,
+                           uint8_t l,
+                           uint16_t len_a,
+                           uint16_t len_m,
+                           uint8_t len_mac,
+                           bool encrypt) {
+
+    // CCM* tags are 0, 4, 8 or 16 octets, the other even sizes of CCM (RFC3610) are accepted as well
+    if ((len_mac == 2) || (len_mac > 16) || (len_mac & 0x01)) {
+        return E_FAIL;
+    }
 
-    if (l == 3) {
-        buffer[13] = 0;
+    if ((l != 2) || (len_a >= 0xff00)) {
+        return E_FAIL;
     }
 
-    buffer[14] = 0;
-    buffer[15] = len_m;
+    state->ctx = ctx;
+    state->len_a = len_a;
+    state->len_m = len_m;
+    state->len_mac = len_mac;
+    state->encrypt = encrypt;
 
-    len = 16;
-    // len(a)
+    // B0: flags (1B) | nonce (13B) | len(m) (2B)
+    state->x[0] = 0x00; // set flags to zero including reserved
+    state->x[0] |= 0x07 & (l - 1); // field L
+    // (len_mac - 2)/2 shifted left 3 times corresponds to (len_mac - 2) << 2
+    state->x[0] |= len_mac == 0 ? 0 : (0x07 & (len_mac - 2)) << 2; // field M
+    state->x[0] |= len_a != 0 ? 0x40 : 0; // field Adata
+    memcpy(&state->x[1], nonce, 13);
+    state->x[14] = (uint8_t)(len_m >> 8);
+    state->x[15] = (uint8_t) len_m;
+    // X1 = E(B0), the CBC-MAC IV is a zero string
+    aes128_ctx_enc(state->x, ctx);
+    state->pos_x = 0;
+
+    // len(a) is authenticated in front of a
     if (len_a > 0) {
-        buffer[16] = 0;
-        buffer[17] = len_a;
-        len += 2;
+        ccms_absorb(state, (uint8_t)(len_a >> 8));
+        ccms_absorb(state, (uint8_t) len_a);
     }
 
-    //  (((x >> 4) + 1)<<4) - x   or    16 - (x % 16) ?
-    // a + padding
-    pad_len = ((((len_a + len - 16) >> 4) + 1) << 4) - (len_a + len - 16);
-    pad_len = pad_len == 16 ? 0 : pad_len;
-    memcpy(&buffer[len], a, len_a);
-    len += len_a;
-    memset(&buffer[len], 0, pad_len);
-    len += pad_len;
+    // A1: flags (1B) | nonce (13B) | cnt (2B), A0 is kept for the tag
+    state->a[0] = 0x07 & (l - 1); // field L
+    memcpy(&state->a[1], nonce, 13);
+    state->a[14] = 0x00;
+    state->a[15] = 0x01;
+    state->pos_s = 16; // no key stream yet
+
+    return E_SUCCESS;
+}
+
+owerror_t aes128_ccms_update_a(aes128_ccms_state_t *state, uint8_t *a, uint16_t len) {
+    uint16_t i;
 
-    // m + padding
-    pad_len = (((len_m >> 4) + 1) << 4) - len_m;
-    pad_len = pad_len == 16 ? 0 : pad_len;
-    memcpy(&buffer[len], m, len_m);
-    len += len_m;
-    memset(&buffer[len], 0, pad_len);
-    len += pad_len;
+    if (len > state->len_a) {
+        return E_FAIL;
+    }
 
-    aes_cbc_enc_raw(buffer, len, key, cbc_mac_iv);
+    for (i = 0; i < len; i++) {
+        ccms_absorb(state, a[i]);
+    }
 
-    // copy MAC
-    memcpy(mac, &buffer[len - 16], len_mac);
+    state->len_a -= len;
+    if (state->len_a == 0) {
+        // a is padded to a block boundary
+        ccms_pad(state);
+    }
 
     return E_SUCCESS;
 }
 
-/**
-\brief Counter (CTR) mode encryption specific to IEEE 802.15.4E.
-\param[in,out] m Pointer to the data that is both authenticated and encrypted. Data is
-   overwritten by ciphertext (i.e. plaintext in case of inverse CCM*).
-\param[in] len_m Length of data that is both authenticated and encrypted.
-\param[in] nonce Buffer containing nonce (13 octets).
-\param[in] key Buffer containing the secret key (16 octets).
-\param[in,out] mac Buffer containing the unencrypted or encrypted CBC-MAC tag, which depends
-   on weather the function is called as part of CCM* forward or inverse transformation. It
-   is overwrriten by the encrypted, i.e unencrypted, tag on return.
-\param[in] len_mac Length of the CBC-MAC tag. Must be 4, 8 or 16 octets.
-\param[in] l CCM parameter L that allows selection of different nonce length.
-
-\returns E_SUCCESS when the encryption was successful, E_FAIL otherwise. 
-*/
-static owerror_t aes_ctr_enc(uint8_t *m,
-                             uint8_t len_m,
-                             uint8_t *nonce,
-                             uint8_t key[16],
-                             uint8_t *mac,
-                             uint8_t len_mac,
-                             uint8_t l) {
-
-    uint8_t pad_len;
-    uint8_t len;
-    uint8_t iv[16];
-    uint8_t buffer[128 + 16]; // max buffer plus mac
-
-    // asserts here
-    if (!((len_mac == 0) || (len_mac == 4) || (len_mac == 8) || (len_mac == 16))) {
+owerror_t aes128_ccms_update_m(aes128_ccms_state_t *state, uint8_t *m, uint16_t len) {
+    uint16_t i;
+
+    if (state->len_a != 0 || len > state->len_m) {
         return E_FAIL;
     }
 
-    if (len_m > 127) {
-        return E_FAIL;
+    for (i = 0; i < len; i++) {
+        if (state->pos_s == 16) {
+            // next key stream block
+            memcpy(state->s, state->a, 16);
+            aes128_ctx_enc(state->s, state->ctx);
+            inc_counter(state->a);
+            state->pos_s = 0;
+        }
+
+        // the MAC is always computed over the plaintext
+        if (state->encrypt) {
+            ccms_absorb(state, m[i]);
+            m[i] ^= state->s[state->pos_s++];
+        } else {
+            m[i] ^= state->s[state->pos_s++];
+            ccms_absorb(state, m[i]);
+        }
     }
 
-    // iv (flag (1B) | source addr (8B) | ASN (5B) | cnt (2B)
-    iv[0] = 0x00;
-    iv[0] |= 0x07 & (l - 1); // field L
+    state->len_m -= len;
+    if (state->len_m == 0) {
+        // m is padded to a block boundary
+        ccms_pad(state);
+    }
 
-    memcpy(&iv[1], nonce, 13);
-    iv[14] = 0x00;
-    iv[15] = 0x00;
+    return E_SUCCESS;
+}
 
-    // first block is mac
-    memcpy(buffer, mac, len_mac);
-    memset(&buffer[len_mac], 0, 16 - len_mac);
-    len = 16;
+owerror_t aes128_ccms_final(aes128_ccms_state_t *state, uint8_t *mac) {
+    uint8_t i;
+    uint8_t diff;
 
-    //  (((x >> 4) + 1)<<4) - x   or    16 - (x % 16) ?
-    // m + padding
-    pad_len = (((len_m >> 4) + 1) << 4) - len_m;
-    pad_len = pad_len == 16 ? 0 : pad_len;
-    memcpy(&buffer[len], m, len_m);
-    len += len_m;
-    memset(&buffer[len], 0, pad_len);
-    len += pad_len;
+    if (state->len_a != 0 || state->len_m != 0) {
+        return E_FAIL;
+    }
 
-    aes_ctr_enc_raw(buffer, len, key, iv);
+    // S0 = E(A0) encrypts the tag
+    state->a[14] = 0x00;
+    state->a[15] = 0x00;
+    aes128_ctx_enc(state->a, state->ctx);
 
-    memcpy(m, &buffer[16], len_m);
-    memcpy(mac, buffer, len_mac);
+    if (state->encrypt) {
+        for (i = 0; i < state->len_mac; i++) {
+            mac[i] = state->x[i] ^ state->a[i];
+        }
+        return E_SUCCESS;
+    }
 
-    return E_SUCCESS;
+    diff = 0;
+    for (i = 0; i < state->len_mac; i++) {
+        diff |= mac[i] ^ state->x[i] ^ state->a[i];
+    }
+
+    return diff == 0 ? E_SUCCESS : E_FAIL;
 }
 
-/**
-\brief Raw AES-CBC encryption.
-\param[in,out] buffer Message to be encrypted. Will be overwritten by ciphertext.
-\param[in] len Message length. Must be multiple of 16 octets.
-\param[in] key Buffer containing the secret key (16 octets).
-\param[in] iv Buffer containing the Initialization Vector (16 octets).
+//=========================== private =========================================
 
-\returns E_SUCCESS when the encryption was successful. 
+/**
+\brief Add one octet to the CBC-MAC.
+\param[in,out] state CCM* state.
+\param[in] octet Octet to authenticate.
 */
-owerror_t aes_cbc_enc_raw(uint8_t *buffer, uint8_t len, uint8_t key[16], uint8_t iv[16]) {
-    uint8_t n;
-    uint8_t k;
-    uint8_t nb;
-    uint8_t *pbuf;
-    uint8_t *pxor;
-
-    nb = len >> 4;
-    pxor = iv;
-    for (n = 0; n < nb; n++) {
-        pbuf = &buffer[16 * n];
-        // may be faster if vector are aligned to 4 bytes (use long instead char in xor)
-        for (k = 0; k < 16; k++) {
-            pbuf[k] ^= pxor[k];
-        }
-        aes128_enc(pbuf, key);
-        pxor = pbuf;
+static void ccms_absorb(aes128_ccms_state_t *state, uint8_t octet) {
+    state->x[state->pos_x++] ^= octet;
+    if (state->pos_x == 16) {
+        aes128_ctx_enc(state->x, state->ctx);
+        state->pos_x = 0;
     }
-    return E_SUCCESS;
 }
 
 /**
-\brief Raw AES-CTR encryption.
-\param[in,out] buffer Message to be encrypted. Will be overwritten by ciphertext.
-\param[in] len Message length. Must be multiple of 16 octets.
-\param[in] key Buffer containing the secret key (16 octets).
-\param[in] iv Buffer containing the Initialization Vector (16 octets).
-
-\returns E_SUCCESS when the encryption was successful. 
+\brief Complete the current CBC-MAC block with zeros.
+\param[in,out] state CCM* state.
 */
-owerror_t aes_ctr_enc_raw(uint8_t *buffer, uint8_t len, uint8_t key[16], uint8_t iv[16]) {
-    uint8_t n;
-    uint8_t k;
-    uint8_t nb;
-    uint8_t *pbuf;
-    uint8_t eiv[16];
-
-    nb = len >> 4;
-    for (n = 0; n < nb; n++) {
-        pbuf = &buffer[16 * n];
-        memcpy(eiv, iv, 16);
-        aes128_enc(eiv, key);
-        // may be faster if vector are aligned to 4 bytes (use long instead char in xor)
-        for (k = 0; k < 16; k++) {
-            pbuf[k] ^= eiv[k];
-        }
-        inc_counter(iv);
+static void ccms_pad(aes128_ccms_state_t *state) {
+    if (state->pos_x != 0) {
+        aes128_ctx_enc(state->x, state->ctx);
+        state->pos_x = 0;
     }
-
-    return E_SUCCESS;
 }
 
 static void inc_counter(uint8_t *counter) {
@@ -349,5 +300,3 @@ static void inc_counter(uint8_t *counter) {
         if (c) return;
     } while (n);
 }
-
-#endif
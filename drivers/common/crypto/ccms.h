@@ -7,6 +7,29 @@
 #ifndef OPENWSN_CCMS_H
 #define OPENWSN_CCMS_H
 
+#include "aes128.h"
+
+//=========================== typedef =========================================
+
+/**
+\brief State of an incremental CCM* transformation.
+
+The CBC-MAC and the CTR encryption are computed in the same pass, one octet at a time, so
+the data may be handed over in pieces of any length and is transformed in place.
+*/
+typedef struct {
+    aes128_ctx_t *ctx;
+    uint8_t x[16];      // CBC-MAC chaining value
+    uint8_t a[16];      // counter block
+    uint8_t s[16];      // current key stream block
+    uint16_t len_a;     // authentication only data still expected
+    uint16_t len_m;     // data to encrypt or decrypt still expected
+    uint8_t pos_x;      // octets already added to the current CBC-MAC block
+    uint8_t pos_s;      // octets already used from the key stream block
+    uint8_t len_mac;
+    bool encrypt;
+} aes128_ccms_state_t;
+
 //=========================== prototypes ======================================
 
 /**
@@ -60,4 +83,97 @@ owerror_t aes128_ccms_dec(uint8_t *a,
                           uint8_t key[16],
                           uint8_t len_mac);
 
+/**
+\brief CCM* forward transformation with a previously expanded key. Same as aes128_ccms_enc(),
+   but the key schedule is not recomputed for every block.
+\param[in] ctx Key context initialized with aes128_ctx_init().
+
+See aes128_ccms_enc() for the other parameters.
+
+\returns E_SUCCESS when the generation was successful, E_FAIL otherwise.
+*/
+owerror_t aes128_ccms_ctx_enc(uint8_t *a,
+                              uint8_t len_a,
+                              uint8_t *m,
+                              uint8_t *len_m,
+                              uint8_t *nonce,
+                              uint8_t l,
+                              aes128_ctx_t *ctx,
+                              uint8_t len_mac);
+
+/**
+\brief CCM* inverse transformation with a previously expanded key. Same as aes128_ccms_dec(),
+   but the key schedule is not recomputed for every block.
+\param[in] ctx Key context initialized with aes128_ctx_init().
+
+See aes128_ccms_dec() for the other parameters.
+
+\returns E_SUCCESS when decryption and verification were successful, E_FAIL otherwise.
+*/
+owerror_t aes128_ccms_ctx_dec(uint8_t *a,
+                              uint8_t len_a,
+                              uint8_t *m,
+                              uint8_t *len_m,
+                              uint8_t *nonce,
+                              uint8_t l,
+                              aes128_ctx_t *ctx,
+                              uint8_t len_mac);
+
+/**
+\brief Start an incremental CCM* transformation.
+
+The data is then handed over with aes128_ccms_update_a() and aes128_ccms_update_m(), in
+this order, and the transformation is completed with aes128_ccms_final().
+
+\param[out] state State to initialize.
+\param[in] ctx Key context initialized with aes128_ctx_init().
+\param[in] nonce Buffer containing nonce (13 octets).
+\param[in] l CCM parameter L. This implementation supports l = 2 only.
+\param[in] len_a Total length of authentication only data.
+\param[in] len_m Total length of data that is both authenticated and encrypted, without the tag.
+\param[in] len_mac Length of the authentication tag. Must be 0, 4, 6, 8, 10, 12, 14 or 16 octets.
+\param[in] encrypt TRUE for the forward transformation, FALSE for the inverse one.
+
+\returns E_SUCCESS when the parameters are supported, E_FAIL otherwise.
+*/
+owerror_t aes128_ccms_init(aes128_ccms_state_t *state,
+                           aes128_ctx_t *ctx,
+                           uint8_t *nonce,
+                           uint8_t l,
+                           uint16_t len_a,
+                           uint16_t len_m,
+                           uint8_t len_mac,
+                           bool encrypt);
+
+/**
+\brief Authenticate the next piece of authentication only data.
+\param[in,out] state State initialized with aes128_ccms_init().
+\param[in] a Pointer to the piece of authentication only data.
+\param[in] len Length of the piece.
+
+\returns E_SUCCESS when the piece was processed, E_FAIL if it exceeds len_a.
+*/
+owerror_t aes128_ccms_update_a(aes128_ccms_state_t *state, uint8_t *a, uint16_t len);
+
+/**
+\brief Encrypt (or decrypt) and authenticate the next piece of data, in place.
+\param[in,out] state State initialized with aes128_ccms_init().
+\param[in,out] m Pointer to the piece of data. Overwritten by ciphertext (or plaintext).
+\param[in] len Length of the piece.
+
+\returns E_SUCCESS when the piece was processed, E_FAIL if authentication only data is still
+   expected or if the piece exceeds len_m.
+*/
+owerror_t aes128_ccms_update_m(aes128_ccms_state_t *state, uint8_t *m, uint16_t len);
+
+/**
+\brief Complete an incremental CCM* transformation.
+\param[in,out] state State in which all of the announced data was processed.
+\param[in,out] mac In the forward transformation, buffer where the authentication tag is
+   written. In the inverse transformation, the received tag to verify.
+
+\returns E_SUCCESS when the tag was written or is valid, E_FAIL otherwise.
+*/
+owerror_t aes128_ccms_final(aes128_ccms_state_t *state, uint8_t *mac);
+
 #endif /* OPENWSN_CCMS_H */
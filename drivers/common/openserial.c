@@ -398,6 +398,14 @@ void task_openserial_debugPrint(void) {
             if (debugPrint_msf() == TRUE) {
                 break;
             }
+        case STATUS_TASKPROFILE:
+            if (debugPrint_taskProfile() == TRUE) {
+                break;
+            }
+        case STATUS_QUEUESTATS:
+            if (debugPrint_queueStats() == TRUE) {
+                break;
+            }
         default:
             debugPrintCounter = 0;
     }
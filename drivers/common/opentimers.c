@@ -17,6 +17,14 @@ at most MAX_NUM_TIMERS timers.
 
 //=========================== define ==========================================
 
+#if OPENTIMERS_TOLERANCE_MS
+#define OPENTIMERS_NO_PENDING_TASK 0xff
+#endif
+
+#if OPENTIMERS_HEAP
+#define OPENTIMERS_NOT_IN_HEAP     0xff
+#endif
+
 //=========================== variables =======================================
 
 opentimers_vars_t opentimers_vars;
@@ -24,6 +32,22 @@ opentimers_vars_t opentimers_vars;
 //=========================== prototypes ======================================
 
 void  opentimers_timer_callback(void);
+static void opentimers_pushTask(opentimers_id_t id);
+#if OPENTIMERS_TOLERANCE_MS
+static void opentimers_coalesce(opentimers_id_t id);
+static void opentimers_pushPendingTask(void);
+static void opentimers_task_tolerant(void);
+#endif
+#if OPENTIMERS_HEAP
+static bool opentimers_heap_isEarlier(opentimers_id_t a, opentimers_id_t b);
+static void opentimers_heap_swap(uint8_t i, uint8_t j);
+static void opentimers_heap_siftUp(uint8_t index);
+static void opentimers_heap_siftDown(uint8_t index);
+static void opentimers_heap_insert(opentimers_id_t id);
+static void opentimers_heap_remove(opentimers_id_t id);
+static void opentimers_heap_schedule(opentimers_id_t id);
+static void opentimers_timer_expire(opentimers_id_t id);
+#endif
 
 //=========================== public ==========================================
 
@@ -33,9 +57,20 @@ void  opentimers_timer_callback(void);
 Initializes data structures and hardware timer.
  */
 void opentimers_init(void){
+#if OPENTIMERS_HEAP
+    uint8_t i;
+#endif
 
     // initialize local variables
     memset(&opentimers_vars,0,sizeof(opentimers_vars_t));
+#if OPENTIMERS_TOLERANCE_MS
+    opentimers_vars.pendingPrio = OPENTIMERS_NO_PENDING_TASK;
+#endif
+#if OPENTIMERS_HEAP
+    for (i=0;i<MAX_NUM_TIMERS;i++){
+        opentimers_vars.timersBuf[i].heapIndex = OPENTIMERS_NOT_IN_HEAP;
+    }
+#endif
 
     // set callback for sctimer module
     sctimer_set_callback(opentimers_timer_callback);
@@ -100,9 +135,11 @@ void opentimers_scheduleIn(opentimers_id_t    id,
                            timer_type_t       timer_type,
                            opentimers_cbt     cb){
     uint8_t  i;
+#if !OPENTIMERS_HEAP
     uint8_t  idToSchedule;
     PORT_TIMER_WIDTH timerGap;
     PORT_TIMER_WIDTH tempTimerGap;
+#endif
 
     INTERRUPT_DECLARATION();
     // 1. make sure the timer exist
@@ -137,12 +174,24 @@ void opentimers_scheduleIn(opentimers_id_t    id,
     } else {
         opentimers_vars.timersBuf[id].currentCompareValue = MAX_TICKS_IN_SINGLE_CLOCK+sctimer_readCounter();
     }
+#if OPENTIMERS_TOLERANCE_MS
+    opentimers_coalesce(id);
+#endif
 
     opentimers_vars.timersBuf[id].isrunning           = TRUE;
     opentimers_vars.timersBuf[id].callback            = cb;
 
     // 3. find the next timer to fire
 
+#if OPENTIMERS_HEAP
+    opentimers_heap_schedule(id);
+
+    // only execute update the currentCompareValue if I am not inside of ISR or the ISR itself will do this.
+    if (opentimers_vars.insideISR==FALSE){
+        opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[opentimers_vars.heap[0]].currentCompareValue;
+        sctimer_setCompare(opentimers_vars.currentCompareValue);
+    }
+#else
     // only execute update the currentCompareValue if I am not inside of ISR or the ISR itself will do this.
     if (opentimers_vars.insideISR==FALSE){
         i = 0;
@@ -166,6 +215,7 @@ void opentimers_scheduleIn(opentimers_id_t    id,
         opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[idToSchedule].currentCompareValue;
         sctimer_setCompare(opentimers_vars.currentCompareValue);
     }
+#endif
     opentimers_vars.running        = TRUE;
 
     ENABLE_INTERRUPTS();
@@ -190,9 +240,11 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
                                  time_type_t        uint_type,
                                  opentimers_cbt     cb){
     uint8_t  i;
+#if !OPENTIMERS_HEAP
     uint8_t idToSchedule;
     PORT_TIMER_WIDTH timerGap;
     PORT_TIMER_WIDTH tempTimerGap;
+#endif
 
     INTERRUPT_DECLARATION();
 
@@ -229,12 +281,24 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
     } else {
         opentimers_vars.timersBuf[id].currentCompareValue = MAX_TICKS_IN_SINGLE_CLOCK+reference;
     }
+#if OPENTIMERS_TOLERANCE_MS
+    opentimers_coalesce(id);
+#endif
 
     opentimers_vars.timersBuf[id].isrunning = TRUE;
     opentimers_vars.timersBuf[id].callback  = cb;
 
     // 3. find the next timer to fire
 
+#if OPENTIMERS_HEAP
+    opentimers_heap_schedule(id);
+
+    // only execute update the currentCompareValue if I am not inside of ISR or the ISR itself will do this.
+    if (opentimers_vars.insideISR==FALSE){
+        opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[opentimers_vars.heap[0]].currentCompareValue;
+        sctimer_setCompare(opentimers_vars.currentCompareValue);
+    }
+#else
     // only execute update the currentCompareValue if I am not inside of ISR or the ISR itself will do this.
     if (opentimers_vars.insideISR==FALSE){
         i = 0;
@@ -258,6 +322,7 @@ void opentimers_scheduleAbsolute(opentimers_id_t    id,
         opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[idToSchedule].currentCompareValue;
         sctimer_setCompare(opentimers_vars.currentCompareValue);
     }
+#endif
     opentimers_vars.running = TRUE;
 
     ENABLE_INTERRUPTS();
@@ -280,11 +345,63 @@ void opentimers_updateDuration(opentimers_id_t id, PORT_TIMER_WIDTH duration){
     ENABLE_INTERRUPTS();
 }
 
+/**
+\brief allow a timer to fire late, so its expiry can be coalesced with others.
+
+A timer with a tolerance fires at most tolerance after its nominal expiry. Its
+compare value is aligned on a grid of the largest power of two not exceeding
+the tolerance, or on the next armed compare value if that falls inside the
+window, so that timers with overlapping windows share one compare interrupt.
+The tolerant timers expiring in the same interrupt are called from a single
+task, pushed with the highest priority among them.
+
+The tolerance applies from the next schedule of the timer. It is ignored for
+the TSCH and inhibit timers, which always stay exact. A tolerance of 0 makes
+the timer exact again. Without OPENTIMERS_TOLERANCE_MS, coalescing is compiled
+out and this function does nothing.
+
+\param[in] id the timer id
+\param[in] tolerance how late the timer is allowed to fire
+\param[in] uint_type indicates the unit type of the tolerance: ticks or ms
+ */
+void opentimers_setTolerance(opentimers_id_t id, uint32_t tolerance, time_type_t uint_type){
+#if OPENTIMERS_TOLERANCE_MS
+    PORT_TIMER_WIDTH grid;
+
+    INTERRUPT_DECLARATION();
+
+    if (id<TIMER_NUMBER_NON_GENERAL || id>=MAX_NUM_TIMERS){
+        return;
+    }
+
+    if (uint_type==TIME_MS){
+        tolerance *= PORT_TICS_PER_MS;
+    }
+    if (tolerance>MAX_TICKS_IN_SINGLE_CLOCK){
+        tolerance = MAX_TICKS_IN_SINGLE_CLOCK;
+    }
+
+    // largest power of two not exceeding the tolerance
+    grid = 1;
+    while (grid<=(tolerance>>1)){
+        grid <<= 1;
+    }
+
+    DISABLE_INTERRUPTS();
+
+    opentimers_vars.timersBuf[id].tolerance     = (PORT_TIMER_WIDTH)tolerance;
+    opentimers_vars.timersBuf[id].toleranceMask = (tolerance==0)?0:grid-1;
+
+    ENABLE_INTERRUPTS();
+#endif
+}
+
 /**
 \brief cancel a running timer.
 
 This function disable the timer temperally by removing its callback and marking
-isrunning as false. The timer may be recover later.
+isrunning as false. The timer may be recover later. A tolerant timer which has
+expired but has not been called yet by the coalesced task is not called.
 
 \param[in] id the timer id
  */
@@ -295,6 +412,12 @@ void opentimers_cancel(opentimers_id_t id){
 
     opentimers_vars.timersBuf[id].isrunning = FALSE;
     opentimers_vars.timersBuf[id].callback  = NULL;
+#if OPENTIMERS_TOLERANCE_MS
+    opentimers_vars.timersBuf[id].isPending = FALSE;
+#endif
+#if OPENTIMERS_HEAP
+    opentimers_heap_remove(id);
+#endif
 
     ENABLE_INTERRUPTS();
 }
@@ -309,8 +432,18 @@ Reset the whole entry of given timer including the id.
 \returns False if the given can't be found or return Success
  */
 bool opentimers_destroy(opentimers_id_t id){
+    INTERRUPT_DECLARATION();
+
     if (id<MAX_NUM_TIMERS){
+        DISABLE_INTERRUPTS();
+#if OPENTIMERS_HEAP
+        opentimers_heap_remove(id);
+#endif
         memset(&opentimers_vars.timersBuf[id],0,sizeof(opentimers_t));
+#if OPENTIMERS_HEAP
+        opentimers_vars.timersBuf[id].heapIndex = OPENTIMERS_NOT_IN_HEAP;
+#endif
+        ENABLE_INTERRUPTS();
         return TRUE;
     } else {
         return FALSE;
@@ -347,6 +480,96 @@ bool opentimers_isRunning(opentimers_id_t id){
 
 // ========================== callback ========================================
 
+#if OPENTIMERS_HEAP
+/**
+\brief this is the callback function of opentimer.
+
+This function is called when sctimer interrupt happens. The timers responding
+to the interrupt are popped from the top of the heap, the next timer to be
+fired is then found at the top of the heap.
+ */
+void opentimers_timer_callback(void){
+    opentimers_id_t expired[MAX_NUM_TIMERS];
+    uint8_t         numExpired;
+    uint8_t         i;
+    opentimers_id_t id;
+
+    if (
+        opentimers_vars.timersBuf[TIMER_INHIBIT].isrunning==TRUE &&
+        opentimers_vars.currentCompareValue == opentimers_vars.timersBuf[TIMER_INHIBIT].currentCompareValue
+    ){
+        opentimers_vars.timersBuf[TIMER_INHIBIT].isrunning  = FALSE;
+        opentimers_heap_remove(TIMER_INHIBIT);
+        opentimers_vars.timersBuf[TIMER_INHIBIT].callback(TIMER_INHIBIT);
+        // the next timer selection will be done after SPLITE_TIMER_DURATION ticks
+        sctimer_setCompare(sctimer_readCounter()+SPLITE_TIMER_DURATION);
+        return;
+    }
+
+    numExpired = 0;
+    if (opentimers_vars.timersBuf[TIMER_INHIBIT].currentCompareValue == opentimers_vars.currentCompareValue){
+        // this is the timer interrupt right after inhibit timer, pre call the non-tsch, non-inhibit timer interrupt here to avoid interrupt during receiving serial bytes
+        // timers already due sort before the window, pop them too so the heap top does not hide the timers behind them
+        while (
+            opentimers_vars.heapSize>0 &&
+            (
+                (PORT_TIMER_WIDTH)(opentimers_vars.timersBuf[opentimers_vars.heap[0]].currentCompareValue - opentimers_vars.currentCompareValue) < PRE_CALL_TIMER_WINDOW ||
+                (PORT_TIMER_WIDTH)(opentimers_vars.currentCompareValue - opentimers_vars.timersBuf[opentimers_vars.heap[0]].currentCompareValue) <= MAX_TICKS_IN_SINGLE_CLOCK
+            )
+        ){
+            id = opentimers_vars.heap[0];
+            opentimers_heap_remove(id);
+            expired[numExpired++] = id;
+        }
+        for (i=0;i<numExpired;i++){
+            if (expired[i]!=TIMER_TSCH && expired[i]!=TIMER_INHIBIT){
+                opentimers_vars.timersBuf[expired[i]].currentCompareValue = opentimers_vars.currentCompareValue;
+            }
+            opentimers_heap_insert(expired[i]);
+        }
+    }
+
+    // pop all timers which are due
+    numExpired = 0;
+    while (
+        opentimers_vars.heapSize>0 &&
+        (PORT_TIMER_WIDTH)(opentimers_vars.currentCompareValue - opentimers_vars.timersBuf[opentimers_vars.heap[0]].currentCompareValue) <= MAX_TICKS_IN_SINGLE_CLOCK
+    ){
+        id = opentimers_vars.heap[0];
+        opentimers_heap_remove(id);
+        expired[numExpired++] = id;
+    }
+
+    // the TSCH timer is time critical, handle it first
+    for (i=1;i<numExpired;i++){
+        if (expired[i]==TIMER_TSCH){
+            expired[i] = expired[0];
+            expired[0] = TIMER_TSCH;
+            break;
+        }
+    }
+
+    for (i=0;i<numExpired;i++){
+        if (opentimers_vars.timersBuf[expired[i]].heapIndex!=OPENTIMERS_NOT_IN_HEAP){
+            // this timer was re-scheduled by a previous callback
+            continue;
+        }
+        opentimers_timer_expire(expired[i]);
+    }
+#if OPENTIMERS_TOLERANCE_MS
+    opentimers_pushPendingTask();
+#endif
+    opentimers_vars.lastCompareValue = opentimers_vars.currentCompareValue;
+
+    // the next timer to be fired is on top of the heap
+    if (opentimers_vars.heapSize>0){
+        opentimers_vars.currentCompareValue = opentimers_vars.timersBuf[opentimers_vars.heap[0]].currentCompareValue;
+        sctimer_setCompare(opentimers_vars.currentCompareValue);
+    } else {
+        opentimers_vars.running        = FALSE;
+    }
+}
+#else
 /**
 \brief this is the callback function of opentimer.
 
@@ -393,7 +616,7 @@ void opentimers_timer_callback(void){
                     } else {
                         if (opentimers_vars.timersBuf[i].wraps_remaining==0){
                             opentimers_vars.timersBuf[i].isrunning = FALSE;
-                            scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[i].callback),(task_prio_t)opentimers_vars.timersBuf[i].timer_task_prio);
+                            opentimers_pushTask(i);
                             if (opentimers_vars.timersBuf[i].timerType==TIMER_PERIODIC){
                                 opentimers_vars.insideISR = TRUE;
                                 opentimers_scheduleIn(
@@ -412,7 +635,7 @@ void opentimers_timer_callback(void){
                                 if (opentimers_vars.timersBuf[i].currentCompareValue - opentimers_vars.currentCompareValue < PRE_CALL_TIMER_WINDOW){
                                     // pre-call the timer here if it will be fired within PRE_CALL_TIMER_WINDOW, when wraps_remaining decrease to 0
                                     opentimers_vars.timersBuf[i].isrunning  = FALSE;
-                                    scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[i].callback),(task_prio_t)opentimers_vars.timersBuf[i].timer_task_prio);
+                                    opentimers_pushTask(i);
                                     if (opentimers_vars.timersBuf[i].timerType==TIMER_PERIODIC){
                                         opentimers_vars.insideISR = TRUE;
                                         opentimers_scheduleIn(
@@ -434,6 +657,9 @@ void opentimers_timer_callback(void){
             }
         }
     }
+#if OPENTIMERS_TOLERANCE_MS
+    opentimers_pushPendingTask();
+#endif
     opentimers_vars.lastCompareValue = opentimers_vars.currentCompareValue;
 
     // find the next timer to be fired
@@ -460,4 +686,238 @@ void opentimers_timer_callback(void){
     } else {
         opentimers_vars.running        = FALSE;
     }
-}
\ No newline at end of file
+}
+#endif
+
+//=========================== private =========================================
+
+#if OPENTIMERS_TOLERANCE_MS
+/**
+\brief move the compare value of a tolerant timer inside its tolerance window.
+ */
+static void opentimers_coalesce(opentimers_id_t id){
+    PORT_TIMER_WIDTH compare;
+
+    if (
+        opentimers_vars.timersBuf[id].tolerance==0 ||
+        opentimers_vars.timersBuf[id].wraps_remaining>0
+    ){
+        return;
+    }
+
+    compare = opentimers_vars.timersBuf[id].currentCompareValue;
+
+    if (
+        opentimers_vars.running==TRUE && opentimers_vars.insideISR==FALSE &&
+        (PORT_TIMER_WIDTH)(opentimers_vars.currentCompareValue-compare) <= opentimers_vars.timersBuf[id].tolerance
+    ){
+        // share the interrupt which is already armed
+        opentimers_vars.timersBuf[id].currentCompareValue = opentimers_vars.currentCompareValue;
+    } else {
+        // the last grid point inside [compare, compare+tolerance]
+        opentimers_vars.timersBuf[id].currentCompareValue =
+            (compare+opentimers_vars.timersBuf[id].tolerance) & ~opentimers_vars.timersBuf[id].toleranceMask;
+    }
+}
+#endif
+
+/**
+\brief hand an expired timer over to the scheduler.
+
+Exact timers push their own task. Tolerant timers are marked pending and
+called by a single task pushed at the end of the interrupt.
+ */
+static void opentimers_pushTask(opentimers_id_t id){
+#if OPENTIMERS_TOLERANCE_MS
+    if (opentimers_vars.timersBuf[id].tolerance==0){
+        scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[id].callback),(task_prio_t)opentimers_vars.timersBuf[id].timer_task_prio);
+        return;
+    }
+    opentimers_vars.timersBuf[id].isPending = TRUE;
+    if (opentimers_vars.timersBuf[id].timer_task_prio<opentimers_vars.pendingPrio){
+        opentimers_vars.pendingPrio = opentimers_vars.timersBuf[id].timer_task_prio;
+    }
+#else
+    scheduler_push_task((task_cbt)(opentimers_vars.timersBuf[id].callback),(task_prio_t)opentimers_vars.timersBuf[id].timer_task_prio);
+#endif
+}
+
+#if OPENTIMERS_TOLERANCE_MS
+static void opentimers_pushPendingTask(void){
+    if (opentimers_vars.pendingPrio!=OPENTIMERS_NO_PENDING_TASK){
+        scheduler_push_task(opentimers_task_tolerant,(task_prio_t)opentimers_vars.pendingPrio);
+        opentimers_vars.pendingPrio = OPENTIMERS_NO_PENDING_TASK;
+    }
+}
+
+/**
+\brief call the tolerant timers which expired in the same interrupt.
+ */
+static void opentimers_task_tolerant(void){
+    opentimers_id_t id;
+    bool            isPending;
+
+    INTERRUPT_DECLARATION();
+
+    for (id=TIMER_NUMBER_NON_GENERAL;id<MAX_NUM_TIMERS;id++){
+        DISABLE_INTERRUPTS();
+        isPending = opentimers_vars.timersBuf[id].isPending;
+        opentimers_vars.timersBuf[id].isPending = FALSE;
+        ENABLE_INTERRUPTS();
+        if (isPending && opentimers_vars.timersBuf[id].callback!=NULL){
+            opentimers_vars.timersBuf[id].callback(id);
+        }
+    }
+}
+#endif
+
+#if OPENTIMERS_HEAP
+/**
+\brief handle the expiration of a timer popped from the heap.
+
+\param[in] id the timer id
+ */
+static void opentimers_timer_expire(opentimers_id_t id){
+    opentimers_vars.timersBuf[id].lastCompareValue = opentimers_vars.timersBuf[id].currentCompareValue;
+
+    if (id==TIMER_TSCH){
+        opentimers_vars.insideISR = TRUE;
+        opentimers_vars.timersBuf[id].isrunning  = FALSE;
+        opentimers_vars.timersBuf[id].callback(id);
+        opentimers_vars.insideISR = FALSE;
+        return;
+    }
+
+    if (opentimers_vars.timersBuf[id].wraps_remaining>0){
+        opentimers_vars.timersBuf[id].wraps_remaining--;
+        if (opentimers_vars.timersBuf[id].wraps_remaining>0){
+            opentimers_vars.timersBuf[id].currentCompareValue = opentimers_vars.timersBuf[id].lastCompareValue + MAX_TICKS_IN_SINGLE_CLOCK;
+            opentimers_heap_insert(id);
+            return;
+        }
+        opentimers_vars.timersBuf[id].currentCompareValue = (opentimers_vars.timersBuf[id].duration+opentimers_vars.timersBuf[id].lastCompareValue) & MAX_TICKS_IN_SINGLE_CLOCK;
+        if ((PORT_TIMER_WIDTH)(opentimers_vars.timersBuf[id].currentCompareValue - opentimers_vars.currentCompareValue) >= PRE_CALL_TIMER_WINDOW){
+            opentimers_heap_insert(id);
+            return;
+        }
+        // pre-call the timer here if it will be fired within PRE_CALL_TIMER_WINDOW, when wraps_remaining decrease to 0
+    }
+
+    opentimers_vars.timersBuf[id].isrunning = FALSE;
+    opentimers_pushTask(id);
+    if (opentimers_vars.timersBuf[id].timerType==TIMER_PERIODIC){
+        opentimers_vars.insideISR = TRUE;
+        opentimers_scheduleIn(
+            id,
+            opentimers_vars.timersBuf[id].duration,
+            TIME_TICS,
+            TIMER_PERIODIC,
+            opentimers_vars.timersBuf[id].callback
+        );
+        opentimers_vars.insideISR = FALSE;
+    }
+}
+
+/**
+\brief does timer a expire before timer b?
+
+Compare values are at most MAX_TICKS_IN_SINGLE_CLOCK apart, which makes the
+comparison safe across a counter wrap.
+ */
+static bool opentimers_heap_isEarlier(opentimers_id_t a, opentimers_id_t b){
+    return (PORT_TIMER_WIDTH)(
+        opentimers_vars.timersBuf[a].currentCompareValue -
+        opentimers_vars.timersBuf[b].currentCompareValue
+    ) > MAX_TICKS_IN_SINGLE_CLOCK;
+}
+
+static void opentimers_heap_swap(uint8_t i, uint8_t j){
+    opentimers_id_t id;
+
+    id                        = opentimers_vars.heap[i];
+    opentimers_vars.heap[i]   = opentimers_vars.heap[j];
+    opentimers_vars.heap[j]   = id;
+    opentimers_vars.timersBuf[opentimers_vars.heap[i]].heapIndex = i;
+    opentimers_vars.timersBuf[opentimers_vars.heap[j]].heapIndex = j;
+}
+
+static void opentimers_heap_siftUp(uint8_t index){
+    uint8_t parent;
+
+    while (index>0){
+        parent = (index-1)/2;
+        if (opentimers_heap_isEarlier(opentimers_vars.heap[index],opentimers_vars.heap[parent])==FALSE){
+            break;
+        }
+        opentimers_heap_swap(index,parent);
+        index = parent;
+    }
+}
+
+static void opentimers_heap_siftDown(uint8_t index){
+    uint16_t child;
+    uint8_t  smallest;
+
+    while (1){
+        smallest = index;
+        child    = 2*(uint16_t)index+1;
+        if (child<opentimers_vars.heapSize && opentimers_heap_isEarlier(opentimers_vars.heap[child],opentimers_vars.heap[smallest])){
+            smallest = (uint8_t)child;
+        }
+        child++;
+        if (child<opentimers_vars.heapSize && opentimers_heap_isEarlier(opentimers_vars.heap[child],opentimers_vars.heap[smallest])){
+            smallest = (uint8_t)child;
+        }
+        if (smallest==index){
+            break;
+        }
+        opentimers_heap_swap(index,smallest);
+        index = smallest;
+    }
+}
+
+static void opentimers_heap_insert(opentimers_id_t id){
+    uint8_t index;
+
+    index                                    = opentimers_vars.heapSize++;
+    opentimers_vars.heap[index]              = id;
+    opentimers_vars.timersBuf[id].heapIndex  = index;
+    opentimers_heap_siftUp(index);
+}
+
+static void opentimers_heap_remove(opentimers_id_t id){
+    uint8_t         index;
+    opentimers_id_t moved;
+
+    index = opentimers_vars.timersBuf[id].heapIndex;
+    if (index==OPENTIMERS_NOT_IN_HEAP){
+        return;
+    }
+    opentimers_vars.timersBuf[id].heapIndex = OPENTIMERS_NOT_IN_HEAP;
+
+    opentimers_vars.heapSize--;
+    if (index!=opentimers_vars.heapSize){
+        // move the last timer into the hole and restore the heap order
+        moved                                    = opentimers_vars.heap[opentimers_vars.heapSize];
+        opentimers_vars.heap[index]              = moved;
+        opentimers_vars.timersBuf[moved].heapIndex = index;
+        opentimers_heap_siftUp(index);
+        opentimers_heap_siftDown(opentimers_vars.timersBuf[moved].heapIndex);
+    }
+}
+
+/**
+\brief insert a timer in the heap, or move it after its compare value changed.
+ */
+static void opentimers_heap_schedule(opentimers_id_t id){
+    uint8_t index;
+
+    index = opentimers_vars.timersBuf[id].heapIndex;
+    if (index==OPENTIMERS_NOT_IN_HEAP){
+        opentimers_heap_insert(id);
+    } else {
+        opentimers_heap_siftUp(index);
+        opentimers_heap_siftDown(opentimers_vars.timersBuf[id].heapIndex);
+    }
+}
+#endif
@@ -19,12 +19,18 @@
 //=========================== define ==========================================
 
 /// Maximum number of timers that can run concurrently
+#ifndef MAX_NUM_TIMERS
 #define MAX_NUM_TIMERS             15
+#endif
 #define MAX_TICKS_IN_SINGLE_CLOCK  (uint32_t)(((PORT_TIMER_WIDTH)0xFFFFFFFF)>>1)
 #define ERROR_NO_AVAILABLE_ENTRIES 255
 #define MAX_DURATION_ISR           33 // 33@32768Hz = 1ms
 #define opentimers_id_t            uint8_t
 
+#if MAX_NUM_TIMERS >= ERROR_NO_AVAILABLE_ENTRIES
+#error "MAX_NUM_TIMERS must be smaller than ERROR_NO_AVAILABLE_ENTRIES."
+#endif
+
 #define TIMER_INHIBIT              0
 #define TIMER_TSCH                 1
 #define TIMER_GENERAL_PURPOSE      255
@@ -59,6 +65,14 @@ typedef struct {
    bool                 hasExpired;         // in case there are more than one interrupt occur at same time
    opentimers_cbt       callback;           // function to call when elapses
    uint8_t              timer_task_prio;    // when opentimer push a task, use timer_task_prio to mark the priority
+#if OPENTIMERS_TOLERANCE_MS
+   PORT_TIMER_WIDTH     tolerance;          // the timer may fire up to tolerance ticks late, 0 for an exact timer
+   PORT_TIMER_WIDTH     toleranceMask;      // expiries are aligned on a grid of toleranceMask+1 ticks
+   bool                 isPending;          // expired, waiting for the coalesced task to call it
+#endif
+#if OPENTIMERS_HEAP
+   uint8_t              heapIndex;          // position of this timer in the heap, valid while isrunning
+#endif
 } opentimers_t;
 
 //=========================== module variables ================================
@@ -69,6 +83,13 @@ typedef struct {
    PORT_TIMER_WIDTH     currentCompareValue;// current timeout, in ticks
    PORT_TIMER_WIDTH     lastCompareValue;   // last timeout, in ticks. This is the reference time to calculate the next to be expired timer.
    bool                 insideISR;          // whether the function of opentimer is called inside of ISR or not
+#if OPENTIMERS_TOLERANCE_MS
+   uint8_t              pendingPrio;        // priority of the coalesced task to push, OPENTIMERS_NO_PENDING_TASK if none
+#endif
+#if OPENTIMERS_HEAP
+   opentimers_id_t      heap[MAX_NUM_TIMERS];// running timers, min-heap on currentCompareValue
+   uint8_t              heapSize;           // number of running timers
+#endif
 } opentimers_vars_t;
 
 //=========================== prototypes ======================================
@@ -87,6 +108,9 @@ void             opentimers_scheduleAbsolute(opentimers_id_t      id,
                                               opentimers_cbt      cb);
 void             opentimers_updateDuration(opentimers_id_t id,
                                            PORT_TIMER_WIDTH duration);
+void             opentimers_setTolerance(opentimers_id_t id,
+                                         uint32_t        tolerance,
+                                         time_type_t     uint_type);
 void             opentimers_cancel(opentimers_id_t id);
 bool             opentimers_destroy(opentimers_id_t id);
 
@@ -118,4 +118,8 @@
 #error "CoAP requires a transport layer, i.e. UDP or TCP."
 #endif
 
+#if SCHEDULER_BACKPRESSURE && (SCHEDULER_RESERVE_LOW < SCHEDULER_RESERVE_STACK)
+#error "SCHEDULER_RESERVE_LOW must be at least SCHEDULER_RESERVE_STACK."
+#endif
+
 #endif /* OPENWSN_CHECK_CONFIG_H */
@@ -307,6 +307,64 @@
 #define DEADLINE_OPTION (0)
 #endif
 
+/**
+ * \def OPENQUEUE_AQM
+ *
+ * Active queue management in openqueue. It kicks in when a packet from a component above COMPONENT_SIXTOP_RES finds
+ * only the buffers reserved for high priority packets left, and may drop a relayed packet waiting for the MAC to make
+ * room for it. Packets created by this mote are never dropped, their creator waits for a sendDone.
+ *  - 0: the new packet is refused.
+ *  - 1 (head-drop): the oldest relayed packet is dropped. Meant for nodes close to the root, where relayed traffic
+ *    from large subtrees would otherwise starve local flows.
+ *  - 2 (fair): flows are relayed packets of the same IPv6 source, or packets of the same local component. The oldest
+ *    packet of the longest relayed flow is dropped when that flow holds more buffers than the flow of the new packet
+ *    would, otherwise the new packet is refused.
+ * With DEADLINE_OPTION, relayed packets past their expiration time with the drop flag set go first, in modes 1 and 2.
+ * Refusals and drops are counted and printed over serial as STATUS_QUEUESTATS.
+ *
+ */
+#ifndef OPENQUEUE_AQM
+#define OPENQUEUE_AQM (0)
+#endif
+
+/**
+ * \def SCHEDULE_SLOT_INDEX
+ *
+ * Next to the circular list of active slots, the schedule keeps a bitmap of the slot offsets in use and the row of
+ * scheduleBuf holding each of them. Looking a slot offset up (as the MAC does at the end of every slot and MSF does
+ * when picking cells) then takes constant time instead of a scan of scheduleBuf, which matters for large slotframes
+ * and a large MAXACTIVESLOTS. Costs SCHEDULE_INDEX_LENGTH * 9/8 bytes of RAM.
+ *
+ * Configuration options:
+ *  - SCHEDULE_INDEX_LENGTH: number of slot offsets indexed, SLOTFRAME_LENGTH by default. Cells can only be scheduled
+ *    below it.
+ */
+#ifndef SCHEDULE_SLOT_INDEX
+#define SCHEDULE_SLOT_INDEX (0)
+#endif
+
+/**
+ * \def SCHEDULE_NUM_SLOTFRAMES
+ *
+ * Number of slotframes the schedule runs at the same time. Slotframe 0 is the one advertised in EBs, it holds the
+ * minimal and autonomous cells. The others, with handles 1 and up, can be of any length and are created with
+ * schedule_addSlotframe(). When cells of several slotframes fall in the same slot, the cell of the slotframe with the
+ * lowest handle is used. The slot index of SCHEDULE_SLOT_INDEX only covers slotframe 0.
+ *
+ * Configuration options:
+ *  - MSF_SLOTFRAME_LENGTH: when not 0, MSF negotiates its cells in slotframe 1 of that length rather than in
+ *    slotframe 0, e.g. a short slotframe giving a flow a cell every few hundred milliseconds.
+ */
+#ifndef SCHEDULE_NUM_SLOTFRAMES
+#define SCHEDULE_NUM_SLOTFRAMES (1)
+#endif
+
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+#ifndef MSF_SLOTFRAME_LENGTH
+#define MSF_SLOTFRAME_LENGTH        0
+#endif
+#endif
+
 /**
  * \def ADAPTIVE_MSF
  *
@@ -333,6 +391,61 @@
 #endif
 #endif
 
+/**
+ * \def MSF_QUEUE_AWARE
+ *
+ * Size the negotiated Tx cells to the preferred parent after the packets queued to it, rather than after the cell
+ * usage. MSF adds the cells needed to send the backlog in MSF_QUEUE_DRAIN_SLOTFRAMES slotframes, plus the packets
+ * arriving during a slotframe, as soon as a packet is queued. Up to CELLLIST_MAX_LEN cells are requested in a single
+ * 6P ADD. Once the backlog is cleared, the extra cells are released in a single 6P DELETE at the next housekeeping.
+ * The cell usage still drives the Rx cells when ADAPTIVE_MSF is set.
+ *
+ * Configuration options:
+ *  - MSF_QUEUE_DRAIN_SLOTFRAMES: number of slotframes the backlog should be sent in.
+ *  - MSF_QUEUE_MAX_CELLS: maximum number of negotiated Tx cells to the preferred parent.
+ */
+#ifndef MSF_QUEUE_AWARE
+#define MSF_QUEUE_AWARE             0
+#endif
+
+/**
+ * \def MSF_DOWNSTREAM_AWARE
+ *
+ * Let a parent add negotiated Tx cells to its children after the packets queued to each of them, e.g. downstream
+ * CoAP requests, rather than leave them to the shared and autonomous cells. A child is a neighbor which negotiated Tx
+ * cells to this mote, i.e. which sent the 6P ADD request, while not being its parent. As soon as a packet is queued to a child, MSF requests the cells needed to send the backlog to
+ * it in MSF_QUEUE_DRAIN_SLOTFRAMES slotframes. The 6P transactions with several children run in parallel. Once the
+ * backlog to a child is cleared, its cells are released at the next housekeeping. The Tx cells to a child are not
+ * cleared as cells to a former parent.
+ *
+ * Configuration options:
+ *  - MSF_QUEUE_DRAIN_SLOTFRAMES: number of slotframes the backlog should be sent in.
+ *  - MSF_DOWNSTREAM_MAX_CELLS: maximum number of negotiated Tx cells to a child.
+ *  - MSF_MAX_CHILDREN: number of children MSF keeps track of, further children get no dedicated Tx cells.
+ */
+#ifndef MSF_DOWNSTREAM_AWARE
+#define MSF_DOWNSTREAM_AWARE        0
+#endif
+
+#if MSF_QUEUE_AWARE || MSF_DOWNSTREAM_AWARE
+#ifndef MSF_QUEUE_DRAIN_SLOTFRAMES
+#define MSF_QUEUE_DRAIN_SLOTFRAMES  4
+#endif
+#endif
+#if MSF_QUEUE_AWARE
+#ifndef MSF_QUEUE_MAX_CELLS
+#define MSF_QUEUE_MAX_CELLS         16
+#endif
+#endif
+#if MSF_DOWNSTREAM_AWARE
+#ifndef MSF_DOWNSTREAM_MAX_CELLS
+#define MSF_DOWNSTREAM_MAX_CELLS    8
+#endif
+#ifndef MSF_MAX_CHILDREN
+#define MSF_MAX_CHILDREN            4
+#endif
+#endif
+
 /**
  * \def IEEE802154E_SINGLE_CHANNEL
  *
@@ -344,6 +457,76 @@
 #define IEEE802154E_SINGLE_CHANNEL      0
 #endif
 
+/**
+ * \def IEEE802154E_BURST_LENGTH
+ *
+ * Maximum number of consecutive slots a dedicated cell can be extended over, to send a burst of frames to the same
+ * neighbor (0 or 1 disables bursts). When more frames to the neighbor of a TX cell are queued and the next slot is not
+ * scheduled, the frame pending bit of the frame sent is set. If the next slot of the receiver is not scheduled either,
+ * it sets the frame pending bit in its ACK, and both use the next slot for the next frame, on the channel offset of the
+ * cell. Motes without bursts never set the frame pending bit in their ACKs, so a burst is only started between motes
+ * that both support it.
+ *
+ */
+#ifndef IEEE802154E_BURST_LENGTH
+#define IEEE802154E_BURST_LENGTH        0
+#endif
+
+/**
+ * \def IEEE802154E_SLOT_SKIP
+ *
+ * When set, the MAC sleeps from the end of a slot straight to the start of the next active slot, instead of waking up
+ * at every slot to find out it is idle. This is done on every mote, the DAG root included. Set to 0 to wake up at every
+ * slot.
+ *
+ */
+#ifndef IEEE802154E_SLOT_SKIP
+#define IEEE802154E_SLOT_SKIP           1
+#endif
+
+/**
+ * \def IEEE802154E_CHANNEL_BLACKLIST
+ *
+ * When set, the DAG root blacklists the channels on which its own unicast transmissions have a poor PDR, by pairs of
+ * adjacent channels, from the hopping sequence of the whole network. The blacklist reflects the links of the DAG root
+ * only, the PDRs of the other motes are not collected. Each mote keeps the PDR of its unicast transmissions per
+ * channel. BLACKLIST_ANNOUNCE slots before the end of each epoch of BLACKLIST_EPOCH slots, the DAG root compares its
+ * PDRs with BLACKLIST_MIN_PDR and, if the blacklist changes, announces the new one in the channel hopping template ID
+ * of its EBs. It applies from the next epoch on; the motes learn it from the EBs of their preferred parent in the
+ * meantime. A joining mote cannot use the EBs announcing a new blacklist, so it may wait up to BLACKLIST_ANNOUNCE
+ * slots. Channels 25 and 26 are never blacklisted. All motes of a network must use the same setting.
+ *
+ */
+#ifndef IEEE802154E_CHANNEL_BLACKLIST
+#define IEEE802154E_CHANNEL_BLACKLIST   0
+#endif
+
+/**
+ * \def SIXTOP_EB_TRICKLE
+ *
+ * When set, EBs are sent under the control of a Trickle timer (RFC6206), rather than on one slotframe out of
+ * EB_PORTION on average. The Trickle interval starts at SIXTOP_EB_IMIN ms and doubles up to SIXTOP_EB_IMAX_DOUBLINGS
+ * times while the neighborhood is stable. The EB of an interval is suppressed when SIXTOP_EB_REDUNDANCY EBs were heard
+ * already. The interval falls back to SIXTOP_EB_IMIN when a frame is received from an unknown neighbor, e.g. a mote
+ * joining, when the join priority of this mote changes, and until this mote can advertise the network.
+ *
+ */
+#ifndef SIXTOP_EB_TRICKLE
+#define SIXTOP_EB_TRICKLE               0
+#endif
+
+/**
+ * \def SIXTOP_MAX_TRANSACTIONS
+ *
+ * Number of 6P transactions this mote can have outstanding as the requester, with as many different neighbors. A new
+ * request fails only while a transaction with the same neighbor is ongoing or all the transactions are in use. The
+ * number of 6P responses waiting in the queue is bounded by the same value. 1 serializes the transactions.
+ *
+ */
+#ifndef SIXTOP_MAX_TRANSACTIONS
+#define SIXTOP_MAX_TRANSACTIONS         4
+#endif
+
 /**
  * \def PACKETQUEUE_LENGTH
  *
@@ -388,6 +571,19 @@
 #define BOARD_CRYPTOENGINE_ENABLED (0)
 #endif
 
+/**
+ * \def BOARD_AES_TTABLE
+ *
+ * Use the table-driven software AES implementation instead of the byte-oriented one. It does fewer operations per
+ * round on 32-bit targets and in simulation, at the cost of 1KB of flash for the table and 32-bit round keys. Like most table
+ * implementations it is not constant-time on targets with a data cache. Software AES is used for all operations when
+ * there is no crypto engine, and for aes128_enc() otherwise.
+ *
+ */
+#ifndef BOARD_AES_TTABLE
+#define BOARD_AES_TTABLE (0)
+#endif
+
 /**
  * \def BOARD_OPENSERIAL_PRINTF
  *
@@ -445,6 +641,93 @@
 #define SCHEDULER_DEBUG_ENABLE (0)
 #endif
 
+/**
+ * \def SCHEDULER_PRIO_BUCKETS
+ *
+ * Replaces the sorted linked-list of tasks by one FIFO per task priority, a free-list of task containers and a bitmap
+ * of non-empty priorities. Pushing and popping a task then takes constant time, regardless of TASK_LIST_DEPTH. Tasks of
+ * equal priority are still executed in FIFO order.
+ *
+ */
+#ifndef SCHEDULER_PRIO_BUCKETS
+#define SCHEDULER_PRIO_BUCKETS (0)
+#endif
+
+/**
+ * \def SCHEDULER_BACKPRESSURE
+ *
+ * Instead of resetting the board when the task list overflows, refuse low priority tasks once the free task containers
+ * fall below their class's reserve. A refused task whose callback is already queued at the same priority is coalesced
+ * with it. MAC, opentimers and sixtop tasks have no reserve and are never refused. scheduler_push_task() returns E_FAIL
+ * for a dropped task. Per-priority drop and coalesce counters are kept in scheduler_dbg when SCHEDULER_DEBUG_ENABLE is
+ * set.
+ *
+ * Configuration options:
+ *  - SCHEDULER_RESERVE_STACK: containers that FRAG, IPHC, RPL, UDP, ADAPTIVE_SYNC and MSF tasks must leave free.
+ *  - SCHEDULER_RESERVE_LOW: containers that COAP, BUTTON, SNIFFER, OPENSERIAL and application tasks must leave free.
+ */
+#ifndef SCHEDULER_BACKPRESSURE
+#define SCHEDULER_BACKPRESSURE (0)
+#endif
+
+#if SCHEDULER_BACKPRESSURE
+#ifndef SCHEDULER_RESERVE_STACK
+#define SCHEDULER_RESERVE_STACK     3
+#endif
+#ifndef SCHEDULER_RESERVE_LOW
+#define SCHEDULER_RESERVE_LOW       5
+#endif
+#endif
+
+/**
+ * \def SCHEDULER_PROFILE
+ *
+ * Timestamps every task with sctimer_readCounter() and keeps, per callback, the number of runs, the total and maximum
+ * execution time and the total and maximum queueing delay (from push to execution), all in sctimer ticks. The table is
+ * printed over serial as STATUS_TASKPROFILE. On the python board, where sctimer counts simulated time, the host's
+ * monotonic clock is used instead and the times are in microseconds.
+ *
+ * Configuration options:
+ *  - SCHEDULER_PROFILE_NUM_ENTRIES: number of distinct callbacks profiled.
+ */
+#ifndef SCHEDULER_PROFILE
+#define SCHEDULER_PROFILE (0)
+#endif
+
+#if SCHEDULER_PROFILE
+#ifndef SCHEDULER_PROFILE_NUM_ENTRIES
+#define SCHEDULER_PROFILE_NUM_ENTRIES   24
+#endif
+#endif
+
+// ======================== Driver configuration ========================
+
+/**
+ * \def OPENTIMERS_HEAP
+ *
+ * Keeps the running opentimers in a binary min-heap ordered on their compare value, instead of scanning the whole timer
+ * buffer on every schedule and every timer interrupt. Scheduling and cancelling a timer then takes O(log n) and the
+ * next timer to fire is known in O(1), which matters when MAX_NUM_TIMERS is raised. The TSCH and inhibit timers keep
+ * their fast paths and the opentimers API is unchanged.
+ *
+ */
+#ifndef OPENTIMERS_HEAP
+#define OPENTIMERS_HEAP (0)
+#endif
+
+/**
+ * \def OPENTIMERS_TOLERANCE_MS
+ *
+ * How late, in ms, the housekeeping timers of the stack (MSF housekeeping, RPL DIO and DAO, keep-alive) and of the
+ * periodic applications may fire. Timers whose tolerance windows overlap are then served by a single compare interrupt
+ * and a single task, which saves wake-ups on battery powered nodes. The TSCH timer is always exact. Set to 0 to make
+ * all timers exact, the per-timer tolerance state and the coalescing code of opentimers are then compiled out.
+ *
+ */
+#ifndef OPENTIMERS_TOLERANCE_MS
+#define OPENTIMERS_TOLERANCE_MS (0)
+#endif
+
 #include "check_config.h"
 
 #endif /* OPENWSN_CONFIG_H */
@@ -122,7 +122,9 @@ enum {
     STATUS_KAPERIOD = 10,
     STATUS_JOINED = 11,
     STATUS_MSF = 12,
-    STATUS_MAX = 13,
+    STATUS_TASKPROFILE = 13,
+    STATUS_QUEUESTATS = 14,
+    STATUS_MAX = 15,
 };
 
 // component identifiers, order is important
@@ -289,6 +291,7 @@ enum {
    ERR_INVALID_PARAM                   = 0x53, // received an invalid parameter
    ERR_COPY_TO_SPKT                    = 0x54, // copy packet content to small packet (pkt len {} < max len {})
    ERR_COPY_TO_BPKT                    = 0x55, // copy packet content to big packet (pkt len {} > max len {})
+   ERR_AUTONOMOUS_CELL_COLLISION       = 0x56, // two autonomous cells hashed to the same slot (hash salt {0})
 };
 
 //=========================== typedef =========================================
@@ -329,10 +332,20 @@ typedef struct {  // always written big endian, i.e. MSB in addr[0]
 } open_addr_t;
 END_PACK
 
+// metadata only a few packets need, kept in a small pool in openqueue and
+// attached to a packet on demand with openqueue_attachMetadata()
+typedef struct {
+    bool isUsed;                                               // is this entry attached to a packet?
+    cellInfo_ht l2_sixtop_celllist_add[CELLLIST_MAX_LEN];      // record celllist to be added and will be added when 6P response sendDone
+    cellInfo_ht l2_sixtop_celllist_delete[CELLLIST_MAX_LEN];   // record celllist to be removed and will be removed when 6P response sendDone
+    open_addr_t l2_keySource;                                  // the explicit key Source specified for the current frame
+} OpenQueueMetadata_t;
+
 typedef struct {
    //admin
    uint8_t       creator;                                       // the component which called getFreePacketBuffer()
    uint8_t       owner;                                         // the component which currently owns the entry
+   OpenQueueMetadata_t* metadata;                               // rarely used metadata, NULL unless attached
    uint8_t*      payload;                                       // pointer to the start of the payload within 'packet'
    int16_t       length;                                        // length in bytes of the payload
    //l7
@@ -358,6 +371,9 @@ typedef struct {
    open_addr_t   l3_destinationAdd;                             // 128b IPv6 destination (down stack)
    open_addr_t   l3_sourceAdd;                                  // 128b IPv6 source address
    bool          l3_useSourceRouting;                           // TRUE when the packet goes downstream
+#if DEADLINE_OPTION
+   asn_t         l3_deadlineAsn;                                // expiration time of a relayed packet, from its Deadline 6LoRH
+#endif
 
 #if OPENWSN_6LO_FRAGMENTATION_C
     bool         l3_isFragment;
@@ -371,8 +387,6 @@ typedef struct {
     uint8_t l2_numTxAttempts;                                  // number Tx attempts
     asn_t l2_asn;                                              // at what ASN the packet was Tx'ed or Rx'ed
     uint8_t *l2_payload;                                       // pointer to the start of the payload of l2 (used for MAC to fill in ASN in ADV)
-    cellInfo_ht l2_sixtop_celllist_add[CELLLIST_MAX_LEN];      // record celllist to be added and will be added when 6P response sendDone
-    cellInfo_ht l2_sixtop_celllist_delete[CELLLIST_MAX_LEN];   // record celllist to be removed and will be removed when 6P response sendDone
     uint16_t l2_sixtop_frameID;                                // frameID in 6P message
     uint8_t l2_sixtop_messageType;                             // indicating the sixtop message type
     uint8_t l2_sixtop_command;                                 // command of the received 6p request, recorded in 6p response
@@ -391,7 +405,6 @@ typedef struct {
     uint8_t l2_securityLevel;                                  // the security level specified for the current frame
     uint8_t l2_keyIdMode;                                      // the key Identifier mode specified for the current frame
     uint8_t l2_keyIndex;                                       // the key Index specified for the current frame
-    open_addr_t l2_keySource;                                  // the key Source specified for the current frame
     uint8_t l2_authenticationLength;                           // the length of the authentication field
     uint8_t commandFrameIdentifier;                            // used in case of Command Frames
     uint8_t *l2_FrameCounter;                                  // pointer to the FrameCounter in the MAC header
@@ -401,19 +414,11 @@ typedef struct {
     uint8_t l1_lqi;                                            // LQI of received packet
     bool l1_crc;                                               // did received packet pass CRC check?
     //the packet
-    uint8_t packet[1 + 1 + 125 + 2 + 1];                       // 1B spi address, 1B length, 125B data, 2B CRC, 1B LQI
+    uint8_t *packet;                                           // chunk holding the frame, taken from the openqueue pools
+    uint16_t packet_size;                                      // size of that chunk
 } OpenQueueEntry_t;
 
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-typedef struct {
-    OpenQueueEntry_t standard_entry;
-    // 130 bytes alread allocated in the normal OpenQueueEntry
-    uint8_t packet_remainder[IPV6_PACKET_SIZE - 130];
-} OpenQueueBigEntry_t;
-#endif
-
-
 BEGIN_PACK
 typedef struct {
     bool used;
@@ -9,6 +9,13 @@
 #include "board.h"
 #include "debugpins.h"
 #include "leds.h"
+#if SCHEDULER_PROFILE
+#include "sctimer.h"
+#include "openserial.h"
+#ifdef PYTHON_BOARD
+#include <time.h>
+#endif
+#endif
 
 //=========================== variables =======================================
 
@@ -18,13 +25,56 @@ scheduler_vars_t scheduler_vars;
 scheduler_dbg_t scheduler_dbg;
 #endif
 
+#if SCHEDULER_BACKPRESSURE
+// number of task containers a task of a given priority must leave free
+static const uint8_t scheduler_reserve[SCHEDULER_NUM_PRIOS] = {
+    SCHEDULER_RESERVE_LOW,      // TASKPRIO_NONE
+    0,                          // TASKPRIO_SIXTOP_NOTIF_RX
+    0,                          // TASKPRIO_SIXTOP_NOTIF_TXDONE
+    0,                          // TASKPRIO_OPENTIMERS
+    0,                          // TASKPRIO_SIXTOP
+    SCHEDULER_RESERVE_STACK,    // TASKPRIO_FRAG
+    SCHEDULER_RESERVE_STACK,    // TASKPRIO_IPHC
+    SCHEDULER_RESERVE_STACK,    // TASKPRIO_RPL
+    SCHEDULER_RESERVE_STACK,    // TASKPRIO_UDP
+    SCHEDULER_RESERVE_LOW,      // TASKPRIO_COAP
+    SCHEDULER_RESERVE_STACK,    // TASKPRIO_ADAPTIVE_SYNC
+    SCHEDULER_RESERVE_STACK,    // TASKPRIO_MSF
+    SCHEDULER_RESERVE_LOW,      // TASKPRIO_BUTTON
+    0,                          // TASKPRIO_SIXTOP_TIMEOUT
+    SCHEDULER_RESERVE_LOW,      // TASKPRIO_SNIFFER
+    SCHEDULER_RESERVE_LOW,      // TASKPRIO_OPENSERIAL
+    SCHEDULER_RESERVE_LOW,      // TASKPRIO_MAX
+};
+#endif
+
+#if SCHEDULER_PRIO_BUCKETS
+// index of the lowest bit set in a nibble (0x0 never looked up)
+static const uint8_t scheduler_lowestBitInNibble[16] = {
+    0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+#endif
+
 //=========================== prototypes ======================================
 
 void consumeTask(uint8_t taskId);
+#if SCHEDULER_PRIO_BUCKETS
+static uint8_t scheduler_highestPrioBucket(void);
+#endif
+#if SCHEDULER_BACKPRESSURE
+static owerror_t scheduler_overload(task_cbt cb, task_prio_t prio);
+#endif
+#if SCHEDULER_PROFILE
+static PORT_TIMER_WIDTH scheduler_profile_now(void);
+static void scheduler_profile_record(taskList_item_t* task, PORT_TIMER_WIDTH startTime, PORT_TIMER_WIDTH endTime);
+#endif
 
 //=========================== public ==========================================
 
 void scheduler_init(void) {
+#if SCHEDULER_PRIO_BUCKETS
+    uint8_t i;
+#endif
 
     // initialization module variables
     memset(&scheduler_vars,0,sizeof(scheduler_vars_t));
@@ -32,12 +82,80 @@ void scheduler_init(void) {
     memset(&scheduler_dbg,0,sizeof(scheduler_dbg_t));
 #endif
 
+#if SCHEDULER_PRIO_BUCKETS
+    // chain all task containers into the free-list
+    for (i=0;i<TASK_LIST_DEPTH-1;i++) {
+        scheduler_vars.taskBuf[i].next = &scheduler_vars.taskBuf[i+1];
+    }
+    scheduler_vars.taskBuf[TASK_LIST_DEPTH-1].next = NULL;
+    scheduler_vars.freeList = &scheduler_vars.taskBuf[0];
+#endif
+
     // enable the scheduler's interrupt so SW can wake up the scheduler
     SCHEDULER_ENABLE_INTERRUPT();
 }
 
+#if SCHEDULER_PRIO_BUCKETS
 void scheduler_start(void) {
     taskList_item_t* pThisTask;
+    uint8_t          bucket;
+#if SCHEDULER_PROFILE
+    PORT_TIMER_WIDTH startTime;
+#endif
+    while (1) {
+        while(scheduler_vars.bucketMap!=0) {
+            // there is still at least one task in one of the buckets
+
+            INTERRUPT_DECLARATION();
+            DISABLE_INTERRUPTS();
+
+            // the task to execute is the oldest one of the highest priority bucket
+            bucket    = scheduler_highestPrioBucket();
+            pThisTask = scheduler_vars.bucketHead[bucket];
+
+            // shift that bucket by one task
+            scheduler_vars.bucketHead[bucket] = pThisTask->next;
+            if (scheduler_vars.bucketHead[bucket]==NULL) {
+                scheduler_vars.bucketTail[bucket] = NULL;
+                scheduler_vars.bucketMap         &= ~(((uint32_t)1)<<bucket);
+            }
+
+            ENABLE_INTERRUPTS();
+
+            // execute the current task
+#if SCHEDULER_PROFILE
+            startTime = scheduler_profile_now();
+            pThisTask->cb();
+            scheduler_profile_record(pThisTask, startTime, scheduler_profile_now());
+#else
+            pThisTask->cb();
+#endif
+
+            // free up this task container
+            DISABLE_INTERRUPTS();
+            pThisTask->cb            = NULL;
+            pThisTask->prio          = TASKPRIO_NONE;
+            pThisTask->next          = scheduler_vars.freeList;
+            scheduler_vars.freeList  = pThisTask;
+#if SCHEDULER_BACKPRESSURE
+            scheduler_vars.numTasks--;
+#endif
+#if SCHEDULER_DEBUG_ENABLE
+            scheduler_dbg.numTasksCur--;
+#endif
+            ENABLE_INTERRUPTS();
+        }
+        debugpins_task_clr();
+        board_sleep();
+        debugpins_task_set();                      // IAR should halt here if nothing to do
+    }
+}
+#else
+void scheduler_start(void) {
+    taskList_item_t* pThisTask;
+#if SCHEDULER_PROFILE
+    PORT_TIMER_WIDTH startTime;
+#endif
     while (1) {
         while(scheduler_vars.task_list!=NULL) {
          // there is still at least one task in the linked-list of tasks
@@ -54,12 +172,25 @@ void scheduler_start(void) {
          ENABLE_INTERRUPTS();
 
          // execute the current task
+#if SCHEDULER_PROFILE
+         startTime = scheduler_profile_now();
+         pThisTask->cb();
+         scheduler_profile_record(pThisTask, startTime, scheduler_profile_now());
+#else
          pThisTask->cb();
+#endif
 
          // free up this task container
+#if SCHEDULER_BACKPRESSURE
+         DISABLE_INTERRUPTS();
+         scheduler_vars.numTasks--;
+#endif
          pThisTask->cb            = NULL;
          pThisTask->prio          = TASKPRIO_NONE;
          pThisTask->next          = NULL;
+#if SCHEDULER_BACKPRESSURE
+         ENABLE_INTERRUPTS();
+#endif
 #if SCHEDULER_DEBUG_ENABLE
          scheduler_dbg.numTasksCur--;
 #endif
@@ -69,14 +200,107 @@ void scheduler_start(void) {
       debugpins_task_set();                      // IAR should halt here if nothing to do
    }
 }
+#endif
+
+#if SCHEDULER_PRIO_BUCKETS
+owerror_t scheduler_push_task(task_cbt cb, task_prio_t prio) {
+    taskList_item_t*  taskContainer;
+#if SCHEDULER_BACKPRESSURE
+    owerror_t         error;
+#endif
+    INTERRUPT_DECLARATION();
+
+    DISABLE_INTERRUPTS();
+
+    // priorities beyond TASKPRIO_MAX share the lowest priority
+    if (prio>TASKPRIO_MAX) {
+       prio = TASKPRIO_MAX;
+    }
+
+#if SCHEDULER_BACKPRESSURE
+    // refuse or coalesce the task if it would eat into the containers
+    // reserved for more important tasks
+    if (scheduler_reserve[prio]>0 &&
+          scheduler_vars.numTasks+scheduler_reserve[prio]>=TASK_LIST_DEPTH) {
+       error = scheduler_overload(cb, prio);
+       ENABLE_INTERRUPTS();
+       return error;
+    }
+#endif
+
+    // take a task container from the free-list
+    taskContainer = scheduler_vars.freeList;
+    if (taskContainer==NULL) {
+       // task list has overflown. This should never happpen!
+
+       // we can not print from within the kernel. Instead:
+       // blink the error LED
+       leds_error_blink();
+       // reset the board
+       board_reset();
+       ENABLE_INTERRUPTS();
+       return E_FAIL;
+    }
+    scheduler_vars.freeList        = taskContainer->next;
+
+    // fill that task container with this task
+    taskContainer->cb              = cb;
+    taskContainer->prio            = prio;
+    taskContainer->next            = NULL;
+#if SCHEDULER_PROFILE
+    taskContainer->pushTime        = scheduler_profile_now();
+#endif
+
+    // append at the tail of its priority bucket
+    if (scheduler_vars.bucketTail[prio]==NULL) {
+       scheduler_vars.bucketHead[prio]  = taskContainer;
+       scheduler_vars.bucketMap        |= ((uint32_t)1)<<prio;
+    } else {
+       scheduler_vars.bucketTail[prio]->next = taskContainer;
+    }
+    scheduler_vars.bucketTail[prio]      = taskContainer;
+#if SCHEDULER_BACKPRESSURE
+    scheduler_vars.numTasks++;
+#endif
+    // maintain debug stats
+#if SCHEDULER_DEBUG_ENABLE
+    scheduler_dbg.numTasksCur++;
+    if (scheduler_dbg.numTasksCur>scheduler_dbg.numTasksMax) {
+        scheduler_dbg.numTasksMax   = scheduler_dbg.numTasksCur;
+    }
+#endif
+
+    ENABLE_INTERRUPTS();
 
-void scheduler_push_task(task_cbt cb, task_prio_t prio) {
+    return E_SUCCESS;
+}
+#else
+owerror_t scheduler_push_task(task_cbt cb, task_prio_t prio) {
     taskList_item_t*  taskContainer;
     taskList_item_t** taskListWalker;
+#if SCHEDULER_BACKPRESSURE
+    owerror_t         error;
+#endif
     INTERRUPT_DECLARATION();
 
     DISABLE_INTERRUPTS();
 
+    // priorities beyond TASKPRIO_MAX share the lowest priority
+    if (prio>TASKPRIO_MAX) {
+       prio = TASKPRIO_MAX;
+    }
+
+#if SCHEDULER_BACKPRESSURE
+    // refuse or coalesce the task if it would eat into the containers
+    // reserved for more important tasks
+    if (scheduler_reserve[prio]>0 &&
+          scheduler_vars.numTasks+scheduler_reserve[prio]>=TASK_LIST_DEPTH) {
+       error = scheduler_overload(cb, prio);
+       ENABLE_INTERRUPTS();
+       return error;
+    }
+#endif
+
     // find an empty task container
     taskContainer = &scheduler_vars.taskBuf[0];
     while (taskContainer->cb!=NULL &&
@@ -95,6 +319,9 @@ void scheduler_push_task(task_cbt cb, task_prio_t prio) {
     // fill that task container with this task
     taskContainer->cb              = cb;
     taskContainer->prio            = prio;
+#if SCHEDULER_PROFILE
+    taskContainer->pushTime        = scheduler_profile_now();
+#endif
 
     // find position in queue
     taskListWalker                 = &scheduler_vars.task_list;
@@ -105,6 +332,9 @@ void scheduler_push_task(task_cbt cb, task_prio_t prio) {
     // insert at that position
     taskContainer->next            = *taskListWalker;
     *taskListWalker                = taskContainer;
+#if SCHEDULER_BACKPRESSURE
+    scheduler_vars.numTasks++;
+#endif
     // maintain debug stats
 #if SCHEDULER_DEBUG_ENABLE
     scheduler_dbg.numTasksCur++;
@@ -114,7 +344,10 @@ void scheduler_push_task(task_cbt cb, task_prio_t prio) {
 #endif
 
     ENABLE_INTERRUPTS();
+
+    return E_SUCCESS;
 }
+#endif
 
 
 #if SCHEDULER_DEBUG_ENABLE
@@ -127,5 +360,176 @@ uint8_t scheduler_debug_get_TasksMax(void)
 {
    return scheduler_dbg.numTasksMax;
 }
+
+#if SCHEDULER_BACKPRESSURE
+uint16_t scheduler_debug_get_numDropped(task_prio_t prio)
+{
+   return scheduler_dbg.numDropped[prio];
+}
+
+uint16_t scheduler_debug_get_numCoalesced(task_prio_t prio)
+{
+   return scheduler_dbg.numCoalesced[prio];
+}
 #endif
+#endif
+/**
+\brief Trigger this module to print status information, over serial.
+
+debugPrint_* functions are used by the openserial module to continuously print
+status information about several modules in the OpenWSN stack.
+
+\returns TRUE if this function printed something, FALSE otherwise.
+*/
+bool debugPrint_taskProfile(void) {
+#if SCHEDULER_PROFILE
+    debugTaskProfileEntry_t temp;
+    taskProfile_t*          entry;
+    uint8_t                 i;
+
+    // find the next row in use
+    for (i=0;i<SCHEDULER_PROFILE_NUM_ENTRIES;i++) {
+        scheduler_vars.debugPrintRow = (scheduler_vars.debugPrintRow+1)%SCHEDULER_PROFILE_NUM_ENTRIES;
+        if (scheduler_vars.profile[scheduler_vars.debugPrintRow].cb!=NULL) {
+            break;
+        }
+    }
+    entry = &scheduler_vars.profile[scheduler_vars.debugPrintRow];
+    if (entry->cb==NULL) {
+        return FALSE;
+    }
+
+    // gather status data
+    temp.row        = scheduler_vars.debugPrintRow;
+    temp.cb         = (uintptr_t)entry->cb;
+    temp.numRuns    = entry->numRuns;
+    temp.totalTicks = entry->totalTicks;
+    temp.maxTicks   = entry->maxTicks;
+    temp.totalDelay = entry->totalDelay;
+    temp.maxDelay   = entry->maxDelay;
+
+    // send status data over serial port
+    openserial_printStatus(STATUS_TASKPROFILE, (uint8_t*)&temp, sizeof(debugTaskProfileEntry_t));
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
 //=========================== private =========================================
+
+#if SCHEDULER_PRIO_BUCKETS
+/**
+\brief Find the highest priority (lowest value) non-empty bucket.
+
+Only call with interrupts disabled and scheduler_vars.bucketMap!=0. Runs in
+bounded time, one nibble of the bitmap at a time.
+*/
+static uint8_t scheduler_highestPrioBucket(void) {
+    uint32_t map;
+    uint8_t  base;
+
+    map  = scheduler_vars.bucketMap;
+    base = 0;
+    while ((map & 0x0f)==0) {
+        map  >>= 4;
+        base  += 4;
+    }
+    return base + scheduler_lowestBitInNibble[map & 0x0f];
+}
+#endif
+
+#if SCHEDULER_BACKPRESSURE
+/**
+\brief Handle a task pushed while the scheduler is overloaded.
+
+Called with interrupts disabled. If a task with the same callback and priority
+is already queued, the new push is merged into it. Otherwise, it is refused.
+
+\returns E_SUCCESS if the task was coalesced, E_FAIL if it was dropped.
+*/
+static owerror_t scheduler_overload(task_cbt cb, task_prio_t prio) {
+    taskList_item_t* walker;
+
+#if SCHEDULER_PRIO_BUCKETS
+    walker = scheduler_vars.bucketHead[prio];
+#else
+    walker = scheduler_vars.task_list;
+#endif
+    while (walker!=NULL) {
+        if (walker->cb==cb && walker->prio==prio) {
+#if SCHEDULER_DEBUG_ENABLE
+            scheduler_dbg.numCoalesced[prio]++;
+#endif
+            return E_SUCCESS;
+        }
+        walker = walker->next;
+    }
+
+#if SCHEDULER_DEBUG_ENABLE
+    scheduler_dbg.numDropped[prio]++;
+#endif
+    return E_FAIL;
+}
+#endif
+
+#if SCHEDULER_PROFILE
+/**
+\brief Read the clock the tasks are profiled with.
+
+On the python board, sctimer counts simulated time, which does not advance
+while a task runs. The host's monotonic clock is read instead, in us.
+*/
+static PORT_TIMER_WIDTH scheduler_profile_now(void) {
+#ifdef PYTHON_BOARD
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (PORT_TIMER_WIDTH)((uint64_t)now.tv_sec*1000000 + now.tv_nsec/1000);
+#else
+    return sctimer_readCounter();
+#endif
+}
+
+/**
+\brief Account for one execution of a task in the profile table.
+
+Tasks are profiled per callback address. Callbacks beyond the first
+SCHEDULER_PROFILE_NUM_ENTRIES distinct ones are not recorded.
+*/
+static void scheduler_profile_record(taskList_item_t* task, PORT_TIMER_WIDTH startTime, PORT_TIMER_WIDTH endTime) {
+    taskProfile_t*   entry;
+    PORT_TIMER_WIDTH duration;
+    PORT_TIMER_WIDTH delay;
+    uint8_t          i;
+
+    entry = NULL;
+    for (i=0;i<SCHEDULER_PROFILE_NUM_ENTRIES;i++) {
+        if (scheduler_vars.profile[i].cb==task->cb) {
+            entry = &scheduler_vars.profile[i];
+            break;
+        }
+        if (entry==NULL && scheduler_vars.profile[i].cb==NULL) {
+            entry = &scheduler_vars.profile[i];
+        }
+    }
+    if (entry==NULL) {
+        return;
+    }
+
+    duration = endTime-startTime;
+    delay    = startTime-task->pushTime;
+
+    entry->cb           = task->cb;
+    entry->numRuns++;
+    entry->totalTicks  += duration;
+    entry->totalDelay  += delay;
+    if (duration>entry->maxTicks) {
+        entry->maxTicks = duration;
+    }
+    if (delay>entry->maxDelay) {
+        entry->maxDelay = delay;
+    }
+}
+#endif
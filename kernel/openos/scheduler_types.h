@@ -14,17 +14,74 @@ typedef struct task_llist_t {
    task_cbt                       cb;
    task_prio_t                    prio;
    void*                          next;
+#if SCHEDULER_PROFILE
+   PORT_TIMER_WIDTH               pushTime;
+#endif
 } taskList_item_t;
 
+#if SCHEDULER_PROFILE
+typedef struct {
+   task_cbt                       cb;             // profiled callback, NULL if unused
+   uint16_t                       numRuns;
+   uint32_t                       totalTicks;     // time spent executing the callback
+   PORT_TIMER_WIDTH               maxTicks;
+   uint32_t                       totalDelay;     // time spent queued, from push to execution
+   PORT_TIMER_WIDTH               maxDelay;
+} taskProfile_t;
+
+BEGIN_PACK
+typedef struct {
+   uint8_t                        row;
+   uintptr_t                      cb;
+   uint16_t                       numRuns;
+   uint32_t                       totalTicks;
+   uint32_t                       maxTicks;
+   uint32_t                       totalDelay;
+   uint32_t                       maxDelay;
+} debugTaskProfileEntry_t;
+END_PACK
+#endif
+
+// number of task_prio_t values, TASKPRIO_MAX included
+#define SCHEDULER_NUM_PRIOS           (TASKPRIO_MAX+1)
+
+#if SCHEDULER_PRIO_BUCKETS
+typedef struct {
+   taskList_item_t                taskBuf[TASK_LIST_DEPTH];
+   taskList_item_t*               freeList;                          // unused task containers
+   taskList_item_t*               bucketHead[SCHEDULER_NUM_PRIOS];   // oldest task of each priority
+   taskList_item_t*               bucketTail[SCHEDULER_NUM_PRIOS];   // newest task of each priority
+   uint32_t                       bucketMap;                         // bit n set if bucket n is not empty
+#if SCHEDULER_BACKPRESSURE
+   uint8_t                        numTasks;                          // number of task containers in use
+#endif
+#if SCHEDULER_PROFILE
+   taskProfile_t                  profile[SCHEDULER_PROFILE_NUM_ENTRIES];
+   uint8_t                        debugPrintRow;
+#endif
+} scheduler_vars_t;
+#else
 typedef struct {
    taskList_item_t                taskBuf[TASK_LIST_DEPTH];
    taskList_item_t*               task_list;
+#if SCHEDULER_BACKPRESSURE
+   uint8_t                        numTasks;
+#endif
+#if SCHEDULER_PROFILE
+   taskProfile_t                  profile[SCHEDULER_PROFILE_NUM_ENTRIES];
+   uint8_t                        debugPrintRow;
+#endif
 } scheduler_vars_t;
+#endif
 
 #if SCHEDULER_DEBUG_ENABLE
 typedef struct {
    uint8_t                        numTasksCur;
    uint8_t                        numTasksMax;
+#if SCHEDULER_BACKPRESSURE
+   uint16_t                       numDropped[SCHEDULER_NUM_PRIOS];
+   uint16_t                       numCoalesced[SCHEDULER_NUM_PRIOS];
+#endif
 } scheduler_dbg_t;
 #endif
 
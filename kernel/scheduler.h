@@ -48,12 +48,18 @@ typedef void (*task_cbt)(void);
 
 void scheduler_init(void);
 void scheduler_start(void);
-void scheduler_push_task(task_cbt task_cb, task_prio_t prio);
+owerror_t scheduler_push_task(task_cbt task_cb, task_prio_t prio);
 
 #if SCHEDULER_DEBUG_ENABLE
 uint8_t scheduler_debug_get_TasksCur(void);
 uint8_t scheduler_debug_get_TasksMax(void);
+#if SCHEDULER_BACKPRESSURE
+uint16_t scheduler_debug_get_numDropped(task_prio_t prio);
+uint16_t scheduler_debug_get_numCoalesced(task_prio_t prio);
 #endif
+#endif
+
+bool debugPrint_taskProfile(void);
 
 #include "openos/scheduler_types.h"
 
@@ -64,6 +64,7 @@ void cexample_init(void) {
 
     coap_register(&cexample_vars.desc);
     cexample_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_COAP);
+    opentimers_setTolerance(cexample_vars.timerId, OPENTIMERS_TOLERANCE_MS, TIME_MS);
     opentimers_scheduleIn(
             cexample_vars.timerId,
             CEXAMPLEPERIOD,
@@ -63,6 +63,7 @@ void uinject_init(void) {
     // start periodic timer
     uinject_vars.period = UINJECT_PERIOD_MS;
     uinject_vars.timerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_UDP);
+    opentimers_setTolerance(uinject_vars.timerId, OPENTIMERS_TOLERANCE_MS, TIME_MS);
     opentimers_scheduleIn(
             uinject_vars.timerId,
             UINJECT_PERIOD_MS,
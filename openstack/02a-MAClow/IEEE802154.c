@@ -366,7 +366,9 @@ void ieee802154_retrieveHeader(OpenQueueEntry_t *msg,
 
     // parse security header if security is supported locally
     if (ieee802514_header->securityEnabled && IEEE802154_SECURITY_SUPPORTED) {
-        IEEE802154_security_retrieveAuxiliarySecurityHeader(msg, ieee802514_header);
+        if (IEEE802154_security_retrieveAuxiliarySecurityHeader(msg, ieee802514_header) == E_FAIL) {
+            return; // malformed security header, or no metadata left for its key source
+        }
     } else if (ieee802514_header->securityEnabled && IEEE802154_SECURITY_SUPPORTED == 0) {
         return; // security not supported
     }
@@ -458,4 +460,21 @@ void ieee802154_retrieveHeader(OpenQueueEntry_t *msg,
     ieee802514_header->valid = TRUE;
 }
 
+/**
+\brief Sets or clears the frame pending bit of a frame.
+
+The frame must start with its IEEE802.15.4 header, i.e. it has been prepended
+and not secured yet.
+
+\param[in,out] msg          The frame to modify.
+\param[in]     framePending Whether the frame pending bit is set.
+*/
+void ieee802154_setFramePending(OpenQueueEntry_t *msg, bool framePending) {
+    if (framePending) {
+        msg->payload[0] |= IEEE154_PENDING_YES_FRAMEPENDING << IEEE154_FCF_FRAME_PENDING;
+    } else {
+        msg->payload[0] &= ~(IEEE154_PENDING_YES_FRAMEPENDING << IEEE154_FCF_FRAME_PENDING);
+    }
+}
+
 //=========================== private =========================================
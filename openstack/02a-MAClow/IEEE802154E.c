@@ -110,15 +110,31 @@ bool ieee154e_processIEs(OpenQueueEntry_t *pkt, uint16_t *lenIE);
 
 void timeslotTemplateIDStoreFromEB(uint8_t id);
 
-void channelhoppingTemplateIDStoreFromEB(uint8_t id);
+bool channelhoppingTemplateIDStoreFromEB(uint8_t id, open_addr_t *src);
+
+void setChannelTemplate(uint8_t id);
+
+#if IEEE802154E_CHANNEL_BLACKLIST
+void updateChannelStats(bool wasAcked);
+
+void startChannelEpoch(void);
+
+void announceChannelBlacklist(void);
+
+uint8_t computeChannelBlacklist(void);
+#endif
 
 // ASN handling
-void incrementAsnOffset(void);
+void incrementAsnOffset(PORT_TIMER_WIDTH numSlots);
 
 void ieee154e_resetAsn(void);
 
 void ieee154e_syncSlotOffset(void);
 
+uint16_t asnModulo(uint16_t divisor);
+
+void skipToNextActiveSlot(void);
+
 void asnStoreFromEB(uint8_t *asn);
 
 void joinPriorityStoreFromEB(uint8_t jp);
@@ -140,7 +156,14 @@ void resetStats(void);
 
 void updateStats(PORT_SIGNED_INT_WIDTH timeCorrection);
 
+// burst
+bool burstCanContinue(void);
+
+void burstContinue(cellType_t cellType, open_addr_t *neighbor);
+
 // misc
+owerror_t prepareTxFrame(OpenQueueEntry_t **txFrame);
+
 uint8_t calculateFrequency(uint8_t channelOffset);
 
 void changeState(ieee154e_state_t newstate);
@@ -167,10 +190,15 @@ Call this function once before any other function in this module, possibly
 during boot-up.
 */
 void ieee154e_init(void) {
+#if IEEE802154E_CHANNEL_BLACKLIST
+    uint8_t i;
+#endif
 
     // initialize variables
     memset(&ieee154e_vars, 0, sizeof(ieee154e_vars_t));
     memset(&ieee154e_dbg, 0, sizeof(ieee154e_dbg_t));
+    ieee154e_vars.localCopyForTransmission.packet = ieee154e_vars.localCopyPacket;
+    ieee154e_vars.localCopyForTransmission.packet_size = OPENQUEUE_FRAME_CHUNK_SIZE;
 
     // set singleChannel to 0 to enable channel hopping.
 #if IEEE802154E_SINGLE_CHANNEL
@@ -185,6 +213,12 @@ void ieee154e_init(void) {
 
     // default hopping template
     memcpy(&(ieee154e_vars.chTemplate[0]), chTemplate_default, sizeof(ieee154e_vars.chTemplate));
+    ieee154e_vars.numChannels = NUM_CHANNELS;
+#if IEEE802154E_CHANNEL_BLACKLIST
+    for (i = 0; i < NUM_CHANNELS; i++) {
+        ieee154e_vars.channelStats[i].pdr = 100;
+    }
+#endif
 
     if (idmanager_getIsDAGroot() == TRUE) {
         changeIsSync(TRUE);
@@ -345,6 +379,10 @@ void isr_ieee154e_newSlot(opentimers_id_t id) {
         if (idmanager_getIsDAGroot() == TRUE) {
             changeIsSync(TRUE);
             ieee154e_resetAsn();
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+            // the other slotframes start over from ASN 0 as well
+            schedule_syncSlotOffset(ieee154e_vars.slotOffset);
+#endif
             ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
         } else {
             activity_synchronize_newSlot();
@@ -756,7 +794,7 @@ port_INLINE void activity_synchronize_endOfFrame(PORT_TIMER_WIDTH capturedTime)
         ieee154e_vars.dataReceived->payload = &(ieee154e_vars.dataReceived->packet[FIRST_FRAME_BYTE]);
         radio_getReceivedFrame(ieee154e_vars.dataReceived->payload,
                                (uint8_t * ) & ieee154e_vars.dataReceived->length,
-                               sizeof(ieee154e_vars.dataReceived->packet),
+                               ieee154e_vars.dataReceived->packet_size,
                                &ieee154e_vars.dataReceived->l1_rssi,
                                &ieee154e_vars.dataReceived->l1_lqi,
                                &ieee154e_vars.dataReceived->l1_crc);
@@ -874,20 +912,11 @@ port_INLINE void activity_synchronize_endOfFrame(PORT_TIMER_WIDTH capturedTime)
 }
 
 port_INLINE bool ieee154e_processIEs(OpenQueueEntry_t* pkt, uint16_t* lenIE) {
-    uint8_t i;
     if (isValidEbFormat(pkt, lenIE) == TRUE){
         // At this point, ASN and frame length are known and the current slotoffset can be inferred
         ieee154e_syncSlotOffset();
         schedule_syncSlotOffset(ieee154e_vars.slotOffset);
         ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
-
-        /* infer the asnOffset based on the fact that ieee154e_vars.freq = 11 + (asnOffset + channelOffset)%16 */
-        for (i = 0; i < NUM_CHANNELS; i++){
-            if ((ieee154e_vars.freq - 11) == ieee154e_vars.chTemplate[i]){
-                break;
-            }
-        }
-        ieee154e_vars.asnOffset = i - schedule_getChannelOffset();
         return TRUE;
     } else {
         // wrong eb format
@@ -901,13 +930,17 @@ port_INLINE bool ieee154e_processIEs(OpenQueueEntry_t* pkt, uint16_t* lenIE) {
 port_INLINE void activity_ti1ORri1(void) {
     cellType_t cellType;
     open_addr_t neighbor;
-    uint8_t i;
     uint8_t asn[5];
     uint8_t join_priority;
     bool couldSendEB = FALSE;
 
-    // increment ASN (do this first so debug pins are in sync)
-    incrementAsnOffset();
+    // increment ASN by the slots elapsed since the last wake-up (do this first so debug pins are in sync)
+    incrementAsnOffset(ieee154e_vars.numOfSleepSlots);
+
+    // a burst continued during the previous slot goes on in this one
+    ieee154e_vars.burst.isThisSlot = ieee154e_vars.burst.isNextSlot;
+    ieee154e_vars.burst.isNextSlot = FALSE;
+    ieee154e_vars.burst.isPending = FALSE;
 
     // wiggle debug pins
     debugpins_slot_toggle();
@@ -940,6 +973,9 @@ port_INLINE void activity_ti1ORri1(void) {
         }
     }
 
+    // Reset sleep slots
+    ieee154e_vars.numOfSleepSlots = 1;
+
     // if the previous slot took too long, we will not be in the right state
     if (ieee154e_vars.state != S_SLEEP) {
         // log the error
@@ -951,9 +987,6 @@ port_INLINE void activity_ti1ORri1(void) {
         return;
     }
 
-    // Reset sleep slots
-    ieee154e_vars.numOfSleepSlots = 1;
-
     // update nextActiveSlotOffset before using
     ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
     if (ieee154e_vars.slotOffset == ieee154e_vars.nextActiveSlotOffset) {
@@ -967,36 +1000,25 @@ port_INLINE void activity_ti1ORri1(void) {
 
         // find the next one
         ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
-        if (idmanager_getIsSlotSkip() && idmanager_getIsDAGroot() == FALSE) {
-            if (ieee154e_vars.nextActiveSlotOffset > ieee154e_vars.slotOffset) {
-                ieee154e_vars.numOfSleepSlots = ieee154e_vars.nextActiveSlotOffset - ieee154e_vars.slotOffset;
-            } else {
-                ieee154e_vars.numOfSleepSlots =
-                        schedule_getFrameLength() + ieee154e_vars.nextActiveSlotOffset - ieee154e_vars.slotOffset;
-            }
-
-            opentimers_scheduleAbsolute(
-                    ieee154e_vars.timerId,                            // timerId
-                    TsSlotDuration * (ieee154e_vars.numOfSleepSlots),   // duration
-                    ieee154e_vars.startOfSlotReference,               // reference
-                    TIME_TICS,                                        // timetype
-                    isr_ieee154e_newSlot                              // callback
-            );
-            ieee154e_vars.slotDuration = TsSlotDuration * (ieee154e_vars.numOfSleepSlots);
-
-            //increase ASN by numOfSleepSlots-1 slots as at this slot is already incremented by 1
-            for (i = 0; i < ieee154e_vars.numOfSleepSlots - 1; i++) {
-                incrementAsnOffset();
-            }
+        if (IEEE802154E_BURST_LENGTH <= 1 || schedule_getShared() == TRUE) {
+            // unless a burst may continue this cell in the next slot, sleep until the next active one
+            skipToNextActiveSlot();
         }
+    } else if (ieee154e_vars.burst.isThisSlot) {
+        // this slot continues a burst, on the channel offset of the cell it started in
+        ieee154e_vars.freq = calculateFrequency(ieee154e_vars.burst.channelOffset);
     } else {
-        // this is NOT the next active slot, abort
+        // this is NOT the next active slot (the schedule changed while sleeping, or a burst ended), abort
+        skipToNextActiveSlot();
         endSlot();
         return;
     }
 
     // check the schedule to see what type of slot this is
     cellType = schedule_getType();
+    if (ieee154e_vars.burst.isThisSlot) {
+        cellType = ieee154e_vars.burst.cellType;
+    }
     switch (cellType) {
         case CELLTYPE_TXRX:
         case CELLTYPE_TX:
@@ -1005,8 +1027,12 @@ port_INLINE void activity_ti1ORri1(void) {
             // get the neighbor
             schedule_getNeighbor(&neighbor);
 
-            // check whether we can send
-            if (schedule_getOkToSend()) {
+            if (ieee154e_vars.burst.isThisSlot) {
+                // keep sending to the neighbor of the burst
+                memcpy(&neighbor, &ieee154e_vars.burst.neighbor, sizeof(open_addr_t));
+                ieee154e_vars.dataToSend = openqueue_macGetUnicastPacket(&neighbor);
+            } else if (schedule_getOkToSend()) {
+                // check whether we can send
                 if (packetfunctions_isBroadcastMulticast(&neighbor) == FALSE) {
 
                     // look for a unicast packet to send
@@ -1052,30 +1078,38 @@ port_INLINE void activity_ti1ORri1(void) {
                     join_priority = (icmpv6rpl_getMyDAGrank() / MINHOPRANKINCREASE) - 1; //poipoi -- use dagrank(rank)-1
                     memcpy(ieee154e_vars.dataToSend->l2_ASNpayload, &asn[0], sizeof(asn_t));
                     memcpy(ieee154e_vars.dataToSend->l2_ASNpayload + sizeof(asn_t), &join_priority, sizeof(uint8_t));
+#if IEEE802154E_CHANNEL_BLACKLIST
+                    // fill in the blacklist, or the one announced for the next epoch
+                    if (ieee154e_vars.isChTemplatePending) {
+                        ieee154e_vars.dataToSend->l2_ASNpayload[EB_SLOTFRAME_CH_ID_OFFSET - EB_ASN0_OFFSET] =
+                                CHTEMPLATE_PENDING | ieee154e_vars.chTemplateIdPending;
+                    } else {
+                        ieee154e_vars.dataToSend->l2_ASNpayload[EB_SLOTFRAME_CH_ID_OFFSET - EB_ASN0_OFFSET] =
+                                ieee154e_vars.chTemplateId;
+                    }
+#endif
                 }
+                // announce more frames if they can follow in the next slot
+                ieee154e_vars.burst.isPending =
+                        burstCanContinue() && openqueue_macGetUnicastPacket(&neighbor) != NULL;
+                ieee802154_setFramePending(ieee154e_vars.dataToSend, ieee154e_vars.burst.isPending);
                 // record that I attempt to transmit this packet
                 ieee154e_vars.dataToSend->l2_numTxAttempts++;
 #ifdef SLOT_FSM_IMPLEMENTATION_MULTIPLE_TIMER_INTERRUPT
                 // 1. schedule timer for loading packet
                 sctimer_scheduleActionIn(ACTION_LOAD_PACKET, ieee154e_vars.startOfSlotReference+DURATION_tt1);
                 // prepare the packet for load packet action at DURATION_tt1
-                // make a local copy of the frame
-                packetfunctions_duplicatePacket(&ieee154e_vars.localCopyForTransmission, ieee154e_vars.dataToSend);
-
-                // check if packet needs to be encrypted/authenticated before transmission
-                if (ieee154e_vars.localCopyForTransmission.l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) { // security enabled
-                    // encrypt in a local copy
-                    if (IEEE802154_security_outgoingFrameSecurity(&ieee154e_vars.localCopyForTransmission) != E_SUCCESS) {
-                        // keep the frame in the OpenQueue in order to retry later
-                        endSlot(); // abort
-                        return;
-                    }
+                // secure the frame, if needed
+                OpenQueueEntry_t* txFrame;
+                if (prepareTxFrame(&txFrame) != E_SUCCESS) {
+                    // keep the frame in the OpenQueue in order to retry later
+                    endSlot(); // abort
+                    return;
                 }
 
-                // add 2 CRC bytes only to the local copy as we end up here for each retransmission
-                OpenQueueEntry_t* copy;
-                localCopy = &ieee154e_vars.localCopyForTransmission;
-                if (packetfunctions_reserveFooter(&localCopy, 2) == E_FAIL){
+                // add 2 CRC bytes only while loading the frame, as we end up here for each retransmission
+                if (packetfunctions_reserveFooter(&txFrame, LENGTH_CRC) == E_FAIL){
+                    packetfunctions_tossFooter(&txFrame, LENGTH_CRC);
                     endSlot();
                     return;
                 }
@@ -1084,8 +1118,8 @@ port_INLINE void activity_ti1ORri1(void) {
                 radio_setFrequency(ieee154e_vars.freq, FREQ_TX);
 
                 // set the tx buffer address and length register.(packet is NOT loaded at this moment)
-                radio_loadPacket_prepare(ieee154e_vars.localCopyForTransmission.payload,
-                                     ieee154e_vars.localCopyForTransmission.length);
+                radio_loadPacket_prepare(txFrame->payload, txFrame->length);
+                packetfunctions_tossFooter(&txFrame, LENGTH_CRC);
                 // 2. schedule timer for sending packet
                 sctimer_scheduleActionIn(ACTION_SEND_PACKET,  ieee154e_vars.startOfSlotReference+DURATION_tt2);
                 // 3. schedule timer radio tx watchdog
@@ -1159,24 +1193,17 @@ port_INLINE void activity_ti2(void) {
             TIME_TICS,                                        // timetype
             isr_ieee154e_timer                                // callback
     );
-    // make a local copy of the frame
-    packetfunctions_duplicatePacket(&ieee154e_vars.localCopyForTransmission, ieee154e_vars.dataToSend);
-
-    // check if packet needs to be encrypted/authenticated before transmission
-    if (ieee154e_vars.localCopyForTransmission.l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) { // security enabled
-        // encrypt in a local copy
-        if (IEEE802154_security_outgoingFrameSecurity(&ieee154e_vars.localCopyForTransmission) != E_SUCCESS) {
-            // keep the frame in the OpenQueue in order to retry later
-            endSlot(); // abort
-            return;
-        }
+    // secure the frame, if needed
+    OpenQueueEntry_t* txFrame;
+    if (prepareTxFrame(&txFrame) != E_SUCCESS) {
+        // keep the frame in the OpenQueue in order to retry later
+        endSlot(); // abort
+        return;
     }
 
-    // add 2 CRC bytes only to the local copy as we end up here for each retransmission
-
-    OpenQueueEntry_t* localCopy;
-    localCopy = &ieee154e_vars.localCopyForTransmission;
-    if (packetfunctions_reserveFooter(&localCopy, 2) == E_FAIL){
+    // add 2 CRC bytes only while loading the frame, as we end up here for each retransmission
+    if (packetfunctions_reserveFooter(&txFrame, LENGTH_CRC) == E_FAIL){
+        packetfunctions_tossFooter(&txFrame, LENGTH_CRC);
         // packet too big, will never successfully be transmitted, drop immediately
         // set retries to 1, so after it get decremented in endSlot, we drop the packet
         ieee154e_vars.dataToSend->l2_retriesLeft = 1;
@@ -1188,7 +1215,8 @@ port_INLINE void activity_ti2(void) {
     radio_setFrequency(ieee154e_vars.freq, FREQ_TX);
 
     // load the packet in the radio's Tx buffer
-    radio_loadPacket(ieee154e_vars.localCopyForTransmission.payload, ieee154e_vars.localCopyForTransmission.length);
+    radio_loadPacket(txFrame->payload, txFrame->length);
+    packetfunctions_tossFooter(&txFrame, LENGTH_CRC);
 #endif
     // enable the radio in Tx mode. This does not send the packet.
     radio_txEnable();
@@ -1413,6 +1441,9 @@ port_INLINE void activity_ti7(void) {
 port_INLINE void activity_tie5(void) {
     // indicate transmit failed to schedule to keep stats
     schedule_indicateTx(&ieee154e_vars.asn, FALSE);
+#if IEEE802154E_CHANNEL_BLACKLIST
+    updateChannelStats(FALSE);
+#endif
 
     // decrement transmits left counter
     ieee154e_vars.dataToSend->l2_retriesLeft--;
@@ -1526,7 +1557,7 @@ port_INLINE void activity_ti9(PORT_TIMER_WIDTH capturedTime) {
         radio_getReceivedFrame(
                 ieee154e_vars.ackReceived->payload,
                 (uint8_t * ) & ieee154e_vars.ackReceived->length,
-                sizeof(ieee154e_vars.ackReceived->packet),
+                ieee154e_vars.ackReceived->packet_size,
                 &ieee154e_vars.ackReceived->l1_rssi,
                 &ieee154e_vars.ackReceived->l1_lqi,
                 &ieee154e_vars.ackReceived->l1_crc
@@ -1593,6 +1624,14 @@ port_INLINE void activity_ti9(PORT_TIMER_WIDTH capturedTime) {
 
         // inform schedule of successful transmission
         schedule_indicateTx(&ieee154e_vars.asn, TRUE);
+#if IEEE802154E_CHANNEL_BLACKLIST
+        updateChannelStats(TRUE);
+#endif
+
+        // the receiver sets the frame pending bit in the ACK if it listens in the next slot
+        if (ieee154e_vars.burst.isPending && ieee802514_header.framePending) {
+            burstContinue(CELLTYPE_TX, &ieee154e_vars.dataToSend->l2_nextORpreviousHop);
+        }
 
         // inform upper layer
         notif_sendDone(ieee154e_vars.dataToSend, E_SUCCESS);
@@ -1766,7 +1805,7 @@ port_INLINE void activity_ri5(PORT_TIMER_WIDTH capturedTime) {
         radio_getReceivedFrame(
                 ieee154e_vars.dataReceived->payload,
                 (uint8_t * ) & ieee154e_vars.dataReceived->length,
-                sizeof(ieee154e_vars.dataReceived->packet),
+                ieee154e_vars.dataReceived->packet_size,
                 &ieee154e_vars.dataReceived->l1_rssi,
                 &ieee154e_vars.dataReceived->l1_lqi,
                 &ieee154e_vars.dataReceived->l1_crc
@@ -1866,9 +1905,11 @@ port_INLINE void activity_ri5(PORT_TIMER_WIDTH capturedTime) {
 
         // check if ack requested
         if (ieee802514_header.ackRequested == 1 && ieee154e_vars.isAckEnabled == TRUE) {
+            // listen in the next slot if the sender has more frames for me and that slot is free
+            ieee154e_vars.burst.isPending = ieee802514_header.framePending && burstCanContinue();
 #ifdef SLOT_FSM_IMPLEMENTATION_MULTIPLE_TIMER_INTERRUPT
             // get a buffer to put the ack to send in
-            ieee154e_vars.ackToSend = openqueue_getFreePacketBuffer(COMPONENT_IEEE802154E);
+            ieee154e_vars.ackToSend = openqueue_getFreeSmallPacketBuffer(COMPONENT_IEEE802154E);
             if (ieee154e_vars.ackToSend == NULL) {
                 // log the error
                 LOG_ERROR(COMPONENT_IEEE802154E, ERR_NO_FREE_PACKET_BUFFER, (errorparameter_t)0, (errorparameter_t)0);
@@ -1906,6 +1947,7 @@ port_INLINE void activity_ri5(PORT_TIMER_WIDTH capturedTime) {
                     ieee154e_vars.dataReceived->l2_dsn,
                     &(ieee154e_vars.dataReceived->l2_nextORpreviousHop)
             );
+            ieee802154_setFramePending(ieee154e_vars.ackToSend, ieee154e_vars.burst.isPending);
 
             // if security is enabled, encrypt directly in OpenQueue as there are no retransmissions for ACKs
             if (ieee154e_vars.ackToSend->l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) {
@@ -2003,7 +2045,7 @@ port_INLINE void activity_ri6(void) {
     );
 
     // get a buffer to put the ack to send in
-    ieee154e_vars.ackToSend = openqueue_getFreePacketBuffer(COMPONENT_IEEE802154E);
+    ieee154e_vars.ackToSend = openqueue_getFreeSmallPacketBuffer(COMPONENT_IEEE802154E);
     if (ieee154e_vars.ackToSend == NULL) {
         // log the error
         LOG_ERROR(COMPONENT_IEEE802154E, ERR_NO_FREE_PACKET_BUFFER, (errorparameter_t)0, (errorparameter_t)0);
@@ -2041,6 +2083,7 @@ port_INLINE void activity_ri6(void) {
                              ieee154e_vars.dataReceived->l2_dsn,
                              &(ieee154e_vars.dataReceived->l2_nextORpreviousHop)
     );
+    ieee802154_setFramePending(ieee154e_vars.ackToSend, ieee154e_vars.burst.isPending);
 
     // if security is enabled, encrypt directly in OpenQueue as there are no retransmissions for ACKs
     if (ieee154e_vars.ackToSend->l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) {
@@ -2182,6 +2225,11 @@ port_INLINE void activity_ri9(PORT_TIMER_WIDTH capturedTime) {
         synchronizePacket(ieee154e_vars.syncCapturedTime);
     }
 
+    // the sender continues the burst in the next slot, now that it got the ACK
+    if (ieee154e_vars.burst.isPending) {
+        burstContinue(CELLTYPE_RX, &ieee154e_vars.dataReceived->l2_nextORpreviousHop);
+    }
+
     // inform upper layer of reception (after ACK sent)
     notif_receive(ieee154e_vars.dataReceived);
 
@@ -2241,12 +2289,20 @@ port_INLINE bool isValidAck(ieee802154_header_iht* ieee802514_header, OpenQueueE
 
 //======= ASN handling
 
-port_INLINE void incrementAsnOffset(void) {
+/**
+\brief Move the ASN and the offsets derived from it on by numSlots slots.
+
+Takes the same time whatever the number of slots, so that sleeping over idle
+slots does not cost a loop over them.
+*/
+port_INLINE void incrementAsnOffset(PORT_TIMER_WIDTH numSlots) {
     frameLength_t frameLength;
+    uint16_t bytes0and1;
 
     // increment the asn
-    ieee154e_vars.asn.bytes0and1++;
-    if (ieee154e_vars.asn.bytes0and1 == 0) {
+    bytes0and1 = ieee154e_vars.asn.bytes0and1;
+    ieee154e_vars.asn.bytes0and1 += (uint16_t) numSlots;
+    if (ieee154e_vars.asn.bytes0and1 < bytes0and1) {
         ieee154e_vars.asn.bytes2and3++;
         if (ieee154e_vars.asn.bytes2and3 == 0) {
             ieee154e_vars.asn.byte4++;
@@ -2256,11 +2312,27 @@ port_INLINE void incrementAsnOffset(void) {
     // increment the offsets
     frameLength = schedule_getFrameLength();
     if (frameLength == 0) {
-        ieee154e_vars.slotOffset++;
+        ieee154e_vars.slotOffset += numSlots;
     } else {
-        ieee154e_vars.slotOffset = (ieee154e_vars.slotOffset + 1) % frameLength;
+        ieee154e_vars.slotOffset = (ieee154e_vars.slotOffset + numSlots) % frameLength;
+    }
+    schedule_incrementSlotOffsets(numSlots);
+    ieee154e_vars.asnOffset = (ieee154e_vars.asnOffset + numSlots) % ieee154e_vars.numChannels;
+
+#if IEEE802154E_CHANNEL_BLACKLIST
+    // a new epoch starts on each multiple of BLACKLIST_EPOCH, the next
+    // blacklist is announced during its last BLACKLIST_ANNOUNCE slots
+    if (
+            ((bytes0and1 ^ ieee154e_vars.asn.bytes0and1) & ~(BLACKLIST_ANNOUNCE - 1)) != 0 ||
+            ieee154e_vars.asn.bytes0and1 < bytes0and1
+            ) {
+        if ((ieee154e_vars.asn.bytes0and1 & (BLACKLIST_EPOCH - 1)) < BLACKLIST_ANNOUNCE) {
+            startChannelEpoch();
+        } else if ((ieee154e_vars.asn.bytes0and1 & (BLACKLIST_EPOCH - 1)) >= BLACKLIST_EPOCH - BLACKLIST_ANNOUNCE) {
+            announceChannelBlacklist();
+        }
     }
-    ieee154e_vars.asnOffset = (ieee154e_vars.asnOffset + 1) % NUM_CHANNELS;
+#endif
 }
 
 port_INLINE void ieee154e_resetAsn(void) {
@@ -2424,8 +2496,10 @@ bool isValidEbFormat(OpenQueueEntry_t *pkt, uint16_t *lenIE) {
             sublen = (temp16b & IEEE802154E_DESC_LEN_LONG_MLME_IE_MASK);
             switch (subid) {
                 case IEEE802154E_MLME_CHANNELHOPPING_IE_SUBID:
-                    channelhoppingTemplateIDStoreFromEB(*((uint8_t * )(pkt->payload + ptr)));
-                    chTemplate_checkPass = TRUE;
+                    chTemplate_checkPass = channelhoppingTemplateIDStoreFromEB(
+                            *((uint8_t * )(pkt->payload + ptr)),
+                            &pkt->l2_nextORpreviousHop
+                    );
                     break;
                 default:
                     // unsupported IE type, skip the ie
@@ -2467,6 +2541,7 @@ bool isValidEbFormat(OpenQueueEntry_t *pkt, uint16_t *lenIE) {
                             channeloffset |= *((uint8_t * )(pkt->payload + ptr + 5 + 5 * i + 3)) << 8;
 
                             schedule_addActiveSlot(
+                                    SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE, // slotframe handle
                                     slotoffset,    // slot offset
                                     CELLTYPE_TXRX, // type of slot
                                     TRUE,          // shared?
@@ -2503,36 +2578,78 @@ port_INLINE void asnStoreFromEB(uint8_t *asn) {
 }
 
 port_INLINE void ieee154e_syncSlotOffset(void) {
-    frameLength_t frameLength;
-    uint32_t slotOffset;
-    uint8_t i;
-
-    frameLength = schedule_getFrameLength();
-
     // determine the current slotOffset
-    slotOffset = ieee154e_vars.asn.byte4;
-    slotOffset = slotOffset % frameLength;
-    slotOffset = slotOffset << 16;
-    slotOffset = slotOffset + ieee154e_vars.asn.bytes2and3;
-    slotOffset = slotOffset % frameLength;
-    slotOffset = slotOffset << 16;
-    slotOffset = slotOffset + ieee154e_vars.asn.bytes0and1;
-    slotOffset = slotOffset % frameLength;
-
-    ieee154e_vars.slotOffset = (slotOffset_t) slotOffset;
+    ieee154e_vars.slotOffset = (slotOffset_t) asnModulo(schedule_getFrameLength());
 
     schedule_syncSlotOffset(ieee154e_vars.slotOffset);
     ieee154e_vars.nextActiveSlotOffset = schedule_getNextActiveSlotOffset();
-    /*
-    infer the asnOffset based on the fact that
-    ieee154e_vars.freq = 11 + (asnOffset + channelOffset)%16
-    */
-    for (i = 0; i < NUM_CHANNELS; i++) {
-        if ((ieee154e_vars.freq - 11) == ieee154e_vars.chTemplate[i]) {
-            break;
-        }
+
+    // the channel is chTemplate[(ASN + channelOffset) % numChannels]
+    ieee154e_vars.asnOffset = (uint8_t) asnModulo(ieee154e_vars.numChannels);
+}
+
+/**
+\brief The ASN modulo some divisor, e.g. the slotframe length.
+*/
+port_INLINE uint16_t asnModulo(uint16_t divisor) {
+    uint32_t remainder;
+
+    remainder = ieee154e_vars.asn.byte4;
+    remainder = remainder % divisor;
+    remainder = remainder << 16;
+    remainder = remainder + ieee154e_vars.asn.bytes2and3;
+    remainder = remainder % divisor;
+    remainder = remainder << 16;
+    remainder = remainder + ieee154e_vars.asn.bytes0and1;
+    remainder = remainder % divisor;
+
+    return (uint16_t) remainder;
+}
+
+/**
+\brief Sleep until the next active slot, without waking up in the idle slots.
+
+Arms the slot timer for the start of the slot at nextActiveSlotOffset. The ASN
+is moved on over the skipped slots in one step when that slot starts. This is
+done on every mote, the DAG root included. The serial inhibit window is armed
+relative to the end of the slot duration, so it moves to just before the next
+active slot.
+*/
+port_INLINE void skipToNextActiveSlot(void) {
+    frameLength_t frameLength;
+    PORT_TIMER_WIDTH numOfSleepSlots;
+
+    frameLength = schedule_getFrameLength();
+    if (IEEE802154E_SLOT_SKIP == 0 || frameLength == 0) {
+        return;
     }
-    ieee154e_vars.asnOffset = i - schedule_getChannelOffset();
+
+    if (ieee154e_vars.nextActiveSlotOffset > ieee154e_vars.slotOffset) {
+        numOfSleepSlots = ieee154e_vars.nextActiveSlotOffset - ieee154e_vars.slotOffset;
+    } else {
+        numOfSleepSlots = frameLength + ieee154e_vars.nextActiveSlotOffset - ieee154e_vars.slotOffset;
+    }
+    // the slot duration is 16-bit, a longer sleep is cut short and goes on from the slot it ends in
+    if (numOfSleepSlots > 0xffff / TsSlotDuration) {
+        numOfSleepSlots = 0xffff / TsSlotDuration;
+    }
+    if (numOfSleepSlots <= 1) {
+        return;
+    }
+
+    ieee154e_vars.numOfSleepSlots = numOfSleepSlots;
+    opentimers_scheduleAbsolute(
+            ieee154e_vars.timerId,                            // timerId
+            TsSlotDuration * numOfSleepSlots,                 // duration
+            ieee154e_vars.startOfSlotReference,               // reference
+            TIME_TICS,                                        // timetype
+            isr_ieee154e_newSlot                              // callback
+    );
+#if OPENWSN_ADAPTIVE_SYNC_C
+    // the drift compensation counts slots, not wake-ups
+    adaptive_sync_countCompensationTimeout_compoundSlots(numOfSleepSlots - 1);
+#endif
+    ieee154e_vars.slotDuration = TsSlotDuration * numOfSleepSlots;
 }
 
 uint16_t ieee154e_getSlotDuration(void) {
@@ -2545,9 +2662,173 @@ port_INLINE void timeslotTemplateIDStoreFromEB(uint8_t id) {
 }
 
 // channelhopping template handling
-port_INLINE void channelhoppingTemplateIDStoreFromEB(uint8_t id) {
+
+/**
+\brief Store the channel hopping template ID of an EB.
+
+With IEEE802154E_CHANNEL_BLACKLIST, the ID is a blacklist. A mote joining
+takes the blacklist in use from the EB, and rejects EBs announcing one for the
+next epoch, as the one in use cannot be told from them. Those are only sent
+during the last BLACKLIST_ANNOUNCE slots of an epoch, and only when the
+blacklist changes. Once synchronized, a mote follows the EBs of its preferred
+parent only: it takes up the blacklist announced for the next epoch, and
+passes it on sooner by resetting the Trickle timer of its EBs, or catches up
+if it missed one.
+
+\returns FALSE iff a joining mote cannot use this EB.
+*/
+port_INLINE bool channelhoppingTemplateIDStoreFromEB(uint8_t id, open_addr_t *src) {
+#if IEEE802154E_CHANNEL_BLACKLIST
+    if (ieee154e_vars.isSync == FALSE) {
+        if (id & CHTEMPLATE_PENDING) {
+            return FALSE;
+        }
+        ieee154e_vars.isChTemplatePending = FALSE;
+        setChannelTemplate(id);
+    } else if (icmpv6rpl_isPreferredParent(src)) {
+        if (id & CHTEMPLATE_PENDING) {
+            if (
+                    ieee154e_vars.isChTemplatePending == FALSE ||
+                    ieee154e_vars.chTemplateIdPending != (id & CHTEMPLATE_BLACKLIST_MASK)
+                    ) {
+                sixtop_resetEbTrickle();
+            }
+            ieee154e_vars.isChTemplatePending = TRUE;
+            ieee154e_vars.chTemplateIdPending = id & CHTEMPLATE_BLACKLIST_MASK;
+        } else if (id != ieee154e_vars.chTemplateId) {
+            ieee154e_vars.isChTemplatePending = FALSE;
+            setChannelTemplate(id);
+        }
+    }
+#else
     ieee154e_vars.chTemplateId = id;
+#endif
+    return TRUE;
 }
+
+/**
+\brief Hop over the channels the blacklist in the template ID leaves.
+
+The channels keep the order of the default template.
+*/
+port_INLINE void setChannelTemplate(uint8_t id) {
+    uint8_t i;
+    uint8_t channel;
+
+    ieee154e_vars.chTemplateId = id;
+    ieee154e_vars.numChannels = 0;
+    for (i = 0; i < NUM_CHANNELS; i++) {
+        channel = chTemplate_default[i];
+        if (channel / 2 < 7 && (id & (1 << (channel / 2)))) {
+            continue;
+        }
+        ieee154e_vars.chTemplate[ieee154e_vars.numChannels] = channel;
+        ieee154e_vars.numChannels++;
+    }
+    ieee154e_vars.asnOffset = (uint8_t) asnModulo(ieee154e_vars.numChannels);
+}
+
+#if IEEE802154E_CHANNEL_BLACKLIST
+/**
+\brief Count a unicast transmission in the channel quality table.
+*/
+port_INLINE void updateChannelStats(bool wasAcked) {
+    ieee154e_channelStats_t *stats;
+
+    if (
+            ieee154e_vars.freq < 11 || ieee154e_vars.freq >= 11 + NUM_CHANNELS ||
+            packetfunctions_isBroadcastMulticast(&ieee154e_vars.dataToSend->l2_nextORpreviousHop)
+            ) {
+        return;
+    }
+    stats = &ieee154e_vars.channelStats[ieee154e_vars.freq - 11];
+    if (stats->numTx == 0xffff) {
+        stats->numTx /= 2;
+        stats->numTxACK /= 2;
+    }
+    stats->numTx++;
+    if (wasAcked) {
+        stats->numTxACK++;
+    }
+}
+
+/**
+\brief A new epoch starts: the blacklist announced during the last one applies.
+*/
+port_INLINE void startChannelEpoch(void) {
+    if (ieee154e_vars.isChTemplatePending) {
+        ieee154e_vars.isChTemplatePending = FALSE;
+        setChannelTemplate(ieee154e_vars.chTemplateIdPending);
+    }
+}
+
+/**
+\brief The last BLACKLIST_ANNOUNCE slots of an epoch start: average the PDR of
+each channel, and the DAG root announces the blacklist for the next epoch.
+
+Channels without enough transmissions, e.g. blacklisted ones, slowly recover
+a good PDR so that they get tried again. The PDRs are those of the unicast
+transmissions of this mote, so the blacklist the DAG root computes reflects
+its own links only.
+*/
+port_INLINE void announceChannelBlacklist(void) {
+    uint8_t i;
+    ieee154e_channelStats_t *stats;
+    uint8_t blacklist;
+
+    for (i = 0; i < NUM_CHANNELS; i++) {
+        stats = &ieee154e_vars.channelStats[i];
+        if (stats->numTx >= BLACKLIST_MIN_TX) {
+            stats->pdr = (uint8_t)((stats->pdr + ((uint32_t) stats->numTxACK * 100) / stats->numTx) / 2);
+        } else {
+            stats->pdr += (100 - stats->pdr) / 4;
+        }
+        stats->numTx = 0;
+        stats->numTxACK = 0;
+    }
+
+    if (idmanager_getIsDAGroot() == TRUE) {
+        blacklist = computeChannelBlacklist();
+        if (blacklist != ieee154e_vars.chTemplateId) {
+            ieee154e_vars.isChTemplatePending = TRUE;
+            ieee154e_vars.chTemplateIdPending = blacklist;
+            sixtop_resetEbTrickle();
+        }
+    }
+}
+
+/**
+\brief Blacklist the channel pairs with the lowest PDR under BLACKLIST_MIN_PDR.
+
+\returns The blacklist, as a channel hopping template ID.
+*/
+port_INLINE uint8_t computeChannelBlacklist(void) {
+    uint8_t blacklist;
+    uint8_t numPairs;
+    uint8_t pair;
+    uint8_t pdr;
+    uint8_t worstPair;
+    uint8_t worstPdr;
+
+    blacklist = 0;
+    for (numPairs = 0; numPairs < BLACKLIST_MAX_PAIRS; numPairs++) {
+        worstPdr = BLACKLIST_MIN_PDR;
+        worstPair = 0xff;
+        for (pair = 0; pair < 7; pair++) {
+            pdr = (ieee154e_vars.channelStats[2 * pair].pdr + ieee154e_vars.channelStats[2 * pair + 1].pdr) / 2;
+            if ((blacklist & (1 << pair)) == 0 && pdr < worstPdr) {
+                worstPdr = pdr;
+                worstPair = pair;
+            }
+        }
+        if (worstPair == 0xff) {
+            break;
+        }
+        blacklist |= 1 << worstPair;
+    }
+    return blacklist;
+}
+#endif
 //======= synchronization
 
 void synchronizePacket(PORT_TIMER_WIDTH timeReceived) {
@@ -2580,7 +2861,7 @@ void synchronizePacket(PORT_TIMER_WIDTH timeReceived) {
     if ((PORT_SIGNED_INT_WIDTH) newPeriod - (PORT_SIGNED_INT_WIDTH) currentValue <
         (PORT_SIGNED_INT_WIDTH) RESYNCHRONIZATIONGUARD) {
         newPeriod += TsSlotDuration;
-        incrementAsnOffset();
+        incrementAsnOffset(1);
     }
 
     // resynchronize by applying the new period
@@ -2674,6 +2955,7 @@ void changeIsSync(bool newIsSync) {
     } else {
         leds_sync_off();
         schedule_resetBackoff();
+        ieee154e_vars.burst.isNextSlot = FALSE;
     }
 }
 
@@ -2729,8 +3011,85 @@ void updateStats(PORT_SIGNED_INT_WIDTH timeCorrection) {
     }
 }
 
+//======= burst
+
+/**
+\brief Decides whether the cell of the current slot can be extended over the next slot.
+
+A burst only extends dedicated cells, over slots which are not scheduled, and
+never spans more than IEEE802154E_BURST_LENGTH slots.
+
+\returns TRUE if the next slot can be used for the next frame of a burst.
+*/
+bool burstCanContinue(void) {
+    uint8_t numSlots;
+
+    if (ieee154e_vars.burst.isThisSlot) {
+        numSlots = ieee154e_vars.burst.numSlots;
+    } else {
+        if (schedule_getShared()) {
+            return FALSE;
+        }
+        numSlots = 1;
+    }
+
+    if (numSlots >= IEEE802154E_BURST_LENGTH) {
+        return FALSE;
+    }
+
+    return (ieee154e_vars.slotOffset + 1) % schedule_getFrameLength() != ieee154e_vars.nextActiveSlotOffset;
+}
+
+/**
+\brief Records that the next slot continues the burst with a neighbor.
+
+Called once both sides know, i.e. when the ACK with the frame pending bit is
+received (sender) or sent (receiver).
+
+\param[in] cellType CELLTYPE_TX when sending the frames of the burst, CELLTYPE_RX when receiving them.
+\param[in] neighbor The neighbor I exchange frames with.
+*/
+void burstContinue(cellType_t cellType, open_addr_t *neighbor) {
+    if (ieee154e_vars.burst.isThisSlot == FALSE) {
+        // the burst starts in this cell
+        ieee154e_vars.burst.channelOffset = schedule_getChannelOffset();
+        ieee154e_vars.burst.numSlots = 1;
+    }
+    ieee154e_vars.burst.numSlots++;
+    ieee154e_vars.burst.isNextSlot = TRUE;
+    ieee154e_vars.burst.cellType = cellType;
+    memcpy(&ieee154e_vars.burst.neighbor, neighbor, sizeof(open_addr_t));
+}
+
 //======= misc
 
+/**
+\brief Prepares the frame to load into the radio for the current TX attempt.
+
+The frame in the OpenQueue is not modified, as it is needed again for
+retransmissions. An unsecured frame is loaded straight from the OpenQueue, the
+room for its CRC has been reserved when its chunk was allocated. A secured frame
+cannot be reused across attempts, as its nonce contains the ASN. Only its octets
+are copied into localCopyForTransmission, where it is secured.
+
+\param[out] txFrame The frame to load into the radio.
+
+\returns E_SUCCESS if the frame is ready, E_FAIL if it could not be secured.
+*/
+owerror_t prepareTxFrame(OpenQueueEntry_t **txFrame) {
+    *txFrame = ieee154e_vars.dataToSend;
+
+    // check if packet needs to be encrypted/authenticated before transmission
+    if ((*txFrame)->l2_securityLevel != IEEE154_ASH_SLF_TYPE_NOSEC) { // security enabled
+        // encrypt in a local copy
+        *txFrame = &ieee154e_vars.localCopyForTransmission;
+        packetfunctions_duplicateFrame(*txFrame, ieee154e_vars.dataToSend);
+        return IEEE802154_security_outgoingFrameSecurity(*txFrame);
+    }
+
+    return E_SUCCESS;
+}
+
 /**
 \brief Calculates the frequency channel to transmit on, based on the absolute slot number and the channel offset of
  the requested slot.
@@ -2752,7 +3111,7 @@ port_INLINE uint8_t calculateFrequency(uint8_t channelOffset) {
         return ieee154e_vars.singleChannel; // single channel
     } else {
         // channel hopping enabled, use the channel depending on hopping template
-        return 11 + ieee154e_vars.chTemplate[(ieee154e_vars.asnOffset + channelOffset) % NUM_CHANNELS];
+        return 11 + ieee154e_vars.chTemplate[(ieee154e_vars.asnOffset + channelOffset) % ieee154e_vars.numChannels];
     }
 }
 
@@ -2860,6 +3219,9 @@ void endSlot(void) {
         // if everything went well, dataToSend was set to NULL in ti9, getting here means transmit failed
         // indicate Tx fail to schedule to update stats
         schedule_indicateTx(&ieee154e_vars.asn, FALSE);
+#if IEEE802154E_CHANNEL_BLACKLIST
+        updateChannelStats(FALSE);
+#endif
 
         //decrement transmits left counter
         ieee154e_vars.dataToSend->l2_retriesLeft--;
@@ -2876,7 +3238,7 @@ void endSlot(void) {
         ieee154e_vars.dataToSend = NULL;
     }
 
-    schedule_getSlotInfo(ieee154e_vars.slotOffset, &info);
+    schedule_getCurrentSlotInfo(ieee154e_vars.slotOffset, &info);
     if (info.link_type == CELLTYPE_RX) {
         // update numcellelapsed and numcellused on Rx cell
 
@@ -2942,6 +3304,7 @@ void endSlot(void) {
         schedule_getNeighbor(&slotNeighbor);
         if (openqueue_macGetUnicastPacket(&slotNeighbor) == NULL) {
             schedule_removeActiveSlot(
+                    SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE,
                     ieee154e_vars.slotOffset,
                     CELLTYPE_TX,
                     TRUE,
@@ -12,6 +12,7 @@
 #include "board.h"
 #include "opentimers.h"
 #include "schedule.h"
+#include "openqueue.h"
 
 //=========================== debug define ====================================
 
@@ -39,6 +40,30 @@ static const uint8_t ebIEsBytestream[] = {
 #define EB_IE_LEN                   28
 
 #define NUM_CHANNELS                16  // number of channels to channel hop on
+// channel blacklisting, see IEEE802154E_CHANNEL_BLACKLIST
+#define CHTEMPLATE_PENDING        0x80  // template ID flag: the blacklist applies from the next epoch on
+#define CHTEMPLATE_BLACKLIST_MASK 0x7f  // template ID bit n blacklists channels 11+2n and 12+2n
+#ifndef BLACKLIST_EPOCH
+#define BLACKLIST_EPOCH         0x4000  // in slots, power of 2 up to 0x10000: the blacklist changes on multiples
+#endif
+#if BLACKLIST_EPOCH < 1 || (BLACKLIST_EPOCH & (BLACKLIST_EPOCH - 1)) || BLACKLIST_EPOCH > 0x10000
+#error "BLACKLIST_EPOCH must be a power of 2 up to 0x10000."
+#endif
+#ifndef BLACKLIST_ANNOUNCE
+#define BLACKLIST_ANNOUNCE (BLACKLIST_EPOCH / 4) // in slots, power of 2: the next blacklist is announced this long before
+#endif
+#if BLACKLIST_ANNOUNCE < 1 || (BLACKLIST_ANNOUNCE & (BLACKLIST_ANNOUNCE - 1)) || BLACKLIST_ANNOUNCE >= BLACKLIST_EPOCH
+#error "BLACKLIST_ANNOUNCE must be a power of 2 smaller than BLACKLIST_EPOCH."
+#endif
+#ifndef BLACKLIST_MIN_PDR
+#define BLACKLIST_MIN_PDR           50  // in percent, channel pairs with a lower PDR get blacklisted
+#endif
+#ifndef BLACKLIST_MIN_TX
+#define BLACKLIST_MIN_TX             8  // transmissions per epoch for the PDR of a channel to count
+#endif
+#ifndef BLACKLIST_MAX_PAIRS
+#define BLACKLIST_MAX_PAIRS          4  // at most 8 of the 16 channels get blacklisted
+#endif
 #define TXRETRIES                   15  // number of MAC retries before declaring failed
 #define TX_POWER                    31  // 1=-25dBm, 31=0dBm (max value)
 #define RESYNCHRONIZATIONGUARD       5  // in 32kHz ticks. min distance to the end of the slot to successfully synchronize
@@ -247,6 +272,23 @@ typedef struct {
     PORT_SIGNED_INT_WIDTH timeCorrection;
 } IEEE802154E_ACK_ht;
 
+// burst of frames over consecutive slots
+typedef struct {
+    bool isPending;                                 // TRUE iff the frame pending bit is set in the frame/ACK sent this slot
+    bool isThisSlot;                                // TRUE iff the current slot continues a burst
+    bool isNextSlot;                                // TRUE iff the burst continues in the next slot
+    cellType_t cellType;                            // CELLTYPE_TX or CELLTYPE_RX, depending on my role in the burst
+    open_addr_t neighbor;                           // neighbor I exchange frames with
+    channelOffset_t channelOffset;                  // channel offset of the cell the burst started in
+    uint8_t numSlots;                               // number of slots spanned by the burst so far
+} ieee154e_burst_t;
+
+typedef struct {
+    uint16_t numTx;                                 // unicast transmissions during the current epoch
+    uint16_t numTxACK;                              // ... which were acknowledged
+    uint8_t pdr;                                    // PDR in percent, averaged over the epochs
+} ieee154e_channelStats_t;
+
 //=========================== module variables ================================
 
 typedef struct {
@@ -256,7 +298,8 @@ typedef struct {
     slotOffset_t nextActiveSlotOffset;              // next active slot offset
     PORT_TIMER_WIDTH deSyncTimeout;                 // how many slots left before looses sync
     bool isSync;                                    // TRUE iff mote is synchronized to network
-    OpenQueueEntry_t localCopyForTransmission;      // copy of the frame used for current TX
+    OpenQueueEntry_t localCopyForTransmission;      // copy of the secured frame used for current TX
+    uint8_t localCopyPacket[OPENQUEUE_FRAME_CHUNK_SIZE]; // chunk holding that copy
     PORT_TIMER_WIDTH numOfSleepSlots;               // number of slots to sleep between active slots
     // as shown on the chronogram
     ieee154e_state_t state;                         // state of the FSM
@@ -272,9 +315,17 @@ typedef struct {
     uint8_t singleChannel;                          // the single channel used for transmission
     bool singleChannelChanged;                      // detect id singleChannelChanged
     uint8_t chTemplate[NUM_CHANNELS];               // storing the template of hopping sequence
+    uint8_t numChannels;                            // number of channels in chTemplate
+#if IEEE802154E_CHANNEL_BLACKLIST
+    ieee154e_channelStats_t channelStats[NUM_CHANNELS]; // channel quality table, indexed by channel-11
+#endif
     // template ID
     uint8_t tsTemplateId;                           // timeslot template id
     uint8_t chTemplateId;                           // channel hopping tempalte id
+#if IEEE802154E_CHANNEL_BLACKLIST
+    bool isChTemplatePending;                       // TRUE iff the next epoch starts with a new blacklist
+    uint8_t chTemplateIdPending;                    // that blacklist
+#endif
 
     PORT_TIMER_WIDTH radioOnInit;                   // when within the slot the radio turns on
     PORT_TIMER_WIDTH radioOnTics;                   // how many tics within the slot the radio is on
@@ -294,6 +345,9 @@ typedef struct {
     // for msf downstream traffic adaptation
     uint32_t receivedFrameFromParent;               // True when received a frame from parent
 
+    // burst transmission
+    ieee154e_burst_t burst;
+
     uint16_t compensatingCounter;
 } ieee154e_vars_t;
 
@@ -14,6 +14,7 @@
 #include "IEEE802154E.h"
 #include "idmanager.h"
 #include "openserial.h"
+#include "openqueue.h"
 #include "neighbors.h"
 #include "radio.h"
 #include "IEEE802154_security.h"
@@ -48,6 +49,11 @@ void IEEE802154_security_init(void) {
     // invalidate data key (key 2)
     ieee802154_security_vars.k2.index = IEEE802154_SECURITY_KEYINDEX_INVALID;
     memset(&ieee802154_security_vars.k2.value[0], 0x00, 16);
+
+#if OPENWSN_IEEE802154E_SECURITY_C
+    aes128_ctx_init(&ieee802154_security_vars.k1.ctx, ieee802154_security_vars.k1.value);
+    aes128_ctx_init(&ieee802154_security_vars.k2.ctx, ieee802154_security_vars.k2.value);
+#endif
 }
 
 uint8_t IEEE802154_security_getBeaconKeyIndex(void) {
@@ -61,11 +67,17 @@ uint8_t IEEE802154_security_getDataKeyIndex(void) {
 void IEEE802154_security_setBeaconKey(uint8_t index, uint8_t *value) {
     ieee802154_security_vars.k1.index = index;
     memcpy(ieee802154_security_vars.k1.value, value, 16);
+#if OPENWSN_IEEE802154E_SECURITY_C
+    aes128_ctx_init(&ieee802154_security_vars.k1.ctx, ieee802154_security_vars.k1.value);
+#endif
 }
 
 void IEEE802154_security_setDataKey(uint8_t index, uint8_t *value) {
     ieee802154_security_vars.k2.index = index;
     memcpy(ieee802154_security_vars.k2.value, value, 16);
+#if OPENWSN_IEEE802154E_SECURITY_C
+    aes128_ctx_init(&ieee802154_security_vars.k2.ctx, ieee802154_security_vars.k2.value);
+#endif
 }
 
 bool IEEE802154_security_isConfigured(void) {
@@ -128,7 +140,11 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
         case IEEE154_ASH_KEYIDMODE_DEFAULTKEYSOURCE: // macDefaultKeySource
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_16: // keySource with 16b address
-            temp_keySource = &msg->l2_keySource;
+            if (msg->metadata == NULL) {
+                LOG_ERROR(COMPONENT_SECURITY, ERR_SECURITY, (errorparameter_t) msg->l2_frameType, (errorparameter_t) 6);
+                return E_FAIL;
+            }
+            temp_keySource = &msg->metadata->l2_keySource;
             if (packetfunctions_reserveHeader(&msg, sizeof(uint8_t)) == E_FAIL) {
                 return E_FAIL;
             }
@@ -139,7 +155,11 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
             *((uint8_t * )(msg->payload)) = temp_keySource->addr_64b[7];
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_64: // keySource with 64b address
-            temp_keySource = &msg->l2_keySource;
+            if (msg->metadata == NULL) {
+                LOG_ERROR(COMPONENT_SECURITY, ERR_SECURITY, (errorparameter_t) msg->l2_frameType, (errorparameter_t) 6);
+                return E_FAIL;
+            }
+            temp_keySource = &msg->metadata->l2_keySource;
             if (packetfunctions_writeAddress(&msg, temp_keySource, OW_LITTLE_ENDIAN) == E_FAIL) {
                 return E_FAIL;
             }
@@ -172,15 +192,15 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
 */
 owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
     uint8_t nonce[13];
-    uint8_t *key;
+    aes128_ctx_t *ctx;
     owerror_t outStatus;
     uint8_t *a;
     uint8_t len_a;
     uint8_t *m;
     uint8_t len_m;
 
-    key = msg->l2_frameType == IEEE154_TYPE_BEACON ? ieee802154_security_vars.k1.value
-                                                   : ieee802154_security_vars.k2.value;
+    ctx = msg->l2_frameType == IEEE154_TYPE_BEACON ? &ieee802154_security_vars.k1.ctx
+                                                   : &ieee802154_security_vars.k2.ctx;
 
     // First 8 bytes of the nonce are always the source address of the frame
     memcpy(&nonce[0], idmanager_getMyID(ADDR_64B)->addr_64b, 8);
@@ -230,14 +250,14 @@ owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
 
     // Encryption and/or authentication
     // cryptoengine overwrites m[] with ciphertext and appends the MIC
-    outStatus = aes128_ccms_enc(a,
-                                len_a,
-                                m,
-                                &len_m,
-                                nonce,
-                                2, // L=2 in 15.4 std
-                                key,
-                                msg->l2_authenticationLength);
+    outStatus = aes128_ccms_ctx_enc(a,
+                                    len_a,
+                                    m,
+                                    &len_m,
+                                    nonce,
+                                    2, // L=2 in 15.4 std
+                                    ctx,
+                                    msg->l2_authenticationLength);
 
     // verify that no errors occurred
     if (outStatus != E_SUCCESS) {
@@ -249,8 +269,10 @@ owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
 
 /**
 \brief Parsing of IEEE802.15.4 Auxiliary Security Header.
+
+\returns E_FAIL when the header can not be parsed, the frame is to be dropped.
 */
-void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader) {
+owerror_t IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader) {
 
     uint8_t frameCnt_Suppression;
     uint8_t frameCnt_Size;
@@ -299,7 +321,7 @@ void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg,
 
         if (l2_frameCounter.byte4 == 0xff) { //frame counter overflow
             LOG_ERROR(COMPONENT_SECURITY, ERR_SECURITY, (errorparameter_t) msg->l2_frameType, (errorparameter_t) 4);
-            return;
+            return E_FAIL;
         }
 
     }
@@ -308,26 +330,33 @@ void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg,
     switch (msg->l2_keyIdMode) {
         case IEEE154_ASH_KEYIDMODE_IMPLICIT:
         case IEEE154_ASH_KEYIDMODE_DEFAULTKEYSOURCE:
-            //key is derived implicitly
-            memcpy(&(msg->l2_keySource), &tempheader->src, sizeof(open_addr_t));
+            //key is derived implicitly, the key source is the source address of the frame
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_16:
+            if (openqueue_attachMetadata(msg) == NULL) {
+                LOG_ERROR(COMPONENT_SECURITY, ERR_SECURITY, (errorparameter_t) msg->l2_frameType, (errorparameter_t) 7);
+                return E_FAIL;
+            }
             packetfunctions_readAddress(((uint8_t * )(msg->payload) + tempheader->headerLength),
                                         ADDR_16B,
-                                        &msg->l2_keySource,
+                                        &msg->metadata->l2_keySource,
                                         OW_LITTLE_ENDIAN);
             tempheader->headerLength += 2;
             break;
         case IEEE154_ASH_KEYIDMODE_EXPLICIT_64:
+            if (openqueue_attachMetadata(msg) == NULL) {
+                LOG_ERROR(COMPONENT_SECURITY, ERR_SECURITY, (errorparameter_t) msg->l2_frameType, (errorparameter_t) 7);
+                return E_FAIL;
+            }
             packetfunctions_readAddress(((uint8_t * )(msg->payload) + tempheader->headerLength),
                                         ADDR_64B,
-                                        &msg->l2_keySource,
+                                        &msg->metadata->l2_keySource,
                                         OW_LITTLE_ENDIAN);
             tempheader->headerLength += 8;
             break;
         default: //error
             LOG_ERROR(COMPONENT_SECURITY, ERR_SECURITY, (errorparameter_t) msg->l2_frameType, (errorparameter_t) 5);
-            return;
+            return E_FAIL;
     }
 
     //retrieve the KeyIndex
@@ -339,6 +368,8 @@ void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg,
         //key is derived implicitly
         msg->l2_keyIndex = 1;
     }
+
+    return E_SUCCESS;
 }
 
 /**
@@ -351,10 +382,10 @@ owerror_t IEEE802154_security_incomingFrame(OpenQueueEntry_t *msg) {
     uint8_t len_a;
     uint8_t *c;
     uint8_t len_c;
-    uint8_t *key;
+    aes128_ctx_t *ctx;
 
-    key = msg->l2_frameType == IEEE154_TYPE_BEACON ? ieee802154_security_vars.k1.value
-                                                   : ieee802154_security_vars.k2.value;
+    ctx = msg->l2_frameType == IEEE154_TYPE_BEACON ? &ieee802154_security_vars.k1.ctx
+                                                   : &ieee802154_security_vars.k2.ctx;
 
     // First 8 bytes of the nonce are always the source address of the frame
     memcpy(&nonce[0], msg->l2_nextORpreviousHop.addr_64b, 8);
@@ -395,14 +426,14 @@ owerror_t IEEE802154_security_incomingFrame(OpenQueueEntry_t *msg) {
     }
 
     // decrypt and/or verify authenticity of the frame
-    outStatus = aes128_ccms_dec(a,
-                                len_a,
-                                c,
-                                &len_c,
-                                nonce,
-                                2,
-                                key,
-                                msg->l2_authenticationLength);
+    outStatus = aes128_ccms_ctx_dec(a,
+                                    len_a,
+                                    c,
+                                    &len_c,
+                                    nonce,
+                                    2,
+                                    ctx,
+                                    msg->l2_authenticationLength);
 
     // verify if any error occurs
     if (outStatus != E_SUCCESS) {
@@ -549,8 +580,8 @@ owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *m
     return E_SUCCESS;
 }
 
-void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader) {
-    return;
+owerror_t IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader) {
+    return E_SUCCESS;
 }
 
 owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg) {
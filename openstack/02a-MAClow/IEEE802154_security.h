@@ -21,6 +21,7 @@
 #include "config.h"
 #include "opendefs.h"
 #include "IEEE802154.h"
+#include "aes128.h"
 
 //=========================== define ==========================================
 
@@ -52,6 +53,9 @@
 typedef struct {
     uint8_t index;
     uint8_t value[16];
+#if OPENWSN_IEEE802154E_SECURITY_C
+    aes128_ctx_t ctx;  // value expanded once, when the key is installed
+#endif
 } symmetric_key_802154_t;
 
 //=========================== variables =======================================
@@ -69,7 +73,7 @@ void IEEE802154_security_init(void);
 
 owerror_t IEEE802154_security_prependAuxiliarySecurityHeader(OpenQueueEntry_t *msg);
 
-void IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader);
+owerror_t IEEE802154_security_retrieveAuxiliarySecurityHeader(OpenQueueEntry_t *msg, ieee802154_header_iht *tempheader);
 
 owerror_t IEEE802154_security_outgoingFrameSecurity(OpenQueueEntry_t *msg);
 
@@ -43,6 +43,20 @@ void msf_trigger6pDelete(void);
 
 void msf_housekeeping(void);
 
+void msf_adaptToQueue(void);
+
+void msf_updateQueueRate(void);
+
+void msf_adaptToChildQueues(void);
+
+void msf_releaseChildCells(void);
+
+void msf_forgetChildren(void);
+
+uint8_t msf_getCellListLength(cellInfo_ht *cellList);
+
+uint16_t msf_hashFunction_sax(open_addr_t *address);
+
 //=========================== public ==========================================
 
 void msf_init(void) {
@@ -61,6 +75,7 @@ void msf_init(void) {
     memset(&temp_neighbor, 0, sizeof(temp_neighbor));
     temp_neighbor.type = ADDR_ANYCAST;
     schedule_addActiveSlot(
+            SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE,                // slotframe handle
             msf_hashFunction_getSlotoffset(idmanager_getMyID(ADDR_64B)),     // slot offset
             CELLTYPE_RX,                                                     // type of slot
             FALSE,                                                           // shared?
@@ -69,7 +84,12 @@ void msf_init(void) {
             &temp_neighbor                                                   // neighbor
     );
 
+#if MSF_SLOTFRAME_HANDLE != SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE
+    schedule_addSlotframe(MSF_SLOTFRAME_HANDLE, MSF_SLOTFRAME_LENGTH);
+#endif
+
     msf_vars.housekeepingTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_MSF);
+    opentimers_setTolerance(msf_vars.housekeepingTimerId, OPENTIMERS_TOLERANCE_MS, TIME_MS);
     msf_vars.housekeepingPeriod = HOUSEKEEPING_PERIOD;
     opentimers_scheduleIn(
             msf_vars.housekeepingTimerId,
@@ -102,7 +122,8 @@ void msf_updateCellsElapsed(open_addr_t *neighbor, cellType_t type) {
             return;
     }
 
-    // adapt to upward traffic
+    // adapt to upward traffic, unless the queue does
+#if !MSF_QUEUE_AWARE
     if (msf_vars.numCellsElapsed_tx == MAX_NUMCELLS) {
 
         LOG_VERBOSE(COMPONENT_MSF, ERR_TX_CELL_USAGE, msf_vars.numCellsUsed_tx, 0);
@@ -125,6 +146,7 @@ void msf_updateCellsElapsed(open_addr_t *neighbor, cellType_t type) {
         msf_vars.numCellsElapsed_tx = 0;
         msf_vars.numCellsUsed_tx = 0;
     }
+#endif
 
     // adapt to downward traffic when there are negotiated Tx cells in schedule
     if (schedule_getNumberOfNegotiatedCells(neighbor, CELLTYPE_TX) == 0) {
@@ -176,6 +198,79 @@ void msf_updateCellsUsed(open_addr_t *neighbor, cellType_t type) {
     }
 }
 
+// called by sixtop
+void msf_indicatePacketQueued(open_addr_t *neighbor) {
+
+#if MSF_QUEUE_AWARE || MSF_DOWNSTREAM_AWARE
+    if (neighbor->type != ADDR_64B) {
+        return;
+    }
+
+    if (icmpv6rpl_isPreferredParent(neighbor)) {
+#if MSF_QUEUE_AWARE
+        if (msf_vars.numPacketsQueued < 0xffff) {
+            msf_vars.numPacketsQueued++;
+        }
+
+        // check the backlog once the packets being queued are
+        if (msf_vars.isQueueCheckPending == FALSE) {
+            msf_vars.isQueueCheckPending = TRUE;
+            scheduler_push_task(msf_adaptToQueue, TASKPRIO_MSF);
+        }
+#endif
+    } else {
+#if MSF_DOWNSTREAM_AWARE
+        // the neighbor may be a child, check the backlogs to the children once the packets being queued are
+        if (msf_vars.isChildQueueCheckPending == FALSE) {
+            msf_vars.isChildQueueCheckPending = TRUE;
+            scheduler_push_task(msf_adaptToChildQueues, TASKPRIO_MSF);
+        }
+#endif
+    }
+#endif
+}
+
+/**
+\brief Indicate this mote granted negotiated cells to a neighbor which requested them.
+
+A neighbor which is granted Rx cells, i.e. which requested Tx cells to this
+mote, while not being its parent, is a child. The Rx cells this mote requests
+from its parent do not make that parent a child.
+
+\param[in] neighbor    The neighbor which sent the 6P request.
+\param[in] cellOptions The options of the cells granted, seen from this mote.
+*/
+void msf_indicateCellsGranted(open_addr_t *neighbor, uint8_t cellOptions) {
+#if MSF_DOWNSTREAM_AWARE
+    uint8_t i;
+    uint8_t freeIndex;
+
+    if (
+            cellOptions != CELLOPTIONS_RX ||
+            neighbor->type != ADDR_64B ||
+            icmpv6rpl_isPreferredParent(neighbor)
+            ) {
+        return;
+    }
+
+    freeIndex = MSF_MAX_CHILDREN;
+    for (i = 0; i < MSF_MAX_CHILDREN; i++) {
+        if (msf_vars.children[i].type == ADDR_NONE) {
+            if (freeIndex == MSF_MAX_CHILDREN) {
+                freeIndex = i;
+            }
+        } else if (packetfunctions_sameAddress(neighbor, &msf_vars.children[i])) {
+            return;
+        }
+    }
+
+    // with no room left, the child gets no dedicated Tx cells
+    if (freeIndex < MSF_MAX_CHILDREN) {
+        memcpy(&msf_vars.children[freeIndex], neighbor, sizeof(open_addr_t));
+    }
+#endif
+}
+
 //=========================== callback =========================================
 
 uint8_t msf_getsfid(void) {
@@ -183,7 +278,7 @@ uint8_t msf_getsfid(void) {
 }
 
 uint16_t msf_getMetadata(void) {
-    return SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE;
+    return MSF_SLOTFRAME_HANDLE;
 }
 
 metadata_t msf_translateMetadata(void) {
@@ -392,8 +487,12 @@ bool msf_candidateAddCellList(
     memset(cellList, 0, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
     numCandCells = 0;
     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-        slotoffset = openrandom_get16b() % schedule_getFrameLength();
-        if (schedule_isSlotOffsetAvailable(slotoffset) == TRUE) {
+        slotoffset = openrandom_get16b() % schedule_getSlotframeLength(MSF_SLOTFRAME_HANDLE);
+        // skip the cells offered in the ongoing requests to other neighbors
+        if (
+                schedule_isSlotOffsetAvailable(MSF_SLOTFRAME_HANDLE, slotoffset) == TRUE &&
+                sixtop_isCellPending(slotoffset) == FALSE
+                ) {
             cellList[numCandCells].slotoffset = slotoffset;
             cellList[numCandCells].channeloffset = openrandom_get16b() & 0x0F;
             cellList[numCandCells].isUsed = TRUE;
@@ -420,8 +519,8 @@ bool msf_candidateRemoveCellList(
 
     memset(cellList, 0, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
     numCandCells = 0;
-    for (i = 0; i < schedule_getFrameLength(); i++) {
-        schedule_getSlotInfo(i, &info);
+    for (i = 0; i < schedule_getSlotframeLength(MSF_SLOTFRAME_HANDLE); i++) {
+        schedule_getSlotInfo(MSF_SLOTFRAME_HANDLE, i, &info);
         if (
                 packetfunctions_sameAddress(neighbor, &(info.address)) &&
                 info.link_type == cellOptions &&
@@ -456,6 +555,16 @@ void msf_housekeeping(void) {
         return;
     }
 
+    if (msf_getHashCollisionFlag()) {
+        // report it once, the cells stay where the hash places them
+        LOG_WARNING(COMPONENT_MSF, ERR_AUTONOMOUS_CELL_COLLISION, (errorparameter_t) MSF_HASH_SALT, (errorparameter_t) 0);
+        msf_setHashCollisionFlag(FALSE);
+    }
+
+#if MSF_QUEUE_AWARE
+    msf_updateQueueRate();
+#endif
+
     foundNeighbor = icmpv6rpl_getPreferredParentEui64(&parentNeighbor);
     if (foundNeighbor == FALSE) {
         return;
@@ -489,6 +598,14 @@ void msf_housekeeping(void) {
         return;
     }
 
+#if MSF_QUEUE_AWARE
+    // release the cells of a cleared backlog
+    msf_adaptToQueue();
+#endif
+#if MSF_DOWNSTREAM_AWARE
+    msf_releaseChildCells();
+#endif
+
     if (schedule_isNumTxWrapped(&parentNeighbor) == FALSE) {
         return;
     }
@@ -513,25 +630,311 @@ void msf_housekeeping(void) {
     }
 }
 
-uint16_t msf_hashFunction_getSlotoffset(open_addr_t *address) {
+#if MSF_QUEUE_AWARE
+/**
+\brief Size the Tx cells to the preferred parent after the packets queued to it.
 
-    uint16_t moteId;
+The cells needed send the backlog in MSF_QUEUE_DRAIN_SLOTFRAMES slotframes,
+and the packets arriving during a slotframe. The missing cells are added while
+there is a backlog, the extra ones are deleted once it is cleared, up to
+CELLLIST_MAX_LEN cells at a time.
+*/
+void msf_adaptToQueue(void) {
+    open_addr_t neighbor;
+    cellInfo_ht celllist[CELLLIST_MAX_LEN];
+    uint8_t backlog;
+    uint8_t numCells;
+    uint16_t numCellsNeeded;
+    uint8_t numCandCells;
 
-    moteId = (((uint16_t)(address->addr_64b[6])) << 8) + (uint16_t)(address->addr_64b[7]);
+    msf_vars.isQueueCheckPending = FALSE;
+
+    if (ieee154e_isSynch() == FALSE) {
+        return;
+    }
+
+    if (msf_vars.waitretry) {
+        return;
+    }
+
+    // get preferred parent
+    if (icmpv6rpl_getPreferredParentEui64(&neighbor) == FALSE) {
+        return;
+    }
+
+    backlog = openqueue_getNumPacketsTo(&neighbor);
+    numCellsNeeded = (backlog + MSF_QUEUE_DRAIN_SLOTFRAMES - 1) / MSF_QUEUE_DRAIN_SLOTFRAMES;
+    numCellsNeeded += (msf_vars.queueRate + 15) / 16;
+    if (numCellsNeeded == 0) {
+        // at least one negotiated Tx cell presents
+        numCellsNeeded = 1;
+    }
+    if (numCellsNeeded > MSF_QUEUE_MAX_CELLS) {
+        numCellsNeeded = MSF_QUEUE_MAX_CELLS;
+    }
+    numCells = schedule_getNumberOfNegotiatedCells(&neighbor, CELLTYPE_TX);
+
+    if (backlog > 0 && numCells < numCellsNeeded) {
+        if (msf_candidateAddCellList(celllist, 1) == FALSE) {
+            // failed to get cell list to add
+            return;
+        }
+        numCandCells = msf_getCellListLength(celllist);
+        numCells = numCellsNeeded - numCells;
+        if (numCells > numCandCells) {
+            numCells = numCandCells;
+        }
+
+        sixtop_request(
+                IANA_6TOP_CMD_ADD,           // code
+                &neighbor,                   // neighbor
+                numCells,                    // number cells
+                CELLOPTIONS_TX,              // cellOptions
+                celllist,                    // celllist to add
+                NULL,                        // celllist to delete (not used)
+                IANA_6TISCH_SFID_MSF,        // sfid
+                0,                           // list command offset (not used)
+                0                            // list command maximum celllist (not used)
+        );
+    } else if (backlog == 0 && numCells > numCellsNeeded) {
+        if (msf_candidateRemoveCellList(celllist, &neighbor, 1, CELLOPTIONS_TX) == FALSE) {
+            // failed to get cell list to delete
+            return;
+        }
+        numCandCells = msf_getCellListLength(celllist);
+        numCells = numCells - numCellsNeeded;
+        if (numCells > numCandCells) {
+            numCells = numCandCells;
+        }
+
+        sixtop_request(
+                IANA_6TOP_CMD_DELETE,        // code
+                &neighbor,                   // neighbor
+                numCells,                    // number cells
+                CELLOPTIONS_TX,              // cellOptions
+                NULL,                        // celllist to add (not used)
+                celllist,                    // celllist to delete
+                IANA_6TISCH_SFID_MSF,        // sfid
+                0,                           // list command offset (not used)
+                0                            // list command maximum celllist (not used)
+        );
+    }
+}
+
+/**
+\brief Average the packets queued to the preferred parent per slotframe.
+
+Called every housekeeping, HOUSEKEEPING_PERIOD ms on average.
+*/
+void msf_updateQueueRate(void) {
+    uint32_t rate;
+
+    rate = (uint32_t) msf_vars.numPacketsQueued * 16 * schedule_getSlotframeLength(MSF_SLOTFRAME_HANDLE) * SLOTDURATION;
+    rate /= HOUSEKEEPING_PERIOD;
+    rate = (msf_vars.queueRate + rate) / 2;
+    if (rate > 0xffff) {
+        rate = 0xffff;
+    }
+    msf_vars.queueRate = (uint16_t) rate;
+    msf_vars.numPacketsQueued = 0;
+}
+#endif
+
+#if MSF_DOWNSTREAM_AWARE
+/**
+\brief Add Tx cells to the children which have a backlog.
+
+The cells needed send the backlog to a child in MSF_QUEUE_DRAIN_SLOTFRAMES
+slotframes, up to CELLLIST_MAX_LEN cells at a time. The requests to several
+children run in parallel, in as many 6P transactions.
+*/
+void msf_adaptToChildQueues(void) {
+    open_addr_t neighbor;
+    cellInfo_ht celllist[CELLLIST_MAX_LEN];
+    uint8_t backlog;
+    uint8_t numCells;
+    uint8_t numCellsNeeded;
+    uint8_t i;
+
+    msf_vars.isChildQueueCheckPending = FALSE;
+
+    if (ieee154e_isSynch() == FALSE) {
+        return;
+    }
+
+    if (msf_vars.waitretry) {
+        return;
+    }
+
+    for (i = 0; i < MSF_MAX_CHILDREN; i++) {
+        if (msf_vars.children[i].type == ADDR_NONE || icmpv6rpl_isPreferredParent(&msf_vars.children[i])) {
+            continue;
+        }
+        memcpy(&neighbor, &msf_vars.children[i], sizeof(open_addr_t));
+
+        backlog = openqueue_getNumPacketsTo(&neighbor);
+        numCellsNeeded = (backlog + MSF_QUEUE_DRAIN_SLOTFRAMES - 1) / MSF_QUEUE_DRAIN_SLOTFRAMES;
+        if (numCellsNeeded > MSF_DOWNSTREAM_MAX_CELLS) {
+            numCellsNeeded = MSF_DOWNSTREAM_MAX_CELLS;
+        }
+        numCells = schedule_getNumberOfNegotiatedCells(&neighbor, CELLTYPE_TX);
+        if (numCells >= numCellsNeeded) {
+            continue;
+        }
+
+        if (msf_candidateAddCellList(celllist, 1) == FALSE) {
+            // failed to get cell list to add
+            continue;
+        }
+        numCells = numCellsNeeded - numCells;
+        if (numCells > msf_getCellListLength(celllist)) {
+            numCells = msf_getCellListLength(celllist);
+        }
+
+        sixtop_request(
+                IANA_6TOP_CMD_ADD,           // code
+                &neighbor,                   // neighbor
+                numCells,                    // number cells
+                CELLOPTIONS_TX,              // cellOptions
+                celllist,                    // celllist to add
+                NULL,                        // celllist to delete (not used)
+                IANA_6TISCH_SFID_MSF,        // sfid
+                0,                           // list command offset (not used)
+                0                            // list command maximum celllist (not used)
+        );
+    }
+}
+
+/**
+\brief Delete the Tx cells to the children whose backlog is cleared.
+*/
+void msf_releaseChildCells(void) {
+    open_addr_t neighbor;
+    cellInfo_ht celllist[CELLLIST_MAX_LEN];
+    uint8_t numCells;
+    uint8_t i;
+
+    msf_forgetChildren();
+
+    for (i = 0; i < MSF_MAX_CHILDREN; i++) {
+        if (
+                msf_vars.children[i].type == ADDR_NONE ||
+                icmpv6rpl_isPreferredParent(&msf_vars.children[i]) ||
+                openqueue_getNumPacketsTo(&msf_vars.children[i]) > 0
+                ) {
+            continue;
+        }
+        memcpy(&neighbor, &msf_vars.children[i], sizeof(open_addr_t));
+
+        if (msf_candidateRemoveCellList(celllist, &neighbor, 1, CELLOPTIONS_TX) == FALSE) {
+            // no Tx cell to this child
+            continue;
+        }
+        numCells = msf_getCellListLength(celllist);
+
+        sixtop_request(
+                IANA_6TOP_CMD_DELETE,        // code
+                &neighbor,                   // neighbor
+                numCells,                    // number cells
+                CELLOPTIONS_TX,              // cellOptions
+                NULL,                        // celllist to add (not used)
+                celllist,                    // celllist to delete
+                IANA_6TISCH_SFID_MSF,        // sfid
+                0,                           // list command offset (not used)
+                0                            // list command maximum celllist (not used)
+        );
+    }
+}
+
+/**
+\brief Forget the children which released all the cells they negotiated.
+*/
+void msf_forgetChildren(void) {
+    uint8_t i;
+
+    for (i = 0; i < MSF_MAX_CHILDREN; i++) {
+        if (
+                msf_vars.children[i].type != ADDR_NONE &&
+                schedule_getNumberOfNegotiatedCells(&msf_vars.children[i], CELLTYPE_RX) == 0
+                ) {
+            memset(&msf_vars.children[i], 0, sizeof(open_addr_t));
+        }
+    }
+}
+
+/**
+\brief Tell whether a neighbor is a child, i.e. requested Tx cells to this mote.
+*/
+bool msf_isChild(open_addr_t *neighbor) {
+    uint8_t i;
+
+    if (icmpv6rpl_isPreferredParent(neighbor)) {
+        return FALSE;
+    }
+
+    for (i = 0; i < MSF_MAX_CHILDREN; i++) {
+        if (packetfunctions_sameAddress(neighbor, &msf_vars.children[i])) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+#endif
+
+#if MSF_QUEUE_AWARE || MSF_DOWNSTREAM_AWARE
+uint8_t msf_getCellListLength(cellInfo_ht *cellList) {
+    uint8_t i;
+    uint8_t numCells;
+
+    numCells = 0;
+    for (i = 0; i < CELLLIST_MAX_LEN; i++) {
+        if (cellList[i].isUsed) {
+            numCells++;
+        }
+    }
+    return numCells;
+}
+#endif
+
+uint16_t msf_hashFunction_getSlotoffset(open_addr_t *address) {
 
     return SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS + \
-            (moteId % (SLOTFRAME_LENGTH - SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS));
+            (msf_hashFunction_sax(address) % (SLOTFRAME_LENGTH - SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS));
 }
 
 uint8_t msf_hashFunction_getChanneloffset(open_addr_t *address) {
 
-    uint16_t moteId;
+    // the slot offset takes the low digit of the hash, the channel offset the next one
+    return (msf_hashFunction_sax(address) / (SLOTFRAME_LENGTH - SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS)) % NUM_CHANNELS;
+}
+
+/**
+\brief Shift-Add-XOR hash of the whole EUI64, starting from the hash salt.
 
-    moteId = (((uint16_t)(address->addr_64b[6])) << 8) + (uint16_t)(address->addr_64b[7]);
+Unlike the last bytes of the EUI64, it spreads motes with sequential
+addresses from several batches over the slotframe. The SAX of addresses which
+only differ in their last byte are close, so its bits get mixed in the end.
+*/
+uint16_t msf_hashFunction_sax(open_addr_t *address) {
+    uint8_t i;
+    uint16_t hash;
 
-    return moteId % NUM_CHANNELS;
+    hash = MSF_HASH_SALT;
+    for (i = 0; i < LENGTH_ADDR64b; i++) {
+        hash ^= (hash << SAX_LEFT_SHIFT) + (hash >> SAX_RIGHT_SHIFT) + address->addr_64b[i];
+    }
+    hash *= SAX_MIX_MULTIPLIER;
+    hash ^= hash >> 7;
+    return hash;
 }
 
+/**
+\brief Called by schedule when two autonomous cells hash to the same slot.
+
+MSF reports it at the next housekeeping. The autonomous cells of a neighbor
+are placed from its EUI64 alone, so they can not move without the neighbor
+knowing: rehashing means building all the motes with another MSF_HASH_SALT.
+*/
 void msf_setHashCollisionFlag(bool isCollision) {
     msf_vars.f_hashCollision = isCollision;
 }
@@ -35,6 +35,23 @@
 #define LIM_NUMCELLSUSED_LOW           MSF_LIM_NUMCELLSUSED_LOW
 #endif
 
+// negotiated cells go to a slotframe of their own when one is configured
+#if SCHEDULE_NUM_SLOTFRAMES > 1 && MSF_SLOTFRAME_LENGTH > 0
+#define MSF_SLOTFRAME_HANDLE           1
+#else
+#define MSF_SLOTFRAME_HANDLE           SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE
+#endif
+
+// autonomous cells, hashed from the whole EUI64 with Shift-Add-XOR and a final
+// multiplicative mix. This is not the RFC9033 hash: motes running another MSF
+// implementation place their autonomous cells elsewhere.
+#define SAX_LEFT_SHIFT                   5
+#define SAX_RIGHT_SHIFT                  2
+#define SAX_MIX_MULTIPLIER          0x9e37 // odd, about 2^16 divided by the golden ratio
+#ifndef MSF_HASH_SALT
+#define MSF_HASH_SALT                    0 // initial value of the hash, the same on all motes; change it to rehash
+#endif
+
 #define HOUSEKEEPING_PERIOD          30000 // miliseconds
 #define QUARANTINE_DURATION            300 // seconds
 #define WAITDURATION_MIN             30000 // miliseconds
@@ -60,6 +77,15 @@ typedef struct {
     // for msf status report
     uint8_t previousNumCellsUsed_tx;
     uint8_t previousNumCellsUsed_rx;
+#if MSF_QUEUE_AWARE
+    uint16_t numPacketsQueued;                      // packets queued to the parent since the last housekeeping
+    uint16_t queueRate;                             // packets queued to the parent per slotframe, in 1/16th
+    bool isQueueCheckPending;                       // TRUE iff msf_adaptToQueue is posted already
+#endif
+#if MSF_DOWNSTREAM_AWARE
+    bool isChildQueueCheckPending;                  // TRUE iff msf_adaptToChildQueues is posted already
+    open_addr_t children[MSF_MAX_CHILDREN];         // neighbors which requested Tx cells to this mote, ADDR_NONE if unused
+#endif
 } msf_vars_t;
 
 typedef struct {
@@ -93,6 +119,16 @@ void msf_updateCellsElapsed(open_addr_t *neighbor, cellType_t cellType);
 
 void msf_updateCellsUsed(open_addr_t *neighbor, cellType_t cellType);
 
+// called by sixtop
+void msf_indicatePacketQueued(open_addr_t *neighbor);
+
+void msf_indicateCellsGranted(open_addr_t *neighbor, uint8_t cellOptions);
+
+#if MSF_DOWNSTREAM_AWARE
+// called by schedule
+bool msf_isChild(open_addr_t *neighbor);
+#endif
+
 uint16_t msf_hashFunction_getSlotoffset(open_addr_t *address);
 
 uint8_t msf_hashFunction_getChanneloffset(open_addr_t *address);
@@ -29,6 +29,10 @@ void removeNeighbor(uint8_t neighborIndex);
 
 bool isThisRowMatching(open_addr_t *address, uint8_t rowNumber);
 
+uint16_t getInitialEtx(uint8_t index);
+
+uint16_t getRssiEtx(int8_t rssi);
+
 //=========================== public ==========================================
 
 /**
@@ -255,10 +259,22 @@ bool neighbors_isNeighborWithHigherDAGrank(uint8_t index) {
     return returnVal;
 }
 
+/**
+\brief Whether enough packets were sent to a neighbor for its link metric to be used.
+
+A link which stopped acknowledging qualifies at once, so that a dead parent is
+dropped without waiting for MINIMAL_NUM_TX transmissions.
+*/
 bool neighbors_reachedMinimalTransmission(uint8_t index) {
     bool returnVal;
 
-    if (neighbors_vars.neighbors[index].used == TRUE && neighbors_vars.neighbors[index].numTx > MINIMAL_NUM_TX) {
+    if (
+            neighbors_vars.neighbors[index].used == TRUE &&
+            (
+                    neighbors_vars.neighbors[index].numTx > MINIMAL_NUM_TX ||
+                    neighbors_vars.linkEstimates[index].numNoAck >= ETX_MAX_NOACK
+            )
+            ) {
         returnVal = TRUE;
     } else {
         returnVal = FALSE;
@@ -281,6 +297,7 @@ The fields which are updated are:
 - asn
 - stableNeighbor
 - switchStabilityCounter
+- the ETX estimate of the link, raised when the neighbor is heard weakly
 
 \param[in] l2_src MAC source address of the packet, i.e. the neighbor who sent
    the packet just received.
@@ -289,8 +306,10 @@ The fields which are updated are:
 \param[in] joinPrioPresent Whether a join priority was present in the received
    packet.
 \param[in] joinPrio The join priority present in the packet, if any.
+
+\returns TRUE iff the packet was sent by a neighbor just added to the table.
 */
-void neighbors_indicateRx(open_addr_t *l2_src,
+bool neighbors_indicateRx(open_addr_t *l2_src,
                           int8_t rssi,
                           asn_t *asnTs,
                           bool joinPrioPresent,
@@ -298,6 +317,8 @@ void neighbors_indicateRx(open_addr_t *l2_src,
                           bool insecure) {
     uint8_t i;
     bool newNeighbor;
+    uint16_t rssiEtx;
+    neighborLinkEstimate_t *estimate;
 
     // update existing neighbor
     newNeighbor = TRUE;
@@ -314,6 +335,16 @@ void neighbors_indicateRx(open_addr_t *l2_src,
             neighbors_vars.neighbors[i].numRx++;
             neighbors_vars.neighbors[i].rssi = rssi;
             memcpy(&neighbors_vars.neighbors[i].asn, asnTs, sizeof(asn_t));
+
+            // a weak signal predicts losses on the link, a strong one does not rule them out
+            estimate = &neighbors_vars.linkEstimates[i];
+            rssiEtx = getRssiEtx(rssi);
+            if (estimate->numSamples > 0 && rssiEtx > estimate->etx) {
+                estimate->etx = (uint16_t)(
+                        ((uint32_t) estimate->etx * ETX_RSSI_ALPHA + (uint32_t) rssiEtx * (100 - ETX_RSSI_ALPHA)) / 100
+                );
+            }
+
             //update jp
             if (joinPrioPresent == TRUE) {
                 neighbors_vars.neighbors[i].joinPrio = joinPrio;
@@ -342,6 +373,9 @@ void neighbors_indicateRx(open_addr_t *l2_src,
                 }
             }
 
+            // stability and rssi may change my rank through this neighbor
+            icmpv6rpl_updateCandidateParent(i);
+
             // stop looping
             break;
         }
@@ -350,7 +384,10 @@ void neighbors_indicateRx(open_addr_t *l2_src,
     // register new neighbor
     if (newNeighbor == TRUE) {
         registerNewNeighbor(l2_src, rssi, asnTs, joinPrioPresent, joinPrio, insecure);
+        return isNeighbor(l2_src);
     }
+
+    return FALSE;
 }
 
 /**
@@ -363,6 +400,7 @@ The fields which are updated are:
 - numTx
 - numTxACK
 - asn
+- the ETX estimate of the link
 
 \param[in] l2_dest MAC destination address of the packet, i.e. the neighbor
    who I just sent the packet to.
@@ -379,6 +417,10 @@ void neighbors_indicateTx(
         asn_t *asnTs
 ) {
     uint8_t i;
+    uint8_t alpha;
+    uint16_t sample;
+    neighborLinkEstimate_t *estimate;
+
     // don't run through this function if packet was sent to broadcast address
     if (packetfunctions_isBroadcastMulticast(l2_dest) == TRUE) {
         return;
@@ -412,8 +454,32 @@ void neighbors_indicateTx(
                     neighbors_vars.neighbors[i].numTxACK++;
                 }
 
+                // update the ETX estimate, quickly while the link is fresh
+                estimate = &neighbors_vars.linkEstimates[i];
+                if (was_finally_acked == TRUE) {
+                    sample = numTxAttempts * ETX_DIVISOR;
+                    estimate->numNoAck = 0;
+                } else {
+                    sample = ETX_NOACK_PENALTY * ETX_DIVISOR;
+                    if (estimate->numNoAck < ETX_MAX_NOACK) {
+                        estimate->numNoAck++;
+                    }
+                }
+                if (estimate->numSamples == 0) {
+                    estimate->etx = getInitialEtx(i);
+                }
+                if (estimate->numSamples < ETX_FRESH_SAMPLES) {
+                    alpha = ETX_FRESH_ALPHA;
+                    estimate->numSamples++;
+                } else {
+                    alpha = ETX_ALPHA;
+                }
+                estimate->etx = (uint16_t)(
+                        ((uint32_t) estimate->etx * alpha + (uint32_t) sample * (100 - alpha)) / 100
+                );
+
                 // numTx and numTxAck changed,, update my rank
-                icmpv6rpl_updateMyDAGrankAndParentSelection();
+                icmpv6rpl_indicateNeighborUpdate(i);
             }
             break;
         }
@@ -450,6 +516,24 @@ void neighbors_resetSequenceNumber(open_addr_t *address) {
 \brief Write the 64-bit address of some neighbor to some location.
 // Returns false if neighbor not in use or address type is not 64bits
 */
+/**
+\brief Find the row of the neighbor table a neighbor is in.
+
+\param[in] address The EUI64 address of the neighbor.
+
+\returns The row, MAXNUMNEIGHBORS if the neighbor has none.
+*/
+uint8_t neighbors_getNeighborIndex(open_addr_t *address) {
+    uint8_t i;
+
+    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
+        if (isThisRowMatching(address, i)) {
+            break;
+        }
+    }
+    return i;
+}
+
 bool neighbors_getNeighborEui64(open_addr_t *address, uint8_t addr_type, uint8_t index) {
     bool ReturnVal = FALSE;
     switch (addr_type) {
@@ -545,7 +629,7 @@ void neighbors_setNeighborNoResource(open_addr_t *address) {
     for (i = 0; i < MAXNUMNEIGHBORS; i++) {
         if (isThisRowMatching(address, i)) {
             neighbors_vars.neighbors[i].f6PNORES = TRUE;
-            icmpv6rpl_updateMyDAGrankAndParentSelection();
+            icmpv6rpl_indicateNeighborUpdate(i);
             break;
         }
     }
@@ -565,37 +649,27 @@ This really belongs to icmpv6rpl but it would require a much more complex interf
 */
 
 uint16_t neighbors_getLinkMetric(uint8_t index) {
-    uint16_t rankIncrease;
-    uint32_t rankIncreaseIntermediary; // stores intermediary results of rankIncrease calculation
+    uint16_t etx;
+    uint32_t rankIncrease;
 
     // we assume that this neighbor has already been checked for being in use
-    // calculate link cost to this neighbor
-    if (neighbors_vars.neighbors[index].numTxACK == 0) {
-        if (neighbors_vars.neighbors[index].numTx > DEFAULTLINKCOST) {
-            if (neighbors_vars.neighbors[index].numTx < MINIMAL_NUM_TX) {
-                rankIncrease = (3 * neighbors_vars.neighbors[index].numTx - 2) * MINHOPRANKINCREASE;
-            } else {
-                rankIncrease = 65535;
-            }
-        } else {
-            rankIncrease = (3 * DEFAULTLINKCOST - 2) * MINHOPRANKINCREASE;
-        }
+    if (neighbors_vars.linkEstimates[index].numNoAck >= ETX_MAX_NOACK) {
+        // the EWMA saturates at ETX_NOACK_PENALTY, a link which stopped acknowledging is unusable
+        return 65535;
+    }
+
+    if (neighbors_vars.linkEstimates[index].numSamples == 0) {
+        etx = getInitialEtx(index);
     } else {
-        //6TiSCH minimal draft using OF0 for rank computation: ((3*numTx/numTxAck)-2)*minHopRankIncrease
-        // numTx is on 8 bits, so scaling up 10 bits won't lead to saturation
-        // but this <<10 followed by >>10 does not provide any benefit either. Result is the same.
-        rankIncreaseIntermediary = (((uint32_t) neighbors_vars.neighbors[index].numTx) << 10);
-        rankIncreaseIntermediary = (3 * rankIncreaseIntermediary * MINHOPRANKINCREASE) /
-                                   ((uint32_t) neighbors_vars.neighbors[index].numTxACK);
-        rankIncreaseIntermediary = rankIncreaseIntermediary - ((uint32_t)(2 * MINHOPRANKINCREASE) << 10);
-        // this could still overflow for numTx large and numTxAck small, Casting to 16 bits will yiel the least significant bits
-        if (rankIncreaseIntermediary >= (65536 << 10)) {
-            rankIncrease = 65535;
-        } else {
-            rankIncrease = (uint16_t)(rankIncreaseIntermediary >> 10);
-        }
+        etx = neighbors_vars.linkEstimates[index].etx;
     }
-    return rankIncrease;
+
+    //6TiSCH minimal draft using OF0 for rank computation: ((3*ETX)-2)*minHopRankIncrease
+    rankIncrease = ((3 * (uint32_t) etx - 2 * ETX_DIVISOR) * MINHOPRANKINCREASE) / ETX_DIVISOR;
+    if (rankIncrease > 65535) {
+        rankIncrease = 65535;
+    }
+    return (uint16_t) rankIncrease;
 }
 
 //===== maintenance
@@ -695,6 +769,8 @@ void registerNewNeighbor(open_addr_t *address,
                 neighbors_vars.neighbors[i].numRx = 1;
                 neighbors_vars.neighbors[i].numTx = 0;
                 neighbors_vars.neighbors[i].numTxACK = 0;
+                neighbors_vars.linkEstimates[i].numSamples = 0;
+                neighbors_vars.linkEstimates[i].numNoAck = 0;
                 memcpy(&neighbors_vars.neighbors[i].asn, asnTimestamp, sizeof(asn_t));
                 neighbors_vars.neighbors[i].backoffExponenton = MINBE - 1;;
                 neighbors_vars.neighbors[i].backoff = 0;
@@ -704,6 +780,8 @@ void registerNewNeighbor(open_addr_t *address,
                 } else {
                     neighbors_vars.neighbors[i].joinPrio = DEFAULTJOINPRIORITY;
                 }
+                // packets already queued to it join the TX list of this row
+                openqueue_indicateNeighborAdded(i);
                 break;
             }
             i++;
@@ -729,6 +807,9 @@ bool isNeighbor(open_addr_t *neighbor) {
 
 void removeNeighbor(uint8_t neighborIndex) {
 
+    // its packets leave the TX list of this row, which may be reused
+    openqueue_indicateNeighborRemoved(neighborIndex);
+
     neighbors_vars.neighbors[neighborIndex].used = FALSE;
     neighbors_vars.neighbors[neighborIndex].parentPreference = 0;
     neighbors_vars.neighbors[neighborIndex].stableNeighbor = FALSE;
@@ -738,6 +819,8 @@ void removeNeighbor(uint8_t neighborIndex) {
     neighbors_vars.neighbors[neighborIndex].numRx = 0;
     neighbors_vars.neighbors[neighborIndex].numTx = 0;
     neighbors_vars.neighbors[neighborIndex].numTxACK = 0;
+    neighbors_vars.linkEstimates[neighborIndex].numSamples = 0;
+    neighbors_vars.linkEstimates[neighborIndex].numNoAck = 0;
     neighbors_vars.neighbors[neighborIndex].asn.bytes0and1 = 0;
     neighbors_vars.neighbors[neighborIndex].asn.bytes2and3 = 0;
     neighbors_vars.neighbors[neighborIndex].asn.byte4 = 0;
@@ -746,6 +829,9 @@ void removeNeighbor(uint8_t neighborIndex) {
     neighbors_vars.neighbors[neighborIndex].backoffExponenton = MINBE - 1;
     neighbors_vars.neighbors[neighborIndex].backoff = 0;
     neighbors_vars.neighbors[neighborIndex].addr_64b.type = ADDR_NONE;
+
+    // it is no longer a candidate parent
+    icmpv6rpl_updateCandidateParent(neighborIndex);
 }
 
 //=========================== helpers =========================================
@@ -762,3 +848,32 @@ bool isThisRowMatching(open_addr_t *address, uint8_t rowNumber) {
             return FALSE;
     }
 }
+
+/**
+\brief ETX of a link no packet was sent over yet, guessed from how well it is heard.
+*/
+uint16_t getInitialEtx(uint8_t index) {
+    if (neighbors_vars.neighbors[index].rssi > BADNEIGHBORMAXRSSI) {
+        return ETX_STRONG_RSSI * ETX_DIVISOR;
+    } else {
+        return DEFAULTLINKCOST * ETX_DIVISOR;
+    }
+}
+
+/**
+\brief lowest ETX expected of a link heard with the given RSSI.
+
+1 above BADNEIGHBORMAXRSSI, DEFAULTLINKCOST below GOODNEIGHBORMINRSSI, linear in between.
+*/
+uint16_t getRssiEtx(int8_t rssi) {
+    if (rssi >= BADNEIGHBORMAXRSSI) {
+        return ETX_DIVISOR;
+    }
+    if (rssi <= GOODNEIGHBORMINRSSI) {
+        return DEFAULTLINKCOST * ETX_DIVISOR;
+    }
+    return ETX_DIVISOR + (uint16_t)(
+            ((BADNEIGHBORMAXRSSI - rssi) * (DEFAULTLINKCOST - 1) * ETX_DIVISOR) /
+            (BADNEIGHBORMAXRSSI - GOODNEIGHBORMINRSSI)
+    );
+}
@@ -27,6 +27,24 @@
 #endif
 #define MINIMAL_NUM_TX            16
 
+// link estimator: EWMA of the number of transmissions per packet (ETX), in 1/ETX_DIVISOR
+#define ETX_DIVISOR               128
+#ifndef ETX_ALPHA
+#define ETX_ALPHA                 80   // weight of the estimate against a new sample, in percent
+#endif
+#ifndef ETX_FRESH_ALPHA
+#define ETX_FRESH_ALPHA           50   // same, for the first ETX_FRESH_SAMPLES samples of a link
+#endif
+#define ETX_FRESH_SAMPLES         4    // first samples of a link, weighted with ETX_FRESH_ALPHA
+#define ETX_NOACK_PENALTY         12   // sample for a packet which was never acknowledged
+#ifndef ETX_MAX_NOACK
+#define ETX_MAX_NOACK             4    // consecutive packets never acknowledged before the link cost is infinite
+#endif
+#define ETX_STRONG_RSSI           2    // initial estimate of a link heard above BADNEIGHBORMAXRSSI
+#ifndef ETX_RSSI_ALPHA
+#define ETX_RSSI_ALPHA            95   // weight of the estimate against the ETX a received packet's RSSI implies, in percent
+#endif
+
 #define MAXDAGRANK                0xffff
 #define DEFAULTDAGRANK            MAXDAGRANK
 #define MINHOPRANKINCREASE        256  // default value in RPL and Minimal 6TiSCH draft
@@ -53,10 +71,17 @@ typedef struct {
 } netDebugNeigborEntry_t;
 END_PACK
 
+typedef struct {
+    uint16_t etx;                 // in 1/ETX_DIVISOR, valid once numSamples > 0
+    uint8_t numSamples;           // packets sent, saturates at ETX_FRESH_SAMPLES
+    uint8_t numNoAck;             // consecutive packets never acknowledged, saturates at ETX_MAX_NOACK
+} neighborLinkEstimate_t;
+
 //=========================== module variables ================================
 
 typedef struct {
     neighborRow_t neighbors[MAXNUMNEIGHBORS];
+    neighborLinkEstimate_t linkEstimates[MAXNUMNEIGHBORS]; // kept apart, neighborRow_t is printed over serial
     dagrank_t myDAGrank;
     uint8_t debugRow;
 } neighbors_vars_t;
@@ -103,7 +128,7 @@ bool neighbors_isNeighborWithHigherDAGrank(uint8_t index);
 bool neighbors_reachedMinimalTransmission(uint8_t index);
 
 // updating neighbor information
-void neighbors_indicateRx(
+bool neighbors_indicateRx(
         open_addr_t *l2_src,
         int8_t rssi,
         asn_t *asnTimestamp,
@@ -125,6 +150,8 @@ void neighbors_updateSequenceNumber(open_addr_t *address);
 void neighbors_resetSequenceNumber(open_addr_t *address);
 
 // get addresses
+uint8_t neighbors_getNeighborIndex(open_addr_t *address);
+
 bool neighbors_getNeighborEui64(open_addr_t *address, uint8_t addr_type, uint8_t index);
 
 // update backoff field
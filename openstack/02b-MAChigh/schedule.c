@@ -22,6 +22,24 @@ void schedule_resetEntry(scheduleEntry_t *pScheduleEntry);
 
 void schedule_resetBackupEntry(backupEntry_t *pBackupEntry);
 
+static scheduleEntry_t* schedule_getEntry(uint8_t frameHandle, slotOffset_t slotOffset);
+
+static scheduleEntry_t* schedule_getPreviousEntry(uint8_t frameHandle, slotOffset_t slotOffset);
+
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+static void schedule_syncSlotframe(uint8_t frameHandle);
+#endif
+
+#if SCHEDULE_SLOT_INDEX
+static void schedule_indexSet(slotOffset_t slotOffset, scheduleEntry_t *entry);
+
+static void schedule_indexClear(slotOffset_t slotOffset);
+
+static slotOffset_t schedule_getNextUsedSlotOffset(slotOffset_t slotOffset);
+
+static slotOffset_t schedule_getPreviousUsedSlotOffset(slotOffset_t slotOffset);
+#endif
+
 //=========================== public ==========================================
 
 //=== admin
@@ -45,6 +63,9 @@ void schedule_init(void) {
     }
     schedule_vars.backoffExponenton = MINBE - 1;
     schedule_vars.maxActiveSlots = MAXACTIVESLOTS;
+#if SCHEDULE_SLOT_INDEX
+    memset(&schedule_vars.slotIndex[0], SCHEDULE_NO_ENTRY, sizeof(schedule_vars.slotIndex));
+#endif
 
     if (idmanager_getIsDAGroot() == TRUE) {
         schedule_startDAGroot();
@@ -61,7 +82,7 @@ void schedule_startDAGroot(void) {
 
     start_slotOffset = SCHEDULE_MINIMAL_6TISCH_SLOTOFFSET;
     // set frame length, handle and number (default 1 by now)
-    if (schedule_vars.frameLength == 0) {
+    if (schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE].frameLength == 0) {
         // slotframe length is not set, set it to default length
         schedule_setFrameLength(SLOTFRAME_LENGTH);
     } else {
@@ -76,6 +97,7 @@ void schedule_startDAGroot(void) {
     for (running_slotOffset = start_slotOffset;
          running_slotOffset < start_slotOffset + SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS; running_slotOffset++) {
         schedule_addActiveSlot(
+                SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE, // slotframe handle
                 running_slotOffset,                     // slot offset
                 CELLTYPE_TXRX,                          // type of slot
                 TRUE,                                   // shared?
@@ -153,7 +175,7 @@ void schedule_setFrameLength(frameLength_t newFrameLength) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    schedule_vars.frameLength = newFrameLength;
+    schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE].frameLength = newFrameLength;
     if (newFrameLength <= MAXACTIVESLOTS) {
         schedule_vars.maxActiveSlots = newFrameLength;
     }
@@ -190,31 +212,83 @@ void schedule_setFrameNumber(uint8_t frameNumber) {
     ENABLE_INTERRUPTS();
 }
 
+/**
+\brief Add a slotframe next to slotframe 0.
+
+The slot offsets of the new slotframe follow the ASN, as those of slotframe 0
+do. Its cells are added with schedule_addActiveSlot().
+
+\param frameHandle The handle of the new slotframe, 1 to SCHEDULE_NUM_SLOTFRAMES-1.
+\param frameLength The length of the new slotframe, in slots.
+*/
+owerror_t schedule_addSlotframe(uint8_t frameHandle, frameLength_t frameLength) {
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    if (
+            frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE ||
+            frameHandle >= SCHEDULE_NUM_SLOTFRAMES ||
+            frameLength == 0 ||
+            schedule_vars.slotframes[frameHandle].frameLength != 0
+            ) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_OVERFLOWN, (errorparameter_t) 2, (errorparameter_t) frameHandle);
+        return E_FAIL;
+    }
+
+    schedule_vars.slotframes[frameHandle].frameLength = frameLength;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    schedule_syncSlotframe(frameHandle);
+#endif
+
+    ENABLE_INTERRUPTS();
+    return E_SUCCESS;
+}
+
+/**
+\brief Get the length of a slotframe.
+
+\param frameHandle The handle of the slotframe.
+
+\returns The length of that slotframe, 0 if it is not in use.
+*/
+frameLength_t schedule_getSlotframeLength(uint8_t frameHandle) {
+    frameLength_t returnVal;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    returnVal = 0;
+    if (frameHandle < SCHEDULE_NUM_SLOTFRAMES) {
+        returnVal = schedule_vars.slotframes[frameHandle].frameLength;
+    }
+
+    ENABLE_INTERRUPTS();
+
+    return returnVal;
+}
+
 /**
 \brief Get the information of a specific slot.
 
+\param frameHandle The handle of the slotframe of the slot.
 \param slotOffset
 \param info
 */
-void schedule_getSlotInfo(slotOffset_t slotOffset, slotinfo_element_t *info) {
+void schedule_getSlotInfo(uint8_t frameHandle, slotOffset_t slotOffset, slotinfo_element_t *info) {
 
     scheduleEntry_t *slotContainer;
 
-    // find an empty schedule entry container
-    slotContainer = &schedule_vars.scheduleBuf[0];
-    while (slotContainer <= &schedule_vars.scheduleBuf[schedule_vars.maxActiveSlots - 1]) {
-        //check that this entry for that neighbour and timeslot is not already scheduled.
-        if (slotContainer->slotOffset == slotOffset) {
-            //it exists so this is an update.
-            info->link_type = slotContainer->type;
-            info->shared = slotContainer->shared;
-            info->slotOffset = slotOffset;
-            info->channelOffset = slotContainer->channelOffset;
-            info->isAutoCell = slotContainer->isAutoCell;
-            memcpy(&(info->address), &(slotContainer->neighbor), sizeof(open_addr_t));
-            return; //as this is an update. No need to re-insert as it is in the same position on the list.
-        }
-        slotContainer++;
+    slotContainer = schedule_getEntry(frameHandle, slotOffset);
+    if (slotContainer != NULL) {
+        info->link_type = slotContainer->type;
+        info->shared = slotContainer->shared;
+        info->slotOffset = slotOffset;
+        info->channelOffset = slotContainer->channelOffset;
+        info->isAutoCell = slotContainer->isAutoCell;
+        memcpy(&(info->address), &(slotContainer->neighbor), sizeof(open_addr_t));
+        return;
     }
     // return cell type off
     info->link_type = CELLTYPE_OFF;
@@ -224,9 +298,36 @@ void schedule_getSlotInfo(slotOffset_t slotOffset, slotinfo_element_t *info) {
     memset(&(info->address), 0, sizeof(open_addr_t));
 }
 
+/**
+\brief Get the information of the cell scheduled in the current slot.
+
+When several slotframes have a cell in the current slot, this is the one of the
+slotframe with the lowest handle.
+
+\param slotOffset       The slot offset of the current slot in slotframe 0.
+\param info
+*/
+void schedule_getCurrentSlotInfo(slotOffset_t slotOffset, slotinfo_element_t *info) {
+    uint8_t frameHandle;
+
+    frameHandle = SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    if (schedule_getEntry(frameHandle, slotOffset) == NULL) {
+        for (frameHandle = 1; frameHandle < SCHEDULE_NUM_SLOTFRAMES; frameHandle++) {
+            slotOffset = schedule_vars.slotframes[frameHandle].slotOffset;
+            if (schedule_getEntry(frameHandle, slotOffset) != NULL) {
+                break;
+            }
+        }
+    }
+#endif
+    schedule_getSlotInfo(frameHandle, slotOffset, info);
+}
+
 /**
 \brief Add a new active slot into the schedule.
 
+\param frameHandle      The handle of the slotframe of the new slot
 \param slotOffset       The slotoffset of the new slot
 \param type             The type of the cell
 \param shared           Whether this cell is shared (TRUE) or not (FALSE).
@@ -235,6 +336,7 @@ void schedule_getSlotInfo(slotOffset_t slotOffset, slotinfo_element_t *info) {
    none)
 */
 owerror_t schedule_addActiveSlot(
+        uint8_t frameHandle,
         slotOffset_t slotOffset,
         cellType_t type,
         bool shared,
@@ -243,6 +345,7 @@ owerror_t schedule_addActiveSlot(
         open_addr_t *neighbor
 ) {
     uint8_t asn[5];
+    scheduleSlotframe_t *slotframe;
     scheduleEntry_t *slotContainer;
     scheduleEntry_t *previousSlotWalker;
     scheduleEntry_t *nextSlotWalker;
@@ -258,33 +361,57 @@ owerror_t schedule_addActiveSlot(
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
+    // slotframe 0 may get cells before its length is known from an EB
+    if (
+            frameHandle >= SCHEDULE_NUM_SLOTFRAMES ||
+            (
+                    frameHandle != SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE &&
+                    slotOffset >= schedule_vars.slotframes[frameHandle].frameLength
+            )
+            ) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_OVERFLOWN, (errorparameter_t) 2, (errorparameter_t) frameHandle);
+        return E_FAIL;
+    }
+    slotframe = &schedule_vars.slotframes[frameHandle];
+
     // find an empty schedule entry container
     entry_found = FALSE;
     inBackupEntries = FALSE;
-    slotContainer = &schedule_vars.scheduleBuf[0];
-    do {
-        if (slotContainer->type != CELLTYPE_OFF) {
-            if (slotContainer->slotOffset == slotOffset) {
-                // found one entry with same slotoffset in schedule, check if there is space in second entries
-
-                for (i = 0; i < MAXBACKUPSLOTS; i++) {
-                    if (slotContainer->backupEntries[i].type == CELLTYPE_OFF) {
-                        inBackupEntries = TRUE;
-                        backupEntry = &(slotContainer->backupEntries[i]);
-                        break;
-                    }
-                }
-                if (inBackupEntries) {
-                    entry_found = TRUE;
-                    break;
-                }
+#if SCHEDULE_SLOT_INDEX
+    if (frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE && slotOffset >= SCHEDULE_INDEX_LENGTH) {
+        ENABLE_INTERRUPTS();
+        LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_OVERFLOWN, (errorparameter_t) 1, (errorparameter_t) slotOffset);
+        return E_FAIL;
+    }
+#endif
+
+    slotContainer = schedule_getEntry(frameHandle, slotOffset);
+    if (slotContainer != NULL) {
+        // found one entry with same slotoffset in schedule, check if there is space in second entries
+        for (i = 0; i < MAXBACKUPSLOTS; i++) {
+            if (slotContainer->backupEntries[i].type == CELLTYPE_OFF) {
+                inBackupEntries = TRUE;
+                entry_found = TRUE;
+                backupEntry = &(slotContainer->backupEntries[i]);
+                break;
+            }
+        }
+        if (inBackupEntries == FALSE) {
+            ENABLE_INTERRUPTS();
+            LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_ADD_DUPLICATE_SLOT, (errorparameter_t) slotOffset,
+                      (errorparameter_t) 0);
+            return E_FAIL;
+        }
+    } else {
+        for (i = 0; i < schedule_vars.maxActiveSlots; i++) {
+            if (schedule_vars.scheduleBuf[i].type == CELLTYPE_OFF) {
+                slotContainer = &schedule_vars.scheduleBuf[i];
+                entry_found = TRUE;
+                break;
             }
-            slotContainer++;
-        } else {
-            entry_found = TRUE;
-            break;
         }
-    } while (slotContainer <= &schedule_vars.scheduleBuf[schedule_vars.maxActiveSlots - 1]);
+    }
 
     // abort it schedule overflow
     if (entry_found == FALSE) {
@@ -296,6 +423,21 @@ owerror_t schedule_addActiveSlot(
     // assign the next slot pointer if it's allocated in backup entries
     if (inBackupEntries) {
 
+        // two autonomous cells hashed to the same slot, either one may be in the backup entries
+        if (isAutoCell) {
+            if (slotContainer->isAutoCell) {
+                msf_setHashCollisionFlag(TRUE);
+            }
+            for (i = 0; i < MAXBACKUPSLOTS; i++) {
+                if (
+                        slotContainer->backupEntries[i].type != CELLTYPE_OFF &&
+                        slotContainer->backupEntries[i].isAutoCell
+                        ) {
+                    msf_setHashCollisionFlag(TRUE);
+                }
+            }
+        }
+
         // the highest priority cell should be in schedule
         // priority  high ----------------- low
         //          autoTx  -> autoRx -> negotiated
@@ -368,6 +510,7 @@ owerror_t schedule_addActiveSlot(
 
     // fill that schedule entry with parameters passed
     slotContainer->slotOffset = slotOffset;
+    slotContainer->frameHandle = frameHandle;
     slotContainer->type = type;
     slotContainer->shared = shared;
     slotContainer->channelOffset = channelOffset;
@@ -381,60 +524,35 @@ owerror_t schedule_addActiveSlot(
     slotContainer->lastUsedAsn.byte4 = asn[4];
 
     // insert in circular list
-    if (schedule_vars.currentScheduleEntry == NULL) {
+    if (slotframe->currentScheduleEntry == NULL) {
         // this is the first active slot added
 
         // the next slot of this slot is this slot
         slotContainer->next = slotContainer;
 
         // current slot points to this slot
-        schedule_vars.currentScheduleEntry = slotContainer;
+        slotframe->currentScheduleEntry = slotContainer;
+        if (schedule_vars.activeScheduleEntry == NULL) {
+            schedule_vars.activeScheduleEntry = slotContainer;
+        }
     } else {
         // this is NOT the first active slot added
 
         // find position in schedule
-        previousSlotWalker = schedule_vars.currentScheduleEntry;
-        while (1) {
-            nextSlotWalker = previousSlotWalker->next;
-            if (
-                    (
-                            (previousSlotWalker->slotOffset < slotContainer->slotOffset) &&
-                            (slotContainer->slotOffset < nextSlotWalker->slotOffset)
-                    )
-                    ||
-                    (
-                            (previousSlotWalker->slotOffset < slotContainer->slotOffset) &&
-                            (nextSlotWalker->slotOffset <= previousSlotWalker->slotOffset)
-                    )
-                    ||
-                    (
-                            (slotContainer->slotOffset < nextSlotWalker->slotOffset) &&
-                            (nextSlotWalker->slotOffset <= previousSlotWalker->slotOffset)
-                    )
-                    ) {
-                break;
-            }
-            if (previousSlotWalker->slotOffset == slotContainer->slotOffset) {
-                // slot is already in schedule
-                LOG_ERROR(COMPONENT_SCHEDULE, ERR_SCHEDULE_ADD_DUPLICATE_SLOT,
-                          (errorparameter_t) slotContainer->slotOffset,
-                          (errorparameter_t) 0);
-                // reset the entry
-                slotContainer->slotOffset = 0;
-                slotContainer->type = CELLTYPE_OFF;
-                slotContainer->shared = FALSE;
-                slotContainer->channelOffset = 0;
-                memset(&slotContainer->neighbor, 0, sizeof(open_addr_t));
-                ENABLE_INTERRUPTS();
-                return E_FAIL;
-            }
-            previousSlotWalker = nextSlotWalker;
-        }
+        previousSlotWalker = schedule_getPreviousEntry(frameHandle, slotOffset);
+        nextSlotWalker = previousSlotWalker->next;
+
         // insert between previousSlotWalker and nextSlotWalker
         previousSlotWalker->next = slotContainer;
         slotContainer->next = nextSlotWalker;
     }
 
+#if SCHEDULE_SLOT_INDEX
+    if (frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE) {
+        schedule_indexSet(slotOffset, slotContainer);
+    }
+#endif
+
     ENABLE_INTERRUPTS();
     return E_SUCCESS;
 }
@@ -442,53 +560,54 @@ owerror_t schedule_addActiveSlot(
 /**
 \brief Remove an active slot from the schedule.
 
+\param frameHandle      The handle of the slotframe of the slot to remove.
 \param slotOffset       The slotoffset of the slot to remove.
 \param type             The type of the slot to remove.
 \param isShared         The slot is shared or not.
 \param neighbor         The neighbor associated with this cell (all 0's if
    none)
 */
-owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bool isShared, open_addr_t *neighbor) {
+owerror_t schedule_removeActiveSlot(
+        uint8_t frameHandle,
+        slotOffset_t slotOffset,
+        cellType_t type,
+        bool isShared,
+        open_addr_t *neighbor
+) {
     uint8_t i;
     bool entry_found;
     bool isbackupEntry;
     backupEntry_t *backupEntry;
     uint8_t candidate_index;
 
+    scheduleSlotframe_t *slotframe;
     scheduleEntry_t *slotContainer;
     scheduleEntry_t *previousSlotWalker;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    // find the schedule entry
+    // find the schedule entry, only the entry holding that slot offset can match
     entry_found = FALSE;
     isbackupEntry = FALSE;
-    slotContainer = &schedule_vars.scheduleBuf[0];
-    while (slotContainer <= &schedule_vars.scheduleBuf[schedule_vars.maxActiveSlots - 1]) {
-        if (slotContainer->slotOffset == slotOffset) {
-            if (packetfunctions_sameAddress(neighbor, &(slotContainer->neighbor))) {
-                entry_found = TRUE;
-                break;
-            } else {
-                for (i = 0; i < MAXBACKUPSLOTS; i++) {
-                    if (
-                            packetfunctions_sameAddress(neighbor, &(slotContainer->backupEntries[i].neighbor)) &&
-                            type == slotContainer->backupEntries[i].type &&
-                            isShared == slotContainer->backupEntries[i].shared
-                            ) {
-                        isbackupEntry = TRUE;
-                        backupEntry = &(slotContainer->backupEntries[i]);
-                        break;
-                    }
-                }
-                if (isbackupEntry) {
+    slotContainer = schedule_getEntry(frameHandle, slotOffset);
+    if (slotContainer != NULL) {
+        if (packetfunctions_sameAddress(neighbor, &(slotContainer->neighbor))) {
+            entry_found = TRUE;
+        } else {
+            for (i = 0; i < MAXBACKUPSLOTS; i++) {
+                if (
+                        packetfunctions_sameAddress(neighbor, &(slotContainer->backupEntries[i].neighbor)) &&
+                        type == slotContainer->backupEntries[i].type &&
+                        isShared == slotContainer->backupEntries[i].shared
+                        ) {
+                    isbackupEntry = TRUE;
                     entry_found = TRUE;
+                    backupEntry = &(slotContainer->backupEntries[i]);
                     break;
                 }
             }
         }
-        slotContainer++;
     }
 
     // abort it could not find
@@ -557,28 +676,29 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
     }
 
     // remove from linked list
+    slotframe = &schedule_vars.slotframes[frameHandle];
     if (slotContainer->next == slotContainer) {
         // this is the last active slot, the next slot of this slot is NULL
         slotContainer->next = NULL;
 
         // current slot points to this slot
-        schedule_vars.currentScheduleEntry = NULL;
+        slotframe->currentScheduleEntry = NULL;
+        if (schedule_vars.activeScheduleEntry == slotContainer) {
+            schedule_vars.activeScheduleEntry =
+                    schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE].currentScheduleEntry;
+        }
     } else {
         // this is NOT the last active slot, find the previous in the schedule
-        previousSlotWalker = schedule_vars.currentScheduleEntry;
-
-        while (1) {
-            if (previousSlotWalker->next == slotContainer) {
-                break;
-            }
-            previousSlotWalker = previousSlotWalker->next;
-        }
+        previousSlotWalker = schedule_getPreviousEntry(frameHandle, slotOffset);
 
         // remove this element from the linked list, i.e. have the previous slot "jump" to slotContainer's next
         previousSlotWalker->next = slotContainer->next;
 
         // update current slot if points to slot I just removed
-        if (schedule_vars.currentScheduleEntry == slotContainer) {
+        if (schedule_vars.activeScheduleEntry == slotContainer) {
+            schedule_vars.activeScheduleEntry = previousSlotWalker;
+        }
+        if (slotframe->currentScheduleEntry == slotContainer) {
             /**
                 attention: this should only happen at the end of slot. It's dangerous to remove current schedule entry
                 in the middle of the slot. The item access of currentScheduleEntry could be from unexpected entry.
@@ -587,11 +707,16 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
                 is because when the next active slot arrives, currentScheduleEntry will be assigned as
                 currentScheduleEntry->next
             */
-            schedule_vars.currentScheduleEntry = previousSlotWalker;
+            slotframe->currentScheduleEntry = previousSlotWalker;
         }
     }
 
     // reset removed schedule entry
+#if SCHEDULE_SLOT_INDEX
+    if (frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE) {
+        schedule_indexClear(slotOffset);
+    }
+#endif
     schedule_resetEntry(slotContainer);
 
     ENABLE_INTERRUPTS();
@@ -599,26 +724,26 @@ owerror_t schedule_removeActiveSlot(slotOffset_t slotOffset, cellType_t type, bo
     return E_SUCCESS;
 }
 
-bool schedule_isSlotOffsetAvailable(uint16_t slotOffset) {
-
-    scheduleEntry_t *scheduleWalker;
+bool schedule_isSlotOffsetAvailable(uint8_t frameHandle, uint16_t slotOffset) {
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    if (slotOffset >= schedule_vars.frameLength) {
+    if (frameHandle >= SCHEDULE_NUM_SLOTFRAMES || slotOffset >= schedule_vars.slotframes[frameHandle].frameLength) {
         ENABLE_INTERRUPTS();
         return FALSE;
     }
 
-    scheduleWalker = schedule_vars.currentScheduleEntry;
-    do {
-        if (slotOffset == scheduleWalker->slotOffset) {
-            ENABLE_INTERRUPTS();
-            return FALSE;
-        }
-        scheduleWalker = scheduleWalker->next;
-    } while (scheduleWalker != schedule_vars.currentScheduleEntry);
+#if SCHEDULE_SLOT_INDEX
+    if (frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE && slotOffset >= SCHEDULE_INDEX_LENGTH) {
+        ENABLE_INTERRUPTS();
+        return FALSE;
+    }
+#endif
+    if (schedule_getEntry(frameHandle, slotOffset) != NULL) {
+        ENABLE_INTERRUPTS();
+        return FALSE;
+    }
 
     ENABLE_INTERRUPTS();
 
@@ -628,9 +753,10 @@ bool schedule_isSlotOffsetAvailable(uint16_t slotOffset) {
 void schedule_removeAllNegotiatedCellsToNeighbor(uint8_t slotframeID, open_addr_t *neighbor) {
     uint8_t i;
 
-    // remove all entries in schedule with previousHop address
+    // remove all entries in that slotframe with previousHop address
     for (i = 0; i < MAXACTIVESLOTS; i++) {
         if (
+                schedule_vars.scheduleBuf[i].frameHandle == slotframeID &&
                 packetfunctions_sameAddress(&(schedule_vars.scheduleBuf[i].neighbor), neighbor) &&
                 (
                         schedule_vars.scheduleBuf[i].type == CELLTYPE_TX ||
@@ -638,6 +764,7 @@ void schedule_removeAllNegotiatedCellsToNeighbor(uint8_t slotframeID, open_addr_
                 )
                 ) {
             schedule_removeActiveSlot(
+                    slotframeID,
                     schedule_vars.scheduleBuf[i].slotOffset,
                     schedule_vars.scheduleBuf[i].type,
                     schedule_vars.scheduleBuf[i].shared,
@@ -685,13 +812,13 @@ uint8_t schedule_getNumberOfNegotiatedCells(open_addr_t *neighbor, cellType_t ce
             if (schedule_vars.scheduleBuf[i].isAutoCell) {
                 for (j = 0; j < MAXBACKUPSLOTS; j++) {
                     if (
-                            schedule_vars.scheduleBuf[i].backupEntries[j].type == CELLTYPE_TX &&
+                            schedule_vars.scheduleBuf[i].backupEntries[j].type == cell_type &&
                             packetfunctions_sameAddress(&(schedule_vars.scheduleBuf[i].backupEntries[j].neighbor),
                                                         neighbor) == TRUE &&
                             schedule_vars.scheduleBuf[i].backupEntries[j].shared == FALSE
                             ) {
                         counter++;
-                        // at most one negotiated Tx cell to a neighbor in backup entries
+                        // at most one negotiated cell to a neighbor in backup entries
                         break;
                     }
                 }
@@ -849,28 +976,54 @@ bool schedule_hasNegotiatedCellToNeighbor(open_addr_t *neighbor, cellType_t cell
 
 \param parentNeighbor           The parent address.
 \param nonParentNeighbor        The neighbor address of the negotiated tx cell.
+
+With MSF_DOWNSTREAM_AWARE, the tx cells to a neighbor which requested tx cells
+to this mote, i.e. to a child, are not reported. A former parent this mote
+requested rx cells from is not a child, its cells are reported.
 */
 
 bool schedule_hasNegotiatedTxCellToNonParent(open_addr_t *parentNeighbor, open_addr_t *nonParentNeighbor) {
     uint8_t i;
+    bool found;
+#if MSF_DOWNSTREAM_AWARE
+    open_addr_t child;
+#endif
 
     INTERRUPT_DECLARATION();
-    DISABLE_INTERRUPTS();
+
+#if MSF_DOWNSTREAM_AWARE
+    memset(&child, 0, sizeof(open_addr_t));
+#endif
 
     for (i = 0; i < MAXACTIVESLOTS; i++) {
-        if (
+        DISABLE_INTERRUPTS();
+        found = (
                 schedule_vars.scheduleBuf[i].type == CELLTYPE_TX &&
                 schedule_vars.scheduleBuf[i].shared == FALSE &&
                 schedule_vars.scheduleBuf[i].neighbor.type == ADDR_64B &&
                 packetfunctions_sameAddress(parentNeighbor, &schedule_vars.scheduleBuf[i].neighbor) == FALSE
-                ) {
+        );
+        if (found) {
             memcpy(nonParentNeighbor, &schedule_vars.scheduleBuf[i].neighbor, sizeof(open_addr_t));
-            ENABLE_INTERRUPTS();
-            return TRUE;
         }
+        ENABLE_INTERRUPTS();
+
+        if (found == FALSE) {
+            continue;
+        }
+#if MSF_DOWNSTREAM_AWARE
+        // look each child up once
+        if (packetfunctions_sameAddress(nonParentNeighbor, &child)) {
+            continue;
+        }
+        if (msf_isChild(nonParentNeighbor)) {
+            memcpy(&child, nonParentNeighbor, sizeof(open_addr_t));
+            continue;
+        }
+#endif
+        return TRUE;
     }
 
-    ENABLE_INTERRUPTS();
     return FALSE;
 }
 
@@ -899,39 +1052,151 @@ bool schedule_getAutonomousTxRxCellAnycast(uint16_t *slotoffset) {
 //=== from IEEE802154E: reading the schedule and updating statistics
 
 void schedule_syncSlotOffset(slotOffset_t targetSlotOffset) {
+    scheduleSlotframe_t *slotframe;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    uint8_t frameHandle;
+#endif
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    while (schedule_vars.currentScheduleEntry->slotOffset != targetSlotOffset) {
-        schedule_advanceSlot();
+    slotframe = &schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE];
+#if SCHEDULE_SLOT_INDEX
+    if (schedule_getEntry(SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE, targetSlotOffset) != NULL) {
+        slotframe->currentScheduleEntry =
+                schedule_getEntry(SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE, targetSlotOffset);
+    }
+#endif
+    while (slotframe->currentScheduleEntry->slotOffset != targetSlotOffset) {
+        slotframe->currentScheduleEntry = slotframe->currentScheduleEntry->next;
+    }
+    schedule_vars.activeScheduleEntry = slotframe->currentScheduleEntry;
+
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    // the other slotframes catch up with the ASN
+    slotframe->slotOffset = targetSlotOffset;
+    for (frameHandle = 1; frameHandle < SCHEDULE_NUM_SLOTFRAMES; frameHandle++) {
+        schedule_syncSlotframe(frameHandle);
     }
+    schedule_vars.isSlotAdvanced = TRUE;
+#endif
 
     ENABLE_INTERRUPTS();
 }
 
 /**
 \brief advance to next active slot
+
+With several slotframes, every slotframe with an active slot now advances, and
+the slot goes to the cell of the one with the lowest handle.
 */
 void schedule_advanceSlot(void) {
+    scheduleSlotframe_t *slotframe;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    uint8_t frameHandle;
+    scheduleEntry_t *nextEntry;
+    scheduleEntry_t *activeEntry;
+#endif
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    activeEntry = NULL;
+    for (frameHandle = 0; frameHandle < SCHEDULE_NUM_SLOTFRAMES; frameHandle++) {
+        slotframe = &schedule_vars.slotframes[frameHandle];
+        if (slotframe->currentScheduleEntry == NULL) {
+            continue;
+        }
+        nextEntry = slotframe->currentScheduleEntry->next;
+        if (nextEntry->slotOffset == slotframe->slotOffset) {
+            slotframe->currentScheduleEntry = nextEntry;
+            if (activeEntry == NULL) {
+                activeEntry = nextEntry;
+            }
+        }
+    }
+    if (activeEntry != NULL) {
+        schedule_vars.activeScheduleEntry = activeEntry;
+    }
+    schedule_vars.isSlotAdvanced = TRUE;
+#else
+    slotframe = &schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE];
+    slotframe->currentScheduleEntry = slotframe->currentScheduleEntry->next;
+    schedule_vars.activeScheduleEntry = slotframe->currentScheduleEntry;
+#endif
+
+    ENABLE_INTERRUPTS();
+}
+
+/**
+\brief Move the slot offsets of all slotframes on by numSlots slots.
+
+The MAC calls this each time it increments the ASN. Only needed, and only does
+something, with several slotframes.
+*/
+void schedule_incrementSlotOffsets(uint16_t numSlots) {
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    uint8_t frameHandle;
+    scheduleSlotframe_t *slotframe;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    schedule_vars.currentScheduleEntry = schedule_vars.currentScheduleEntry->next;
+
+    for (frameHandle = 0; frameHandle < SCHEDULE_NUM_SLOTFRAMES; frameHandle++) {
+        slotframe = &schedule_vars.slotframes[frameHandle];
+        if (slotframe->frameLength > 0) {
+            slotframe->slotOffset = (slotframe->slotOffset + numSlots) % slotframe->frameLength;
+        }
+    }
+    schedule_vars.isSlotAdvanced = FALSE;
 
     ENABLE_INTERRUPTS();
+#endif
 }
 
 /**
 \brief return slotOffset of next active slot
+
+With several slotframes, this is the closest active slot of any of them,
+expressed as a slot offset of slotframe 0.
 */
 slotOffset_t schedule_getNextActiveSlotOffset(void) {
     slotOffset_t res;
+    scheduleSlotframe_t *slotframe;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    uint8_t frameHandle;
+    frameLength_t distance;
+    frameLength_t minDistance;
+#endif
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    res = ((scheduleEntry_t *) (schedule_vars.currentScheduleEntry->next))->slotOffset;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    slotframe = &schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE];
+    minDistance = slotframe->frameLength;
+    for (frameHandle = 0; frameHandle < SCHEDULE_NUM_SLOTFRAMES; frameHandle++) {
+        slotframe = &schedule_vars.slotframes[frameHandle];
+        if (slotframe->currentScheduleEntry == NULL) {
+            continue;
+        }
+        distance = ((scheduleEntry_t *) (slotframe->currentScheduleEntry->next))->slotOffset +
+                   slotframe->frameLength - slotframe->slotOffset;
+        distance %= slotframe->frameLength;
+        if (distance == 0 && schedule_vars.isSlotAdvanced) {
+            // that active slot is the one just advanced to, it comes back a slotframe later
+            distance = slotframe->frameLength;
+        }
+        if (distance < minDistance) {
+            minDistance = distance;
+        }
+    }
+    slotframe = &schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE];
+    res = (slotframe->slotOffset + minDistance) % slotframe->frameLength;
+#else
+    slotframe = &schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE];
+    res = ((scheduleEntry_t *) (slotframe->currentScheduleEntry->next))->slotOffset;
+#endif
 
     ENABLE_INTERRUPTS();
 
@@ -949,7 +1214,7 @@ frameLength_t schedule_getFrameLength(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.frameLength;
+    returnVal = schedule_vars.slotframes[SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE].frameLength;
 
     ENABLE_INTERRUPTS();
 
@@ -968,7 +1233,7 @@ cellType_t schedule_getType(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.currentScheduleEntry->type;
+    returnVal = schedule_vars.activeScheduleEntry->type;
 
     ENABLE_INTERRUPTS();
 
@@ -987,7 +1252,7 @@ bool schedule_getShared(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.currentScheduleEntry->shared;
+    returnVal = schedule_vars.activeScheduleEntry->shared;
 
     ENABLE_INTERRUPTS();
 
@@ -1006,7 +1271,7 @@ bool schedule_getIsAutoCell(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.currentScheduleEntry->isAutoCell;
+    returnVal = schedule_vars.activeScheduleEntry->isAutoCell;
 
     ENABLE_INTERRUPTS();
 
@@ -1023,7 +1288,7 @@ void schedule_getNeighbor(open_addr_t *addrToWrite) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    memcpy(addrToWrite, &(schedule_vars.currentScheduleEntry->neighbor), sizeof(open_addr_t));
+    memcpy(addrToWrite, &(schedule_vars.activeScheduleEntry->neighbor), sizeof(open_addr_t));
 
     ENABLE_INTERRUPTS();
 }
@@ -1039,7 +1304,7 @@ slotOffset_t schedule_getSlottOffset(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.currentScheduleEntry->slotOffset;
+    returnVal = schedule_vars.activeScheduleEntry->slotOffset;
 
     ENABLE_INTERRUPTS();
 
@@ -1057,7 +1322,7 @@ channelOffset_t schedule_getChannelOffset(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    returnVal = schedule_vars.currentScheduleEntry->channelOffset;
+    returnVal = schedule_vars.activeScheduleEntry->channelOffset;
 
     ENABLE_INTERRUPTS();
 
@@ -1082,14 +1347,14 @@ bool schedule_getOkToSend(void) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    if (schedule_vars.currentScheduleEntry->shared == FALSE) {
+    if (schedule_vars.activeScheduleEntry->shared == FALSE) {
         // non-shared slot: backoff does not apply
 
         returnVal = TRUE;
     } else {
         // shared slot: check backoff before answering
 
-        if (schedule_vars.currentScheduleEntry->neighbor.type == ADDR_ANYCAST) {
+        if (schedule_vars.activeScheduleEntry->neighbor.type == ADDR_ANYCAST) {
             // this is a minimal cell
             if (schedule_vars.backoff > 0) {
                 schedule_vars.backoff--;
@@ -1103,9 +1368,9 @@ bool schedule_getOkToSend(void) {
             }
         } else {
             // this is a dedicated cell (auto Tx cell)
-            neighbors_decreaseBackoff(&schedule_vars.currentScheduleEntry->neighbor);
+            neighbors_decreaseBackoff(&schedule_vars.activeScheduleEntry->neighbor);
 
-            returnVal = neighbors_backoffHitZero(&schedule_vars.currentScheduleEntry->neighbor);
+            returnVal = neighbors_backoffHitZero(&schedule_vars.activeScheduleEntry->neighbor);
         }
     }
 
@@ -1139,10 +1404,10 @@ void schedule_indicateRx(asn_t *asnTimestamp) {
     DISABLE_INTERRUPTS();
 
     // increment usage statistics
-    schedule_vars.currentScheduleEntry->numRx++;
+    schedule_vars.activeScheduleEntry->numRx++;
 
     // update last used timestamp
-    memcpy(&(schedule_vars.currentScheduleEntry->lastUsedAsn), asnTimestamp, sizeof(asn_t));
+    memcpy(&(schedule_vars.activeScheduleEntry->lastUsedAsn), asnTimestamp, sizeof(asn_t));
 
     ENABLE_INTERRUPTS();
 }
@@ -1156,31 +1421,31 @@ void schedule_indicateTx(asn_t *asnTimestamp, bool succesfullTx) {
     DISABLE_INTERRUPTS();
 
     // increment usage statistics
-    if (schedule_vars.currentScheduleEntry->numTx == 0xFF) {
-        schedule_vars.currentScheduleEntry->numTx /= 2;
-        schedule_vars.currentScheduleEntry->numTxACK /= 2;
+    if (schedule_vars.activeScheduleEntry->numTx == 0xFF) {
+        schedule_vars.activeScheduleEntry->numTx /= 2;
+        schedule_vars.activeScheduleEntry->numTxACK /= 2;
     }
-    schedule_vars.currentScheduleEntry->numTx++;
+    schedule_vars.activeScheduleEntry->numTx++;
     if (succesfullTx == TRUE) {
-        schedule_vars.currentScheduleEntry->numTxACK++;
+        schedule_vars.activeScheduleEntry->numTxACK++;
     }
 
     // update last used timestamp
-    memcpy(&schedule_vars.currentScheduleEntry->lastUsedAsn, asnTimestamp, sizeof(asn_t));
+    memcpy(&schedule_vars.activeScheduleEntry->lastUsedAsn, asnTimestamp, sizeof(asn_t));
 
     // update this backoff parameters for shared slots
-    if (schedule_vars.currentScheduleEntry->shared == TRUE) {
+    if (schedule_vars.activeScheduleEntry->shared == TRUE) {
         if (succesfullTx == TRUE) {
-            if (schedule_vars.currentScheduleEntry->neighbor.type == ADDR_ANYCAST) {
+            if (schedule_vars.activeScheduleEntry->neighbor.type == ADDR_ANYCAST) {
                 // reset backoffExponent
                 schedule_vars.backoffExponenton = MINBE - 1;
                 // reset backoff
                 schedule_vars.backoff = 0;
             } else {
-                neighbors_resetBackoff(&schedule_vars.currentScheduleEntry->neighbor);
+                neighbors_resetBackoff(&schedule_vars.activeScheduleEntry->neighbor);
             }
         } else {
-            if (schedule_vars.currentScheduleEntry->neighbor.type == ADDR_ANYCAST) {
+            if (schedule_vars.activeScheduleEntry->neighbor.type == ADDR_ANYCAST) {
                 // increase the backoffExponent
                 if (schedule_vars.backoffExponenton < MAXBE) {
                     schedule_vars.backoffExponenton++;
@@ -1188,7 +1453,7 @@ void schedule_indicateTx(asn_t *asnTimestamp, bool succesfullTx) {
                 // set the backoff to a random value in [0..2^BE]
                 schedule_vars.backoff = openrandom_get16b() % (1 << schedule_vars.backoffExponenton);
             } else {
-                neighbors_updateBackoff(&schedule_vars.currentScheduleEntry->neighbor);
+                neighbors_updateBackoff(&schedule_vars.activeScheduleEntry->neighbor);
             }
         }
     }
@@ -1200,6 +1465,11 @@ bool schedule_getOneCellAfterOffset(uint8_t metadata, uint8_t offset, open_addr_
                                     uint16_t *slotoffset, uint16_t *channeloffset) {
     bool returnVal;
     scheduleEntry_t *scheduleWalker;
+    scheduleEntry_t *cellFound;
+    uint8_t i;
+#if SCHEDULE_SLOT_INDEX
+    slotOffset_t slotOffset;
+#endif
     cellType_t type;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
@@ -1215,17 +1485,44 @@ bool schedule_getOneCellAfterOffset(uint8_t metadata, uint8_t offset, open_addr_
         type = CELLTYPE_TXRX;
     }
 
-    returnVal = FALSE;
-    scheduleWalker = &schedule_vars.scheduleBuf[0]; // fisrt entry record slotoffset 0
-    do {
-        if (type == scheduleWalker->type && scheduleWalker->slotOffset >= offset) {
-            *slotoffset = scheduleWalker->slotOffset;
-            *channeloffset = scheduleWalker->channelOffset;
-            returnVal = TRUE;
-            break;
+    // metadata is the slotframe handle
+    cellFound = NULL;
+#if SCHEDULE_SLOT_INDEX
+    if (metadata == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE) {
+        for (
+                slotOffset = schedule_getNextUsedSlotOffset(offset);
+                slotOffset < SCHEDULE_INDEX_LENGTH;
+                slotOffset = schedule_getNextUsedSlotOffset(slotOffset + 1)
+                ) {
+            scheduleWalker = schedule_getEntry(metadata, slotOffset);
+            if (type == scheduleWalker->type) {
+                cellFound = scheduleWalker;
+                break;
+            }
+        }
+    } else
+#endif
+    {
+        // the cell of that type with the lowest slot offset from offset on
+        for (i = 0; i < MAXACTIVESLOTS; i++) {
+            scheduleWalker = &schedule_vars.scheduleBuf[i];
+            if (
+                    type == scheduleWalker->type &&
+                    metadata == scheduleWalker->frameHandle &&
+                    scheduleWalker->slotOffset >= offset &&
+                    (cellFound == NULL || scheduleWalker->slotOffset < cellFound->slotOffset)
+                    ) {
+                cellFound = scheduleWalker;
+            }
         }
-        scheduleWalker = scheduleWalker->next;
-    } while (scheduleWalker != &schedule_vars.scheduleBuf[0]);
+    }
+
+    returnVal = FALSE;
+    if (cellFound != NULL) {
+        *slotoffset = cellFound->slotOffset;
+        *channeloffset = cellFound->channelOffset;
+        returnVal = TRUE;
+    }
 
     ENABLE_INTERRUPTS();
 
@@ -1239,6 +1536,7 @@ bool schedule_getOneCellAfterOffset(uint8_t metadata, uint8_t offset, open_addr_
 */
 void schedule_resetEntry(scheduleEntry_t *e) {
     e->slotOffset = 0;
+    e->frameHandle = 0;
     e->type = CELLTYPE_OFF;
     e->shared = FALSE;
     e->isAutoCell = FALSE;
@@ -1275,3 +1573,158 @@ void schedule_resetBackupEntry(backupEntry_t *e) {
     e->next = NULL;
 }
 
+/**
+\brief Find the active entry scheduled at a slot offset of a slotframe.
+
+\returns The entry, or NULL when that slot offset is not in use.
+*/
+static scheduleEntry_t* schedule_getEntry(uint8_t frameHandle, slotOffset_t slotOffset) {
+    uint8_t i;
+
+#if SCHEDULE_SLOT_INDEX
+    if (frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE) {
+        if (slotOffset >= SCHEDULE_INDEX_LENGTH || schedule_vars.slotIndex[slotOffset] == SCHEDULE_NO_ENTRY) {
+            return NULL;
+        }
+        return &schedule_vars.scheduleBuf[schedule_vars.slotIndex[slotOffset]];
+    }
+#endif
+    for (i = 0; i < schedule_vars.maxActiveSlots; i++) {
+        if (
+                schedule_vars.scheduleBuf[i].type != CELLTYPE_OFF &&
+                schedule_vars.scheduleBuf[i].frameHandle == frameHandle &&
+                schedule_vars.scheduleBuf[i].slotOffset == slotOffset
+                ) {
+            return &schedule_vars.scheduleBuf[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+\brief Find the entry after which a slot offset goes in the circular list of a slotframe.
+
+\pre The slotframe holds at least one active slot other than slotOffset.
+*/
+static scheduleEntry_t* schedule_getPreviousEntry(uint8_t frameHandle, slotOffset_t slotOffset) {
+    scheduleEntry_t *previousSlotWalker;
+    scheduleEntry_t *nextSlotWalker;
+
+#if SCHEDULE_SLOT_INDEX
+    if (frameHandle == SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE) {
+        return schedule_getEntry(frameHandle, schedule_getPreviousUsedSlotOffset(slotOffset));
+    }
+#endif
+    previousSlotWalker = schedule_vars.slotframes[frameHandle].currentScheduleEntry;
+    while (1) {
+        nextSlotWalker = previousSlotWalker->next;
+        if (
+                (
+                        (previousSlotWalker->slotOffset < slotOffset) &&
+                        (slotOffset <= nextSlotWalker->slotOffset)
+                )
+                ||
+                (
+                        (previousSlotWalker->slotOffset < slotOffset) &&
+                        (nextSlotWalker->slotOffset <= previousSlotWalker->slotOffset)
+                )
+                ||
+                (
+                        (slotOffset <= nextSlotWalker->slotOffset) &&
+                        (nextSlotWalker->slotOffset <= previousSlotWalker->slotOffset)
+                )
+                ) {
+            return previousSlotWalker;
+        }
+        previousSlotWalker = nextSlotWalker;
+    }
+}
+
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+/**
+\brief Bring the slot offset of a slotframe in line with the ASN.
+
+The current entry of the slotframe becomes its last active slot at or before
+that slot offset.
+*/
+static void schedule_syncSlotframe(uint8_t frameHandle) {
+    scheduleSlotframe_t *slotframe;
+    uint8_t asn[5];
+    uint32_t slotOffset;
+
+    slotframe = &schedule_vars.slotframes[frameHandle];
+    if (slotframe->frameLength == 0) {
+        return;
+    }
+
+    // ASN modulo the slotframe length
+    ieee154e_getAsn(&(asn[0]));
+    slotOffset = asn[4] % slotframe->frameLength;
+    slotOffset = ((slotOffset << 16) + 256 * asn[3] + asn[2]) % slotframe->frameLength;
+    slotOffset = ((slotOffset << 16) + 256 * asn[1] + asn[0]) % slotframe->frameLength;
+    slotframe->slotOffset = (slotOffset_t) slotOffset;
+
+    if (slotframe->currentScheduleEntry != NULL) {
+        slotframe->currentScheduleEntry = schedule_getPreviousEntry(frameHandle, slotframe->slotOffset + 1);
+    }
+}
+#endif
+
+#if SCHEDULE_SLOT_INDEX
+static void schedule_indexSet(slotOffset_t slotOffset, scheduleEntry_t *entry) {
+    schedule_vars.slotIndex[slotOffset] = (uint8_t) (entry - &schedule_vars.scheduleBuf[0]);
+    schedule_vars.slotBitmap[slotOffset >> 3] |= (1 << (slotOffset & 0x07));
+}
+
+static void schedule_indexClear(slotOffset_t slotOffset) {
+    schedule_vars.slotIndex[slotOffset] = SCHEDULE_NO_ENTRY;
+    schedule_vars.slotBitmap[slotOffset >> 3] &= ~(1 << (slotOffset & 0x07));
+}
+
+/**
+\brief Find the first slot offset in use, starting from a given one.
+
+Empty bytes of the bitmap are skipped 8 slot offsets at a time.
+
+\returns The slot offset, or SCHEDULE_INDEX_LENGTH when none is in use.
+*/
+static slotOffset_t schedule_getNextUsedSlotOffset(slotOffset_t slotOffset) {
+    while (slotOffset < SCHEDULE_INDEX_LENGTH) {
+        if ((slotOffset & 0x07) == 0 && schedule_vars.slotBitmap[slotOffset >> 3] == 0) {
+            slotOffset += 8;
+            continue;
+        }
+        if (schedule_vars.slotBitmap[slotOffset >> 3] & (1 << (slotOffset & 0x07))) {
+            return slotOffset;
+        }
+        slotOffset++;
+    }
+    return SCHEDULE_INDEX_LENGTH;
+}
+
+/**
+\brief Find the closest slot offset in use before a given one, wrapping around.
+
+\pre The schedule holds at least one active slot other than slotOffset.
+*/
+static slotOffset_t schedule_getPreviousUsedSlotOffset(slotOffset_t slotOffset) {
+    slotOffset_t i;
+
+    i = slotOffset;
+    do {
+        if (i == 0) {
+            i = SCHEDULE_INDEX_LENGTH - 1;
+        } else {
+            i--;
+        }
+        if ((i & 0x07) == 0x07 && schedule_vars.slotBitmap[i >> 3] == 0) {
+            i -= 0x07;
+            continue;
+        }
+        if (schedule_vars.slotBitmap[i >> 3] & (1 << (i & 0x07))) {
+            return i;
+        }
+    } while (i != slotOffset);
+    return slotOffset;
+}
+#endif
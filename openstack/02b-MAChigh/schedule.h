@@ -72,6 +72,25 @@ those slots's next pointer is pointing to the same entries.
 #define MAXBACKUPSLOTS   2
 #endif
 
+#if SCHEDULE_SLOT_INDEX
+/**
+\brief Number of slot offsets covered by the slot index.
+
+With SCHEDULE_SLOT_INDEX, the schedule keeps, for each slot offset below this
+value, the row of scheduleBuf holding it and a bit telling whether it is in
+use. Cells can only be scheduled at slot offsets below this value.
+*/
+#ifndef SCHEDULE_INDEX_LENGTH
+#define SCHEDULE_INDEX_LENGTH    SLOTFRAME_LENGTH
+#endif
+
+#define SCHEDULE_NO_ENTRY        0xff
+
+#if MAXACTIVESLOTS >= SCHEDULE_NO_ENTRY
+#error "the slot index supports at most 254 active slots."
+#endif
+#endif
+
 /**
 \brief Minimum backoff exponent.
 
@@ -129,6 +148,7 @@ typedef struct {
 
 typedef struct {
     slotOffset_t slotOffset;
+    uint8_t frameHandle;
     cellType_t type;
     bool shared;
     bool isAutoCell;
@@ -142,6 +162,12 @@ typedef struct {
     void *next;
 } scheduleEntry_t;
 
+typedef struct {
+    scheduleEntry_t *currentScheduleEntry;  // last active slot reached, the next one is its next entry
+    frameLength_t frameLength;              // 0 when the slotframe is not in use
+    slotOffset_t slotOffset;                // slot offset of the current slot, kept with SCHEDULE_NUM_SLOTFRAMES > 1
+} scheduleSlotframe_t;
+
 BEGIN_PACK
 typedef struct {
     uint8_t row;
@@ -170,14 +196,21 @@ typedef struct {
 
 typedef struct {
     scheduleEntry_t scheduleBuf[MAXACTIVESLOTS];
-    scheduleEntry_t *currentScheduleEntry;
-    frameLength_t frameLength;
+    scheduleSlotframe_t slotframes[SCHEDULE_NUM_SLOTFRAMES];  // indexed by slotframe handle
+    scheduleEntry_t *activeScheduleEntry;                     // cell used in the current slot
     frameLength_t maxActiveSlots;
     uint8_t frameHandle;
     uint8_t frameNumber;
     uint8_t backoffExponenton;
     uint8_t backoff;
     uint8_t debugPrintRow;
+#if SCHEDULE_NUM_SLOTFRAMES > 1
+    bool isSlotAdvanced;                                      // the current slot was already advanced to
+#endif
+#if SCHEDULE_SLOT_INDEX
+    uint8_t slotIndex[SCHEDULE_INDEX_LENGTH];                 // row of scheduleBuf holding each slot offset
+    uint8_t slotBitmap[(SCHEDULE_INDEX_LENGTH + 7) / 8];      // one bit per slot offset in use
+#endif
 } schedule_vars_t;
 
 //=========================== prototypes ======================================
@@ -198,7 +231,12 @@ void schedule_setFrameHandle(uint8_t frameHandle);
 
 void schedule_setFrameNumber(uint8_t frameNumber);
 
+owerror_t schedule_addSlotframe(uint8_t frameHandle, frameLength_t frameLength);
+
+frameLength_t schedule_getSlotframeLength(uint8_t frameHandle);
+
 owerror_t schedule_addActiveSlot(
+        uint8_t frameHandle,
         slotOffset_t slotOffset,
         cellType_t type,
         bool shared,
@@ -208,11 +246,18 @@ owerror_t schedule_addActiveSlot(
 );
 
 void schedule_getSlotInfo(
+        uint8_t frameHandle,
+        slotOffset_t slotOffset,
+        slotinfo_element_t *info
+);
+
+void schedule_getCurrentSlotInfo(
         slotOffset_t slotOffset,
         slotinfo_element_t *info
 );
 
 owerror_t schedule_removeActiveSlot(
+        uint8_t frameHandle,
         slotOffset_t slotOffset,
         cellType_t type,
         bool isShared,
@@ -221,7 +266,7 @@ owerror_t schedule_removeActiveSlot(
 
 void schedule_removeAllAutonomousTxRxCellUnicast(void);
 
-bool schedule_isSlotOffsetAvailable(uint16_t slotOffset);
+bool schedule_isSlotOffsetAvailable(uint8_t frameHandle, uint16_t slotOffset);
 
 void schedule_removeAllNegotiatedCellsToNeighbor(uint8_t slotframeID, open_addr_t *neighbor);
 
@@ -254,6 +299,8 @@ void schedule_syncSlotOffset(slotOffset_t targetSlotOffset);
 
 void schedule_advanceSlot(void);
 
+void schedule_incrementSlotOffsets(uint16_t numSlots);
+
 slotOffset_t schedule_getNextActiveSlotOffset(void);
 
 frameLength_t schedule_getFrameLength(void);
@@ -23,11 +23,13 @@
 // in seconds: sixtop maintaince is called every 30 seconds
 #define MAINTENANCE_PERIOD        30
 /**
- Drop the 6P request if number of 6P response with RC RESET in queue is larger
-    than MAX6PRESPONSE. Value 0 means that alway drop 6P response when the node
-    is in a 6P transcation.
+ Drop the 6P request if the number of 6P responses in queue to the same
+    neighbor is MAX6PRESPONSE or more, or if SIXTOP_MAX_TRANSACTIONS responses
+    to any neighbors are in queue already.
 */
 #define MAX6PRESPONSE             1
+// the transactions time out on the ASN, within one slot
+#define SIX2SIX_TIMEOUT_SLOTS     (SIX2SIX_TIMEOUT_MS / SLOTDURATION)
 
 //=========================== variables =======================================
 
@@ -49,8 +51,12 @@ void sixtop_sendingEb_timer_cb(opentimers_id_t id);
 
 void timer_sixtop_sendEb_fired(void);
 
+void sixtop_startEbTrickleInterval(void);
+
 void timer_sixtop_management_fired(void);
 
+bool sixtop_isReadyToSendEB(void);
+
 void sixtop_sendEB(void);
 
 void sixtop_sendKA(void);
@@ -59,6 +65,14 @@ void sixtop_sendKA(void);
 
 void timer_sixtop_six2six_timeout_fired(void);
 
+sixtop_transaction_t* sixtop_getTransaction(open_addr_t *neighbor);
+
+sixtop_transaction_t* sixtop_getFreeTransaction(void);
+
+void sixtop_endTransaction(sixtop_transaction_t *transaction);
+
+void sixtop_scheduleTimeout(void);
+
 void sixtop_six2six_sendDone(OpenQueueEntry_t *msg, owerror_t error);
 
 bool sixtop_processIEs(
@@ -117,9 +131,13 @@ void sixtop_init(void) {
     sixtop_vars.dsn = 0;
     sixtop_vars.mgtTaskCounter = 0;
     sixtop_vars.kaPeriod = MAXKAPERIOD;
-    sixtop_vars.six2six_state = SIX_STATE_IDLE;
+    memset(sixtop_vars.transactions, 0, sizeof(sixtop_vars.transactions));
 
     sixtop_vars.ebSendingTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP);
+#if SIXTOP_EB_TRICKLE
+    sixtop_vars.ebTrickleInterval = SIXTOP_EB_IMIN;
+    sixtop_startEbTrickleInterval();
+#else
     opentimers_scheduleIn(
             sixtop_vars.ebSendingTimerId,
             SLOTFRAME_LENGTH * SLOTDURATION,
@@ -127,8 +145,10 @@ void sixtop_init(void) {
             TIMER_PERIODIC,
             sixtop_sendingEb_timer_cb
     );
+#endif
 
     sixtop_vars.maintenanceTimerId = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_SIXTOP);
+    opentimers_setTolerance(sixtop_vars.maintenanceTimerId, OPENTIMERS_TOLERANCE_MS, TIME_MS);
     opentimers_scheduleIn(
             sixtop_vars.maintenanceTimerId,
             sixtop_vars.periodMaintenance,
@@ -171,10 +191,17 @@ owerror_t sixtop_request(
     uint16_t length_groupid_type;
     uint8_t sequenceNumber;
     owerror_t outcome;
+    sixtop_transaction_t *transaction;
 
     // filter parameters: handler, status and neighbor
-    if (sixtop_vars.six2six_state != SIX_STATE_IDLE || neighbor == NULL) {
-        // neighbor can't be none or previous transcation doesn't finish yet
+    if (neighbor == NULL || sixtop_getTransaction(neighbor) != NULL) {
+        // neighbor can't be none or previous transcation with it doesn't finish yet
+        return E_FAIL;
+    }
+
+    // the transaction gets a free entry, other neighbors may use the others
+    transaction = sixtop_getFreeTransaction();
+    if (transaction == NULL) {
         return E_FAIL;
     }
 
@@ -195,10 +222,6 @@ owerror_t sixtop_request(
     pkt->owner = COMPONENT_SIXTOP_RES;
 
     memcpy(&(pkt->l2_nextORpreviousHop), neighbor, sizeof(open_addr_t));
-    if (celllist_toBeDeleted != NULL) {
-        memcpy(sixtop_vars.celllist_toDelete, celllist_toBeDeleted, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
-    }
-    sixtop_vars.cellOptions = cellOptions;
 
     len = 0;
     if (code == IANA_6TOP_CMD_ADD || code == IANA_6TOP_CMD_DELETE || code == IANA_6TOP_CMD_RELOCATE) {
@@ -269,9 +292,6 @@ owerror_t sixtop_request(
         }
         *((uint8_t * )(pkt->payload)) = cellOptions;
         len += 1;
-    } else {
-        // record the neighbor in case no response  for clear
-        memcpy(&sixtop_vars.neighborToClearCells, neighbor, sizeof(open_addr_t));
     }
 
     // append 6p metadata
@@ -339,25 +359,34 @@ owerror_t sixtop_request(
 
     if (outcome == E_SUCCESS) {
         LOG_INFO(COMPONENT_SIXTOP, ERR_SIXTOP_REQUEST, (errorparameter_t) code, (errorparameter_t) 0);
+        // record the transaction, the neighbor is also needed in case no response for clear
+        memcpy(&transaction->neighbor, neighbor, sizeof(open_addr_t));
+        if (celllist_toBeAdded != NULL && (code == IANA_6TOP_CMD_ADD || code == IANA_6TOP_CMD_RELOCATE)) {
+            memcpy(transaction->celllist_toAdd, celllist_toBeAdded, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
+        }
+        if (celllist_toBeDeleted != NULL) {
+            memcpy(transaction->celllist_toDelete, celllist_toBeDeleted, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
+        }
+        transaction->cellOptions = cellOptions;
         //update states
         switch (code) {
             case IANA_6TOP_CMD_ADD:
-                sixtop_vars.six2six_state = SIX_STATE_WAIT_ADDREQUEST_SENDDONE;
+                transaction->state = SIX_STATE_WAIT_ADDREQUEST_SENDDONE;
                 break;
             case IANA_6TOP_CMD_DELETE:
-                sixtop_vars.six2six_state = SIX_STATE_WAIT_DELETEREQUEST_SENDDONE;
+                transaction->state = SIX_STATE_WAIT_DELETEREQUEST_SENDDONE;
                 break;
             case IANA_6TOP_CMD_RELOCATE:
-                sixtop_vars.six2six_state = SIX_STATE_WAIT_RELOCATEREQUEST_SENDDONE;
+                transaction->state = SIX_STATE_WAIT_RELOCATEREQUEST_SENDDONE;
                 break;
             case IANA_6TOP_CMD_COUNT:
-                sixtop_vars.six2six_state = SIX_STATE_WAIT_COUNTREQUEST_SENDDONE;
+                transaction->state = SIX_STATE_WAIT_COUNTREQUEST_SENDDONE;
                 break;
             case IANA_6TOP_CMD_LIST:
-                sixtop_vars.six2six_state = SIX_STATE_WAIT_LISTREQUEST_SENDDONE;
+                transaction->state = SIX_STATE_WAIT_LISTREQUEST_SENDDONE;
                 break;
             case IANA_6TOP_CMD_CLEAR:
-                sixtop_vars.six2six_state = SIX_STATE_WAIT_CLEARREQUEST_SENDDONE;
+                transaction->state = SIX_STATE_WAIT_CLEARREQUEST_SENDDONE;
                 break;
         }
     } else {
@@ -366,6 +395,36 @@ owerror_t sixtop_request(
     return outcome;
 }
 
+/**
+\brief Tell whether a cell is offered in an ongoing 6P ADD or RELOCATE request.
+
+The offered cells are only scheduled when the response comes back, so they must
+not be offered to, or granted to, another neighbor in the meantime.
+
+\param[in] slotoffset The slot offset of the cell.
+
+\returns TRUE if an ongoing transaction offers a cell at that slot offset.
+*/
+bool sixtop_isCellPending(uint16_t slotoffset) {
+    uint8_t i;
+    uint8_t j;
+
+    for (i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+        if (sixtop_vars.transactions[i].state == SIX_STATE_IDLE) {
+            continue;
+        }
+        for (j = 0; j < CELLLIST_MAX_LEN; j++) {
+            if (
+                    sixtop_vars.transactions[i].celllist_toAdd[j].isUsed &&
+                    sixtop_vars.transactions[i].celllist_toAdd[j].slotoffset == slotoffset
+                    ) {
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
 //======= from upper layer
 
 owerror_t sixtop_send(OpenQueueEntry_t *msg) {
@@ -386,6 +445,20 @@ owerror_t sixtop_send(OpenQueueEntry_t *msg) {
     }
 }
 
+/**
+\brief Indicate an inconsistency to the Trickle timer of the EBs.
+
+The Trickle interval restarts from SIXTOP_EB_IMIN, unless it is there already.
+*/
+void sixtop_resetEbTrickle(void) {
+#if SIXTOP_EB_TRICKLE
+    if (sixtop_vars.ebTrickleInterval > SIXTOP_EB_IMIN) {
+        sixtop_vars.ebTrickleInterval = SIXTOP_EB_IMIN;
+        sixtop_startEbTrickleInterval();
+    }
+#endif
+}
+
 //======= from lower layer
 
 void task_sixtopNotifSendDone(void) {
@@ -461,14 +534,24 @@ void task_sixtopNotifReceive(void) {
     msg->owner = COMPONENT_SIXTOP;
 
     // update neighbor statistics
-    neighbors_indicateRx(
-            &(msg->l2_nextORpreviousHop),
-            msg->l1_rssi,
-            &msg->l2_asn,
-            msg->l2_joinPriorityPresent,
-            msg->l2_joinPriority,
-            msg->l2_securityLevel == IEEE154_ASH_SLF_TYPE_NOSEC ? TRUE : FALSE
-    );
+    if (
+            neighbors_indicateRx(
+                    &(msg->l2_nextORpreviousHop),
+                    msg->l1_rssi,
+                    &msg->l2_asn,
+                    msg->l2_joinPriorityPresent,
+                    msg->l2_joinPriority,
+                    msg->l2_securityLevel == IEEE154_ASH_SLF_TYPE_NOSEC ? TRUE : FALSE
+            )
+            ) {
+        // a new neighbor, e.g. joining, needs EBs
+        sixtop_resetEbTrickle();
+    }
+#if SIXTOP_EB_TRICKLE
+    if (msg->l2_frameType == IEEE154_TYPE_BEACON && sixtop_vars.ebTrickleCounter < 0xff) {
+        sixtop_vars.ebTrickleCounter++;
+    }
+#endif
 
     // process the header IEs
     lenIE = 0;
@@ -602,6 +685,10 @@ owerror_t sixtop_send_internal(
     }
     // change owner to IEEE802154E fetches it from queue
     msg->owner = COMPONENT_SIXTOP_TO_IEEE802154E;
+    openqueue_sixtopEnqueue(msg);
+
+    // the scheduling function follows the traffic
+    msf_indicatePacketQueued(&(msg->l2_nextORpreviousHop));
 
     if (
             packetfunctions_isBroadcastMulticast(&(msg->l2_nextORpreviousHop)) == FALSE &&
@@ -613,6 +700,7 @@ owerror_t sixtop_send_internal(
         // no auto tx cell to that neighbor
 
         schedule_addActiveSlot(
+                SCHEDULE_MINIMAL_6TISCH_DEFAULT_SLOTFRAME_HANDLE,                // slotframe handle
                 msf_hashFunction_getSlotoffset(&(msg->l2_nextORpreviousHop)),    // slot offset
                 CELLTYPE_TX,                                                     // type of slot
                 TRUE,                                                            // shared?
@@ -657,10 +745,59 @@ void sixtop_timeout_timer_cb(opentimers_id_t id) {
 //======= EB/KA task
 
 void timer_sixtop_sendEb_fired(void) {
+#if SIXTOP_EB_TRICKLE
+    if (sixtop_vars.ebTrickleIsIntervalEnd) {
+        if (sixtop_isReadyToSendEB() == FALSE) {
+            // advertise at the highest rate once I can
+            sixtop_vars.ebTrickleInterval = SIXTOP_EB_IMIN;
+        } else if (sixtop_vars.ebTrickleInterval < ((uint32_t) SIXTOP_EB_IMIN << SIXTOP_EB_IMAX_DOUBLINGS)) {
+            // the neighborhood is stable, double the interval
+            sixtop_vars.ebTrickleInterval *= 2;
+        }
+        sixtop_startEbTrickleInterval();
+    } else {
+        // send an EB, unless enough neighbors did during this interval
+        if (sixtop_vars.ebTrickleCounter < SIXTOP_EB_REDUNDANCY) {
+            sixtop_sendEB();
+        }
+        sixtop_vars.ebTrickleIsIntervalEnd = TRUE;
+        opentimers_scheduleIn(
+                sixtop_vars.ebSendingTimerId,
+                sixtop_vars.ebTrickleRemaining,
+                TIME_MS,
+                TIMER_ONESHOT,
+                sixtop_sendingEb_timer_cb
+        );
+    }
+#else
     if (openrandom_get16b() < (0xffff / EB_PORTION)) {
         sixtop_sendEB();
     }
+#endif
+}
+
+#if SIXTOP_EB_TRICKLE
+/**
+\brief Start a Trickle interval: the EB is due at a random time in its second half.
+*/
+void sixtop_startEbTrickleInterval(void) {
+    uint32_t ebTime;
+
+    ebTime = sixtop_vars.ebTrickleInterval / 2;
+    ebTime += (ebTime * openrandom_get16b()) >> 16;
+
+    sixtop_vars.ebTrickleRemaining = sixtop_vars.ebTrickleInterval - ebTime;
+    sixtop_vars.ebTrickleIsIntervalEnd = FALSE;
+    sixtop_vars.ebTrickleCounter = 0;
+    opentimers_scheduleIn(
+            sixtop_vars.ebSendingTimerId,
+            ebTime,
+            TIME_MS,
+            TIMER_ONESHOT,
+            sixtop_sendingEb_timer_cb
+    );
 }
+#endif
 
 /**
 \brief Timer handlers which triggers MAC management task.
@@ -686,6 +823,20 @@ void timer_sixtop_management_fired(void) {
     }
 }
 
+/**
+\brief Tell whether this mote advertises the network.
+
+Before it starts advertising the network, a mote must be synchronized, have
+joined, have acquired a DAGrank and have sent out a DAO, so that it is
+reachable downwards.
+*/
+bool sixtop_isReadyToSendEB(void) {
+    return ieee154e_isSynch() == TRUE &&
+           IEEE802154_security_isConfigured() == TRUE &&
+           icmpv6rpl_getMyDAGrank() != DEFAULTDAGRANK &&
+           icmpv6rpl_daoSent() == TRUE;
+}
+
 /**
 \brief Send an EB.
 
@@ -702,11 +853,7 @@ port_INLINE void sixtop_sendEB(void) {
 
     memset(&addressToWrite, 0, sizeof(open_addr_t));
 
-    if (
-            (ieee154e_isSynch() == FALSE) ||
-            (IEEE802154_security_isConfigured() == FALSE) ||
-            (icmpv6rpl_getMyDAGrank() == DEFAULTDAGRANK) ||
-            icmpv6rpl_daoSent() == FALSE) {
+    if (sixtop_isReadyToSendEB() == FALSE) {
         // I'm not sync'ed, or did not join, or did not acquire a DAGrank or did not send out a DAO
         // before starting to advertize the network, we need to make sure that we are reachable downwards,
         // thus, the condition if DAO was sent
@@ -843,7 +990,7 @@ port_INLINE void sixtop_sendKA(void) {
     // if I get here, I will send a KA
 
     // get a free packet buffer
-    kaPkt = openqueue_getFreePacketBuffer(COMPONENT_SIXTOP);
+    kaPkt = openqueue_getFreeSmallPacketBuffer(COMPONENT_SIXTOP);
     if (kaPkt == NULL) {
         LOG_ERROR(COMPONENT_SIXTOP, ERR_NO_FREE_PACKET_BUFFER, (errorparameter_t) 1, (errorparameter_t) 0);
         return;
@@ -877,70 +1024,168 @@ port_INLINE void sixtop_sendKA(void) {
 //======= six2six task
 
 void timer_sixtop_six2six_timeout_fired(void) {
+    uint8_t i;
+
+    for (i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+        // only the transactions waiting for a response time out
+        if (
+                sixtop_vars.transactions[i].state < SIX_STATE_WAIT_ADDRESPONSE ||
+                ieee154e_asnDiff(&sixtop_vars.transactions[i].asn) < SIX2SIX_TIMEOUT_SLOTS - 1
+                ) {
+            continue;
+        }
+        if (sixtop_vars.transactions[i].state == SIX_STATE_WAIT_CLEARRESPONSE) {
+            // no response for the 6p clear, just clear locally
+            schedule_removeAllNegotiatedCellsToNeighbor(
+                    sixtop_vars.cb_sf_getMetadata(),
+                    &sixtop_vars.transactions[i].neighbor
+            );
+            neighbors_resetSequenceNumber(&sixtop_vars.transactions[i].neighbor);
+        }
+        // the transaction with this neighbor is over
+        memset(&sixtop_vars.transactions[i], 0, sizeof(sixtop_transaction_t));
+    }
+    sixtop_scheduleTimeout();
+}
+
+/**
+\brief Get the ongoing 6P transaction with a neighbor.
+
+\param[in] neighbor The neighbor the transaction is with.
+
+\returns The transaction, NULL if there is none with that neighbor.
+*/
+sixtop_transaction_t* sixtop_getTransaction(open_addr_t *neighbor) {
+    uint8_t i;
 
-    if (sixtop_vars.six2six_state == SIX_STATE_WAIT_CLEARRESPONSE) {
-        // no response for the 6p clear, just clear locally
-        schedule_removeAllNegotiatedCellsToNeighbor(sixtop_vars.cb_sf_getMetadata(), &sixtop_vars.neighborToClearCells);
-        neighbors_resetSequenceNumber(&sixtop_vars.neighborToClearCells);
-        memset(&sixtop_vars.neighborToClearCells, 0, sizeof(open_addr_t));
+    for (i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+        if (
+                sixtop_vars.transactions[i].state != SIX_STATE_IDLE &&
+                packetfunctions_sameAddress(neighbor, &sixtop_vars.transactions[i].neighbor)
+                ) {
+            return &sixtop_vars.transactions[i];
+        }
+    }
+    return NULL;
+}
+
+sixtop_transaction_t* sixtop_getFreeTransaction(void) {
+    uint8_t i;
+
+    for (i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+        if (sixtop_vars.transactions[i].state == SIX_STATE_IDLE) {
+            return &sixtop_vars.transactions[i];
+        }
     }
-    // timeout timer fired, reset the state of sixtop to idle
-    sixtop_vars.six2six_state = SIX_STATE_IDLE;
-    opentimers_cancel(sixtop_vars.timeoutTimerId);
+    return NULL;
+}
+
+void sixtop_endTransaction(sixtop_transaction_t *transaction) {
+
+    memset(transaction, 0, sizeof(sixtop_transaction_t));
+    sixtop_scheduleTimeout();
+}
+
+/**
+\brief Arm the timeout timer for the transaction waiting the longest for a response.
+
+All the transactions have the same timeout, so the one whose request was sent
+first expires first. The timer is cancelled when no transaction is waiting.
+*/
+void sixtop_scheduleTimeout(void) {
+    uint8_t i;
+    PORT_TIMER_WIDTH elapsed;
+    PORT_TIMER_WIDTH maxElapsed;
+    bool isWaiting;
+
+    isWaiting = FALSE;
+    maxElapsed = 0;
+    for (i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+        if (sixtop_vars.transactions[i].state < SIX_STATE_WAIT_ADDRESPONSE) {
+            continue;
+        }
+        elapsed = ieee154e_asnDiff(&sixtop_vars.transactions[i].asn);
+        if (isWaiting == FALSE || elapsed > maxElapsed) {
+            maxElapsed = elapsed;
+            isWaiting = TRUE;
+        }
+    }
+
+    if (isWaiting == FALSE) {
+        opentimers_cancel(sixtop_vars.timeoutTimerId);
+        return;
+    }
+
+    if (maxElapsed >= SIX2SIX_TIMEOUT_SLOTS - 1) {
+        // overdue already, e.g. after a resynchronization
+        maxElapsed = SIX2SIX_TIMEOUT_SLOTS - 1;
+    }
+    opentimers_scheduleIn(
+            sixtop_vars.timeoutTimerId,
+            (SIX2SIX_TIMEOUT_SLOTS - maxElapsed) * SLOTDURATION,
+            TIME_MS,
+            TIMER_ONESHOT,
+            sixtop_timeout_timer_cb
+    );
 }
 
 void sixtop_six2six_sendDone(OpenQueueEntry_t *msg, owerror_t error) {
+    sixtop_transaction_t *transaction;
 
     msg->owner = COMPONENT_SIXTOP_RES;
 
     // if this is a request send done
+    transaction = NULL;
     if (msg->l2_sixtop_messageType == SIXTOP_CELL_REQUEST) {
+        transaction = sixtop_getTransaction(&(msg->l2_nextORpreviousHop));
+    }
+    if (transaction != NULL) {
         if (error == E_FAIL) {
             // max retries, without ack
-            switch (sixtop_vars.six2six_state) {
+            switch (transaction->state) {
 
                 case SIX_STATE_WAIT_CLEARREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_CLEARRESPONSE;
-                    timer_sixtop_six2six_timeout_fired();
+                    // no response will come for the 6p clear, just clear locally
+                    schedule_removeAllNegotiatedCellsToNeighbor(
+                            sixtop_vars.cb_sf_getMetadata(),
+                            &transaction->neighbor
+                    );
+                    neighbors_resetSequenceNumber(&transaction->neighbor);
+                    sixtop_endTransaction(transaction);
                     break;
                 default:
                     // reset handler and state if the request is failed to send out
-                    sixtop_vars.six2six_state = SIX_STATE_IDLE;
+                    sixtop_endTransaction(transaction);
                     break;
             }
         } else {
             // the packet has been sent out successfully
-            switch (sixtop_vars.six2six_state) {
+            switch (transaction->state) {
                 case SIX_STATE_WAIT_ADDREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_ADDRESPONSE;
+                    transaction->state = SIX_STATE_WAIT_ADDRESPONSE;
                     break;
                 case SIX_STATE_WAIT_DELETEREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_DELETERESPONSE;
+                    transaction->state = SIX_STATE_WAIT_DELETERESPONSE;
                     break;
                 case SIX_STATE_WAIT_RELOCATEREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_RELOCATERESPONSE;
+                    transaction->state = SIX_STATE_WAIT_RELOCATERESPONSE;
                     break;
                 case SIX_STATE_WAIT_LISTREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_LISTRESPONSE;
+                    transaction->state = SIX_STATE_WAIT_LISTRESPONSE;
                     break;
                 case SIX_STATE_WAIT_COUNTREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_COUNTRESPONSE;
+                    transaction->state = SIX_STATE_WAIT_COUNTRESPONSE;
                     break;
                 case SIX_STATE_WAIT_CLEARREQUEST_SENDDONE:
-                    sixtop_vars.six2six_state = SIX_STATE_WAIT_CLEARRESPONSE;
+                    transaction->state = SIX_STATE_WAIT_CLEARRESPONSE;
                     break;
                 default:
                     // should never happen
                     break;
             }
-            // start timeout timer if I am waiting for a response
-            opentimers_scheduleIn(
-                    sixtop_vars.timeoutTimerId,
-                    SIX2SIX_TIMEOUT_MS,
-                    TIME_MS,
-                    TIMER_ONESHOT,
-                    sixtop_timeout_timer_cb
-            );
+            // start the timeout of the transaction, the timer runs for the oldest one
+            memcpy(&transaction->asn, &msg->l2_asn, sizeof(asn_t));
+            sixtop_scheduleTimeout();
         }
     }
 
@@ -950,34 +1195,36 @@ void sixtop_six2six_sendDone(OpenQueueEntry_t *msg, owerror_t error) {
             neighbors_updateSequenceNumber(&(msg->l2_nextORpreviousHop));
             // in case a response is sent out, check the return code
             if (msg->l2_sixtop_returnCode == IANA_6TOP_RC_SUCCESS) {
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_ADD) {
+                // the cell lists are in the metadata, a response without it grants no cell
+                if (msg->l2_sixtop_command == IANA_6TOP_CMD_ADD && msg->metadata != NULL) {
                     sixtop_addCells(
                             msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_add,
+                            msg->metadata->l2_sixtop_celllist_add,
                             &(msg->l2_nextORpreviousHop),
                             msg->l2_sixtop_cellOptions
                     );
+                    msf_indicateCellsGranted(&(msg->l2_nextORpreviousHop), msg->l2_sixtop_cellOptions);
                 }
 
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_DELETE) {
+                if (msg->l2_sixtop_command == IANA_6TOP_CMD_DELETE && msg->metadata != NULL) {
                     sixtop_removeCells(
                             msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_delete,
+                            msg->metadata->l2_sixtop_celllist_delete,
                             &(msg->l2_nextORpreviousHop),
                             msg->l2_sixtop_cellOptions
                     );
                 }
 
-                if (msg->l2_sixtop_command == IANA_6TOP_CMD_RELOCATE) {
+                if (msg->l2_sixtop_command == IANA_6TOP_CMD_RELOCATE && msg->metadata != NULL) {
                     sixtop_removeCells(
                             msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_delete,
+                            msg->metadata->l2_sixtop_celllist_delete,
                             &(msg->l2_nextORpreviousHop),
                             msg->l2_sixtop_cellOptions
                     );
                     sixtop_addCells(
                             msg->l2_sixtop_frameID,
-                            msg->l2_sixtop_celllist_add,
+                            msg->metadata->l2_sixtop_celllist_add,
                             &(msg->l2_nextORpreviousHop),
                             msg->l2_sixtop_cellOptions
                     );
@@ -1101,12 +1348,17 @@ void sixtop_six2six_notifyReceive(
     uint8_t pktLen = length;
     uint8_t response_pktLen = 0;
     cellInfo_ht celllist_list[CELLLIST_MAX_LEN];
+    sixtop_transaction_t *transaction;
+    six2six_state_t state;
 
     if (type == SIXTOP_CELL_REQUEST) {
         // if this is a 6p request message
 
         // drop the packet if there are too many 6P response in the queue
-        if (openqueue_getNum6PResp() >= MAX6PRESPONSE) {
+        if (
+                openqueue_getNum6PResp(NULL) >= SIXTOP_MAX_TRANSACTIONS ||
+                openqueue_getNum6PResp(&(pkt->l2_nextORpreviousHop)) >= MAX6PRESPONSE
+                ) {
             return;
         }
 
@@ -1140,8 +1392,8 @@ void sixtop_six2six_notifyReceive(
                 returnCode = IANA_6TOP_RC_SEQNUM_ERR;
                 break;
             }
-            // previous 6p transcation check
-            if (sixtop_vars.six2six_state != SIX_STATE_IDLE) {
+            // previous 6p transcation check, with the same neighbor
+            if (sixtop_getTransaction(&(pkt->l2_nextORpreviousHop)) != NULL) {
                 returnCode = IANA_6TOP_RC_RESET;
                 break;
             }
@@ -1237,7 +1489,7 @@ void sixtop_six2six_notifyReceive(
                 } else {
                     cellOptions_transformed = cellOptions;
                 }
-                for (i = 0; i < schedule_getFrameLength(); i++) {
+                for (i = 0; i < schedule_getSlotframeLength(metadata); i++) {
                     if (
                             schedule_getOneCellAfterOffset(
                                     metadata,
@@ -1264,6 +1516,13 @@ void sixtop_six2six_notifyReceive(
             ptr += 1;
             pktLen -= 1;
 
+            // the cell lists are kept with the response until it is sent
+            if (openqueue_attachMetadata(response_pkt) == NULL) {
+                LOG_ERROR(COMPONENT_SIXTOP, ERR_NO_FREE_PACKET_BUFFER, (errorparameter_t) 2, (errorparameter_t) 0);
+                returnCode = IANA_6TOP_RC_BUSY;
+                break;
+            }
+
             // add command
             if (code == IANA_6TOP_CMD_ADD) {
                 if (schedule_getNumberOfFreeEntries() < numCells) {
@@ -1272,31 +1531,31 @@ void sixtop_six2six_notifyReceive(
                 }
                 // retrieve cell list
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_add, 0, sizeof(response_pkt->l2_sixtop_celllist_add));
+                memset(response_pkt->metadata->l2_sixtop_celllist_add, 0, sizeof(response_pkt->metadata->l2_sixtop_celllist_add));
                 while (pktLen > 0) {
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     i++;
                 }
-                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->l2_sixtop_celllist_add)) {
+                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->metadata->l2_sixtop_celllist_add)) {
                     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-                        if (response_pkt->l2_sixtop_celllist_add[i].isUsed) {
+                        if (response_pkt->metadata->l2_sixtop_celllist_add[i].isUsed) {
                             packetfunctions_reserveHeader(&response_pkt, 4);
                             response_pkt->payload[0] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0x00FF);
+                                    response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset & 0x00FF);
                             response_pkt->payload[1] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0xFF00) >> 8);
+                                    (response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset & 0xFF00) >> 8);
                             response_pkt->payload[2] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0x00FF);
+                                    response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset & 0x00FF);
                             response_pkt->payload[3] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0xFF00) >> 8);
+                                    (response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset & 0xFF00) >> 8);
                             response_pktLen += 4;
                         }
                     }
@@ -1308,15 +1567,15 @@ void sixtop_six2six_notifyReceive(
             // delete command
             if (code == IANA_6TOP_CMD_DELETE) {
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_delete, 0, sizeof(response_pkt->l2_sixtop_celllist_delete));
+                memset(response_pkt->metadata->l2_sixtop_celllist_delete, 0, sizeof(response_pkt->metadata->l2_sixtop_celllist_delete));
                 while (pktLen > 0) {
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].isUsed = TRUE;
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     i++;
@@ -1326,20 +1585,20 @@ void sixtop_six2six_notifyReceive(
                 } else {
                     cellOptions_transformed = cellOptions;
                 }
-                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->l2_sixtop_celllist_delete,
+                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->metadata->l2_sixtop_celllist_delete,
                                                         &(pkt->l2_nextORpreviousHop), cellOptions_transformed)) {
                     returnCode = IANA_6TOP_RC_SUCCESS;
                     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-                        if (response_pkt->l2_sixtop_celllist_delete[i].isUsed) {
+                        if (response_pkt->metadata->l2_sixtop_celllist_delete[i].isUsed) {
                             packetfunctions_reserveHeader(&response_pkt, 4);
                             response_pkt->payload[0] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset & 0x00FF);
+                                    response_pkt->metadata->l2_sixtop_celllist_delete[i].slotoffset & 0x00FF);
                             response_pkt->payload[1] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_delete[i].slotoffset & 0xFF00) >> 8);
+                                    (response_pkt->metadata->l2_sixtop_celllist_delete[i].slotoffset & 0xFF00) >> 8);
                             response_pkt->payload[2] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset & 0x00FF);
+                                    response_pkt->metadata->l2_sixtop_celllist_delete[i].channeloffset & 0x00FF);
                             response_pkt->payload[3] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_delete[i].channeloffset & 0xFF00) >> 8);
+                                    (response_pkt->metadata->l2_sixtop_celllist_delete[i].channeloffset & 0xFF00) >> 8);
                             response_pktLen += 4;
                         }
                     }
@@ -1353,16 +1612,16 @@ void sixtop_six2six_notifyReceive(
             if (code == IANA_6TOP_CMD_RELOCATE) {
                 // retrieve cell list to be relocated
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_delete, 0, sizeof(response_pkt->l2_sixtop_celllist_delete));
+                memset(response_pkt->metadata->l2_sixtop_celllist_delete, 0, sizeof(response_pkt->metadata->l2_sixtop_celllist_delete));
                 temp16 = numCells;
                 while (temp16 > 0) {
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_delete[i].slotoffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_delete[i].channeloffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_delete[i].isUsed = TRUE;
+                    response_pkt->metadata->l2_sixtop_celllist_delete[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     temp16--;
@@ -1373,7 +1632,7 @@ void sixtop_six2six_notifyReceive(
                 } else {
                     cellOptions_transformed = cellOptions;
                 }
-                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->l2_sixtop_celllist_delete,
+                if (sixtop_areAvailableCellsToBeRemoved(metadata, numCells, response_pkt->metadata->l2_sixtop_celllist_delete,
                                                         &(pkt->l2_nextORpreviousHop), cellOptions_transformed) ==
                     FALSE) {
                     returnCode = IANA_6TOP_RC_CELLLIST_ERR;
@@ -1381,31 +1640,31 @@ void sixtop_six2six_notifyReceive(
                 }
                 // retrieve cell list to be relocated
                 i = 0;
-                memset(response_pkt->l2_sixtop_celllist_add, 0, sizeof(response_pkt->l2_sixtop_celllist_add));
+                memset(response_pkt->metadata->l2_sixtop_celllist_add, 0, sizeof(response_pkt->metadata->l2_sixtop_celllist_add));
                 while (pktLen > 0) {
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                    response_pkt->l2_sixtop_celllist_add[i].slotoffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                    response_pkt->l2_sixtop_celllist_add[i].channeloffset |=
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset |=
                             (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                    response_pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                    response_pkt->metadata->l2_sixtop_celllist_add[i].isUsed = TRUE;
                     ptr += 4;
                     pktLen -= 4;
                     i++;
                 }
-                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->l2_sixtop_celllist_add)) {
+                if (sixtop_areAvailableCellsToBeScheduled(metadata, numCells, response_pkt->metadata->l2_sixtop_celllist_add)) {
                     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
-                        if (response_pkt->l2_sixtop_celllist_add[i].isUsed) {
+                        if (response_pkt->metadata->l2_sixtop_celllist_add[i].isUsed) {
                             packetfunctions_reserveHeader(&response_pkt, 4);
                             response_pkt->payload[0] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0x00FF);
+                                    response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset & 0x00FF);
                             response_pkt->payload[1] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].slotoffset & 0xFF00) >> 8);
+                                    (response_pkt->metadata->l2_sixtop_celllist_add[i].slotoffset & 0xFF00) >> 8);
                             response_pkt->payload[2] = (uint8_t)(
-                                    response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0x00FF);
+                                    response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset & 0x00FF);
                             response_pkt->payload[3] = (uint8_t)(
-                                    (response_pkt->l2_sixtop_celllist_add[i].channeloffset & 0xFF00) >> 8);
+                                    (response_pkt->metadata->l2_sixtop_celllist_add[i].channeloffset & 0xFF00) >> 8);
                             response_pktLen += 4;
                         }
                     }
@@ -1469,76 +1728,84 @@ void sixtop_six2six_notifyReceive(
     if (type == SIXTOP_CELL_RESPONSE) {
         // this is a 6p response message
 
+        // the response belongs to the transaction with its sender
+        transaction = sixtop_getTransaction(&(pkt->l2_nextORpreviousHop));
+        if (transaction != NULL) {
+            state = transaction->state;
+        } else {
+            state = SIX_STATE_IDLE;
+        }
+
         // if the code is SUCCESS
         if (code == IANA_6TOP_RC_SUCCESS || code == IANA_6TOP_RC_EOL) {
-            switch (sixtop_vars.six2six_state) {
+            switch (state) {
                 case SIX_STATE_WAIT_ADDRESPONSE:
                     i = 0;
-                    memset(pkt->l2_sixtop_celllist_add, 0, sizeof(pkt->l2_sixtop_celllist_add));
+                    memset(celllist_list, 0, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
                     while (pktLen > 0) {
-                        pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                        pkt->l2_sixtop_celllist_add[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                        pkt->l2_sixtop_celllist_add[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                        celllist_list[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                        celllist_list[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
+                        celllist_list[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                        celllist_list[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
+                        celllist_list[i].isUsed = TRUE;
                         ptr += 4;
                         pktLen -= 4;
                         i++;
                     }
                     sixtop_addCells(
                             sixtop_vars.cb_sf_getMetadata(),     // frame id
-                            pkt->l2_sixtop_celllist_add,  // celllist to be added
+                            celllist_list,                // celllist to be added
                             &(pkt->l2_nextORpreviousHop), // neighbor that cells to be added to
-                            sixtop_vars.cellOptions       // cell options
+                            transaction->cellOptions      // cell options
                     );
                     neighbors_updateSequenceNumber(&(pkt->l2_nextORpreviousHop));
                     break;
                 case SIX_STATE_WAIT_DELETERESPONSE:
                     i = 0;
-                    memset(pkt->l2_sixtop_celllist_delete, 0, sizeof(pkt->l2_sixtop_celllist_delete));
+                    memset(celllist_list, 0, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
                     while (pktLen > 0) {
-                        pkt->l2_sixtop_celllist_delete[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                        pkt->l2_sixtop_celllist_delete[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                        pkt->l2_sixtop_celllist_delete[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                        pkt->l2_sixtop_celllist_delete[i].channeloffset |=
+                        celllist_list[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                        celllist_list[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
+                        celllist_list[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                        celllist_list[i].channeloffset |=
                                 (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                        pkt->l2_sixtop_celllist_delete[i].isUsed = TRUE;
+                        celllist_list[i].isUsed = TRUE;
                         ptr += 4;
                         pktLen -= 4;
                         i++;
                     }
                     sixtop_removeCells(
                             sixtop_vars.cb_sf_getMetadata(),
-                            pkt->l2_sixtop_celllist_delete,
+                            celllist_list,
                             &(pkt->l2_nextORpreviousHop),
-                            sixtop_vars.cellOptions
+                            transaction->cellOptions
                     );
                     neighbors_updateSequenceNumber(&(pkt->l2_nextORpreviousHop));
                     break;
                 case SIX_STATE_WAIT_RELOCATERESPONSE:
                     i = 0;
-                    memset(pkt->l2_sixtop_celllist_add, 0, sizeof(pkt->l2_sixtop_celllist_add));
+                    memset(celllist_list, 0, CELLLIST_MAX_LEN * sizeof(cellInfo_ht));
                     while (pktLen > 0) {
-                        pkt->l2_sixtop_celllist_add[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
-                        pkt->l2_sixtop_celllist_add[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
-                        pkt->l2_sixtop_celllist_add[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
-                        pkt->l2_sixtop_celllist_add[i].isUsed = TRUE;
+                        celllist_list[i].slotoffset = *((uint8_t * )(pkt->payload) + ptr);
+                        celllist_list[i].slotoffset |= (*((uint8_t * )(pkt->payload) + ptr + 1)) << 8;
+                        celllist_list[i].channeloffset = *((uint8_t * )(pkt->payload) + ptr + 2);
+                        celllist_list[i].channeloffset |= (*((uint8_t * )(pkt->payload) + ptr + 3)) << 8;
+                        celllist_list[i].isUsed = TRUE;
                         ptr += 4;
                         pktLen -= 4;
                         i++;
                     }
                     sixtop_removeCells(
                             sixtop_vars.cb_sf_getMetadata(),
-                            sixtop_vars.celllist_toDelete,
+                            transaction->celllist_toDelete,
                             &(pkt->l2_nextORpreviousHop),
-                            sixtop_vars.cellOptions
+                            transaction->cellOptions
                     );
                     sixtop_addCells(
                             sixtop_vars.cb_sf_getMetadata(),     // frame id
-                            pkt->l2_sixtop_celllist_add,  // celllist to be added
+                            celllist_list,                // celllist to be added
                             &(pkt->l2_nextORpreviousHop), // neighbor that cells to be added to
-                            sixtop_vars.cellOptions       // cell options
+                            transaction->cellOptions      // cell options
                     );
                     neighbors_updateSequenceNumber(&(pkt->l2_nextORpreviousHop));
                     break;
@@ -1548,7 +1815,7 @@ void sixtop_six2six_notifyReceive(
                     ptr += 2;
                     LOG_INFO(COMPONENT_SIXTOP, ERR_SIXTOP_COUNT,
                              (errorparameter_t) numCells,
-                             (errorparameter_t) sixtop_vars.six2six_state);
+                             (errorparameter_t) state);
                     neighbors_updateSequenceNumber(&(pkt->l2_nextORpreviousHop));
                     break;
                 case SIX_STATE_WAIT_LISTRESPONSE:
@@ -1591,20 +1858,20 @@ void sixtop_six2six_notifyReceive(
                         (errorparameter_t)
             code,
                     (errorparameter_t)
-            sixtop_vars.six2six_state);
+            state);
         } else if (code == IANA_6TOP_RC_EOL || code == IANA_6TOP_RC_BUSY || code == IANA_6TOP_RC_LOCKED) {
             LOG_INFO(COMPONENT_SIXTOP, ERR_SIXTOP_RETURNCODE,
                     (errorparameter_t) code,
-                    (errorparameter_t) sixtop_vars.six2six_state);
+                    (errorparameter_t) state);
         } else {
             LOG_ERROR(COMPONENT_SIXTOP, ERR_SIXTOP_RETURNCODE,
                     (errorparameter_t) code,
-                    (errorparameter_t) sixtop_vars.six2six_state);
+                    (errorparameter_t) state);
         }
 
-        memset(&sixtop_vars.neighborToClearCells, 0, sizeof(open_addr_t));
-        sixtop_vars.six2six_state = SIX_STATE_IDLE;
-        opentimers_cancel(sixtop_vars.timeoutTimerId);
+        if (transaction != NULL) {
+            sixtop_endTransaction(transaction);
+        }
     }
 }
 
@@ -1643,8 +1910,8 @@ bool sixtop_addCells(
     for (i = 0; i < CELLLIST_MAX_LEN; i++) {
         if (cellList[i].isUsed) {
             hasCellsAdded = TRUE;
-            schedule_addActiveSlot(cellList[i].slotoffset, type, isShared, FALSE, cellList[i].channeloffset,
-                                   &temp_neighbor);
+            schedule_addActiveSlot(slotframeID, cellList[i].slotoffset, type, isShared, FALSE,
+                                   cellList[i].channeloffset, &temp_neighbor);
         }
     }
     return hasCellsAdded;
@@ -1684,6 +1951,7 @@ bool sixtop_removeCells(
         if (cellList[i].isUsed) {
             hasCellsRemoved = TRUE;
             schedule_removeActiveSlot(
+                    slotframeID,
                     cellList[i].slotoffset,
                     type,
                     isShared,
@@ -1714,7 +1982,13 @@ bool sixtop_areAvailableCellsToBeScheduled(
         available = FALSE;
     } else {
         do {
-            if (schedule_isSlotOffsetAvailable(cellList[i].slotoffset) == TRUE) {
+            // a cell granted in a queued response is only scheduled once that response is sent,
+            // a cell offered in an ongoing request once its response is received
+            if (
+                    schedule_isSlotOffsetAvailable(frameID, cellList[i].slotoffset) == TRUE &&
+                    openqueue_is6PRespCell(frameID, cellList[i].slotoffset) == FALSE &&
+                    sixtop_isCellPending(cellList[i].slotoffset) == FALSE
+                    ) {
                 numbOfavailableCells++;
             } else {
                 // mark the cell
@@ -1778,9 +2052,9 @@ bool sixtop_areAvailableCellsToBeRemoved(
             if (cellList[i].isUsed) {
                 memset(&info, 0, sizeof(slotinfo_element_t));
                 if (type == CELLTYPE_TXRX) {
-                    schedule_getSlotInfo(cellList[i].slotoffset, &info);
+                    schedule_getSlotInfo(frameID, cellList[i].slotoffset, &info);
                 } else {
-                    schedule_getSlotInfo(cellList[i].slotoffset, &info);
+                    schedule_getSlotInfo(frameID, cellList[i].slotoffset, &info);
                 }
                 if (info.link_type != type) {
                     available = FALSE;
@@ -85,6 +85,15 @@ typedef enum {
 #define SIX2SIX_TIMEOUT_MS      65535
 #endif
 
+typedef struct {
+    open_addr_t neighbor;                           // the neighbor the transaction is with
+    six2six_state_t state;                          // SIX_STATE_IDLE when the entry is free
+    uint8_t cellOptions;
+    cellInfo_ht celllist_toAdd[CELLLIST_MAX_LEN];     // cells offered, not to be offered to another neighbor
+    cellInfo_ht celllist_toDelete[CELLLIST_MAX_LEN];
+    asn_t asn;                                      // when the request was sent
+} sixtop_transaction_t;
+
 typedef uint8_t                 (*sixtop_sf_getsfid_cbt)(void);
 
 typedef uint16_t                (*sixtop_sf_getmetadata_cbt)(void);
@@ -95,6 +104,17 @@ typedef void (*sixtop_sf_handle_callback_cbt)(uint8_t arg, open_addr_t *address)
 
 #define SIXTOP_MINIMAL_EBPERIOD     5 // minist period of sending EB
 
+// Trickle timer of the EBs, see SIXTOP_EB_TRICKLE
+#ifndef SIXTOP_EB_IMIN
+#define SIXTOP_EB_IMIN              (2 * SLOTFRAME_LENGTH * SLOTDURATION) // in ms
+#endif
+#ifndef SIXTOP_EB_IMAX_DOUBLINGS
+#define SIXTOP_EB_IMAX_DOUBLINGS    4
+#endif
+#ifndef SIXTOP_EB_REDUNDANCY
+#define SIXTOP_EB_REDUNDANCY        3
+#endif
+
 //=========================== module variables ================================
 
 typedef struct {
@@ -105,18 +125,20 @@ typedef struct {
     uint8_t mgtTaskCounter;                         // counter to determine what management task to do
     uint8_t ebCounter;                              // counter to determine when to send EB
     opentimers_id_t ebSendingTimerId;               // EB sending timer id
+#if SIXTOP_EB_TRICKLE
+    uint32_t ebTrickleInterval;                     // current Trickle interval, in ms
+    uint32_t ebTrickleRemaining;                    // time from the EB to the end of the interval, in ms
+    bool ebTrickleIsIntervalEnd;                    // TRUE iff the EB timer is set to the end of the interval
+    uint8_t ebTrickleCounter;                       // number of EBs heard during the interval
+#endif
     opentimers_id_t maintenanceTimerId;
-    opentimers_id_t timeoutTimerId;                 // TimeOut timer id
+    opentimers_id_t timeoutTimerId;                 // TimeOut timer id, shared by the transactions
     uint16_t kaPeriod;                              // period of sending KA
-    six2six_state_t six2six_state;
-    uint8_t commandID;
-    uint8_t cellOptions;
-    cellInfo_ht celllist_toDelete[CELLLIST_MAX_LEN];
+    sixtop_transaction_t transactions[SIXTOP_MAX_TRANSACTIONS]; // 6P transactions as the requester
     sixtop_sf_getsfid_cbt cb_sf_getsfid;
     sixtop_sf_getmetadata_cbt cb_sf_getMetadata;
     sixtop_sf_translatemetadata_cbt cb_sf_translateMetadata;
     sixtop_sf_handle_callback_cbt cb_sf_handleRCError;
-    open_addr_t neighborToClearCells;
 } sixtop_vars_t;
 
 //=========================== prototypes ======================================
@@ -144,9 +166,13 @@ owerror_t sixtop_request(
         uint16_t listingMaxNumCells
 );
 
+bool sixtop_isCellPending(uint16_t slotoffset);
+
 // from upper layer
 owerror_t sixtop_send(OpenQueueEntry_t *msg);
 
+void sixtop_resetEbTrickle(void);
+
 // from lower layer
 void task_sixtopNotifSendDone(void);
 
@@ -1098,7 +1098,7 @@ owerror_t iphc_prependIPv6DeadlineHeader(OpenQueueEntry_t **msg) {
         asn_len = iphc_getAsnLen(asn_array);
 
         if (packetfunctions_reserveHeader(msg, asn_len) == E_FAIL) {
-            return E_FAIL
+            return E_FAIL;
         }
         memcpy(&((*msg)->payload[0]), &asn_array, asn_len * sizeof(uint8_t));
         temp_len += asn_len;
@@ -1264,6 +1264,10 @@ void iphc_retrieveIPv6DeadlineHeader(
         }
         ieee154e_orderToASNStructure(deadline_option->et_val, &exp_asn);
 
+        // kept with the packet, openqueue drops it first once expired
+        memcpy(&(msg->l3_deadlineAsn), &exp_asn, sizeof(asn_t));
+        msg->drop_flag = (deadline_option->d_flag == 1);
+
         // Calculate delay experienced by packet
         ieee154e_getAsn(my_asn_array);
         ieee154e_orderToASNStructure(my_asn_array, &my_asn);
@@ -350,9 +350,9 @@ void forwarding_receive(
        }
 #endif
 
-        if (openqueue_isHighPriorityEntryEnough() == FALSE) {
+        if (openqueue_admitRelayedPacket(msg) == FALSE) {
             // after change the creator to COMPONENT_FORWARDING, there is no space for high priority packet,
-            // drop this message by free the buffer.
+            // and queue management could not make room for it: drop this message by free the buffer.
             LOG_WARNING(COMPONENT_FORWARDING, ERR_FORWARDING_PACKET_DROPPED, (errorparameter_t) 0,
                         (errorparameter_t) 0);
             openqueue_freePacketBuffer(msg);
@@ -13,6 +13,7 @@
 #include "IEEE802154_security.h"
 #include "schedule.h"
 #include "msf.h"
+#include "sixtop.h"
 
 //=========================== definition ======================================
 
@@ -39,6 +40,13 @@ void icmpv6rpl_timer_DAO_task(void);
 
 void sendDAO(void);
 
+// parent selection
+dagrank_t icmpv6rpl_computeCandidateRank(uint8_t index);
+
+void icmpv6rpl_findBestCandidate(void);
+
+void icmpv6rpl_selectParent(void);
+
 //=========================== public ==========================================
 
 /**
@@ -47,6 +55,7 @@ void sendDAO(void);
 void icmpv6rpl_init(void) {
 
     uint8_t dodagid[16];
+    uint8_t i;
 
     // retrieve my prefix and EUI64
     memcpy(&dodagid[0], idmanager_getMyID(ADDR_PREFIX)->prefix, 8); // prefix
@@ -57,6 +66,9 @@ void icmpv6rpl_init(void) {
 
     //=== routing
     icmpv6rpl_vars.haveParent = FALSE;
+    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
+        icmpv6rpl_vars.candidateRank[i] = MAXDAGRANK;
+    }
     icmpv6rpl_vars.daoSent = FALSE;
 
     if (idmanager_getIsDAGroot() == TRUE) {
@@ -95,6 +107,7 @@ void icmpv6rpl_init(void) {
 
     icmpv6rpl_vars.dioPeriod = DIO_PERIOD;
     icmpv6rpl_vars.timerIdDIO = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_RPL);
+    opentimers_setTolerance(icmpv6rpl_vars.timerIdDIO, OPENTIMERS_TOLERANCE_MS, TIME_MS);
 
     //initialize PIO -> move this to dagroot code
     icmpv6rpl_vars.pio.type = RPL_OPTION_PIO;
@@ -176,6 +189,7 @@ void icmpv6rpl_init(void) {
 
     icmpv6rpl_vars.daoPeriod = DAO_PERIOD;
     icmpv6rpl_vars.timerIdDAO = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_RPL);
+    opentimers_setTolerance(icmpv6rpl_vars.timerIdDAO, OPENTIMERS_TOLERANCE_MS, TIME_MS);
     opentimers_scheduleIn(
             icmpv6rpl_vars.timerIdDAO,
             SLOTFRAME_LENGTH * SLOTDURATION,
@@ -351,11 +365,80 @@ dagrank_t icmpv6rpl_getMyDAGrank(void) {
 }
 
 /**
-\brief Routing algorithm
+\brief Routing algorithm, re-evaluating every neighbor as candidate parent.
+
+The path cost through each neighbor is kept in candidateRank, so that a
+change to a single neighbor only requires icmpv6rpl_indicateNeighborUpdate().
+This full recompute is for events which affect all neighbors at once, e.g. a
+change of DAG root role.
 */
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void) {
     uint8_t i;
+
+    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
+        icmpv6rpl_vars.candidateRank[i] = icmpv6rpl_computeCandidateRank(i);
+    }
+    icmpv6rpl_findBestCandidate();
+
+    icmpv6rpl_selectParent();
+}
+
+/**
+\brief Refresh my rank through a single neighbor, without running the routing algorithm.
+
+To be called when something the rank through that neighbor depends on changed,
+i.e. its rank, its link metric, its stability or its NORES flag, or when it was
+removed from the neighbor table.
+
+\param[in] index The index of the neighbor in the neighbor table.
+*/
+void icmpv6rpl_updateCandidateParent(uint8_t index) {
+    dagrank_t previousRank;
+    dagrank_t bestRank;
+
+    previousRank = icmpv6rpl_vars.candidateRank[index];
+    icmpv6rpl_vars.candidateRank[index] = icmpv6rpl_computeCandidateRank(index);
+
+    if (index == icmpv6rpl_vars.bestCandidate) {
+        // the best candidate got worse, another one may beat it now
+        if (icmpv6rpl_vars.candidateRank[index] > previousRank) {
+            icmpv6rpl_findBestCandidate();
+        }
+    } else {
+        // ties go to the lowest index, as when scanning the neighbor table
+        bestRank = icmpv6rpl_vars.candidateRank[icmpv6rpl_vars.bestCandidate];
+        if (
+                icmpv6rpl_vars.candidateRank[index] < bestRank ||
+                (
+                        icmpv6rpl_vars.candidateRank[index] == bestRank &&
+                        index < icmpv6rpl_vars.bestCandidate
+                )
+                ) {
+            icmpv6rpl_vars.bestCandidate = index;
+        }
+    }
+}
+
+/**
+\brief Routing algorithm, after a change to a single neighbor.
+
+\param[in] index The index of the neighbor in the neighbor table.
+*/
+void icmpv6rpl_indicateNeighborUpdate(uint8_t index) {
+    icmpv6rpl_updateCandidateParent(index);
+    icmpv6rpl_selectParent();
+}
+
+/**
+\brief Select my parent among the candidates and update my rank.
+
+Only the candidate with the lowest rank through it can be selected, since the
+conditions to switch to a candidate all get harder to meet as its rank grows.
+*/
+void icmpv6rpl_selectParent(void) {
+    uint8_t i;
     uint16_t previousDAGrank;
+    uint16_t prevJoinPriority;
     uint16_t prevRankIncrease;
     uint8_t prevParentIndex;
     bool prevHadParent;
@@ -377,6 +460,7 @@ void icmpv6rpl_updateMyDAGrankAndParentSelection(void) {
         }
     }
     // prep for loop, remember state before neighbor table scanning
+    prevJoinPriority = icmpv6rpl_vars.myDAGrank / MINHOPRANKINCREASE;
     prevParentIndex = icmpv6rpl_vars.ParentIndex;
     prevHadParent = icmpv6rpl_vars.haveParent;
     prevRankIncrease = icmpv6rpl_vars.rankIncrease;
@@ -403,53 +487,27 @@ void icmpv6rpl_updateMyDAGrankAndParentSelection(void) {
     foundBetterParent = FALSE;
     icmpv6rpl_vars.haveParent = FALSE;
 
-    // loop through neighbor table, update myDAGrank
-    for (i = 0; i < MAXNUMNEIGHBORS; i++) {
-        if (neighbors_isStableNeighborByIndex(i)) { // in use and link is stable
-            // neighbor marked as NORES can't be parent
-            if (
-                    neighbors_getNeighborNoResource(i) == TRUE
-                    ) {
-                continue;
-            }
-            // get link cost to this neighbor
-            rankIncrease = neighbors_getLinkMetric(i);
-            // get this neighbor's advertized rank
-            neighborRank = neighbors_getNeighborRank(i);
-            // if this neighbor has unknown/infinite rank, pass on it
-            if (neighborRank == DEFAULTDAGRANK) continue;
-            // compute tentative cost of full path to root through this neighbor
-            tentativeDAGrank = (uint32_t) neighborRank + rankIncrease;
-            if (tentativeDAGrank > 65535) {
-                tentativeDAGrank = 65535;
-            }
-            // if larger than lowestRank+maxRankIncrease, pass (per rfc6550#section-8.2.2.4)
-            if (
-                    icmpv6rpl_vars.lowestRankInHistory<(MAXDAGRANK - DAGMAXRANKINCREASE) &&
-                                                       tentativeDAGrank>(
-                            icmpv6rpl_vars.lowestRankInHistory + DAGMAXRANKINCREASE)
-                    ) {
-                continue;
-            }
-            // if not low enough to justify switch, pass (i.e. hysterisis)
-            if (
-                    (previousDAGrank < tentativeDAGrank) ||
-                    (previousDAGrank - tentativeDAGrank < 2 * MINHOPRANKINCREASE)
-                    ) {
-                continue;
-            }
-            // remember that we have at least one valid candidate parent
-            foundBetterParent = TRUE;
-            // select best candidate so far
-            if (icmpv6rpl_vars.myDAGrank > tentativeDAGrank) {
-                if (tentativeDAGrank < icmpv6rpl_vars.lowestRankInHistory) {
-                    icmpv6rpl_vars.lowestRankInHistory = (uint16_t) tentativeDAGrank;
-                }
-                icmpv6rpl_vars.myDAGrank = (uint16_t) tentativeDAGrank;
-                icmpv6rpl_vars.ParentIndex = i;
-                icmpv6rpl_vars.rankIncrease = rankIncrease;
-            }
+    // consider the best candidate parent, a non-candidate has MAXDAGRANK and never passes the hysteresis
+    i = icmpv6rpl_vars.bestCandidate;
+    tentativeDAGrank = icmpv6rpl_vars.candidateRank[i];
+    if (
+            // not larger than lowestRank+maxRankIncrease (per rfc6550#section-8.2.2.4)
+            (
+                    icmpv6rpl_vars.lowestRankInHistory >= (MAXDAGRANK - DAGMAXRANKINCREASE) ||
+                    tentativeDAGrank <= (icmpv6rpl_vars.lowestRankInHistory + DAGMAXRANKINCREASE)
+            ) &&
+            // low enough to justify switch (i.e. hysterisis)
+            (previousDAGrank >= tentativeDAGrank) &&
+            (previousDAGrank - tentativeDAGrank >= 2 * MINHOPRANKINCREASE)
+            ) {
+        // remember that we have a valid candidate parent
+        foundBetterParent = TRUE;
+        if (tentativeDAGrank < icmpv6rpl_vars.lowestRankInHistory) {
+            icmpv6rpl_vars.lowestRankInHistory = (uint16_t) tentativeDAGrank;
         }
+        icmpv6rpl_vars.myDAGrank = (uint16_t) tentativeDAGrank;
+        icmpv6rpl_vars.ParentIndex = i;
+        icmpv6rpl_vars.rankIncrease = neighbors_getLinkMetric(i);
     }
 
     if (foundBetterParent) {
@@ -496,6 +554,11 @@ void icmpv6rpl_updateMyDAGrankAndParentSelection(void) {
     if (icmpv6rpl_vars.myDAGrank == MAXDAGRANK) {
         icmpv6rpl_vars.lowestRankInHistory = MAXDAGRANK;
     }
+
+    // the join priority in my EBs changes, advertise it
+    if (icmpv6rpl_vars.myDAGrank / MINHOPRANKINCREASE != prevJoinPriority) {
+        sixtop_resetEbTrickle();
+    }
 }
 
 /**
@@ -620,7 +683,7 @@ void icmpv6rpl_indicateRxDIO(OpenQueueEntry_t *msg) {
                     neighbors_setNeighborRank(i, icmpv6rpl_vars.incomingDio->rank);
                 }
                 // since changes were made to neighbors DAG rank, run the routing algorithm again
-                icmpv6rpl_updateMyDAGrankAndParentSelection();
+                icmpv6rpl_indicateNeighborUpdate(i);
                 break; // there should be only one matching entry, no need to loop further
             }
         }
@@ -638,6 +701,56 @@ void icmpv6rpl_killPreferredParent(void) {
 
 //=========================== private =========================================
 
+//===== parent selection
+
+/**
+\brief Compute my rank through a neighbor, if it were my parent.
+
+\param[in] index The index of the neighbor in the neighbor table.
+
+\returns My tentative rank, MAXDAGRANK if this neighbor can't be my parent.
+*/
+dagrank_t icmpv6rpl_computeCandidateRank(uint8_t index) {
+    uint16_t rankIncrease;
+    dagrank_t neighborRank;
+    uint32_t tentativeDAGrank;
+
+    // only neighbors in use and with a stable link are candidates
+    if (neighbors_isStableNeighborByIndex(index) == FALSE) {
+        return MAXDAGRANK;
+    }
+    // neighbor marked as NORES can't be parent
+    if (neighbors_getNeighborNoResource(index) == TRUE) {
+        return MAXDAGRANK;
+    }
+    // if this neighbor has unknown/infinite rank, pass on it
+    neighborRank = neighbors_getNeighborRank(index);
+    if (neighborRank == DEFAULTDAGRANK) {
+        return MAXDAGRANK;
+    }
+    // compute tentative cost of full path to root through this neighbor
+    rankIncrease = neighbors_getLinkMetric(index);
+    tentativeDAGrank = (uint32_t) neighborRank + rankIncrease;
+    if (tentativeDAGrank > MAXDAGRANK) {
+        tentativeDAGrank = MAXDAGRANK;
+    }
+    return (dagrank_t) tentativeDAGrank;
+}
+
+/**
+\brief Find the candidate parent with the lowest rank through it, among the cached ones.
+*/
+void icmpv6rpl_findBestCandidate(void) {
+    uint8_t i;
+
+    icmpv6rpl_vars.bestCandidate = 0;
+    for (i = 1; i < MAXNUMNEIGHBORS; i++) {
+        if (icmpv6rpl_vars.candidateRank[i] < icmpv6rpl_vars.candidateRank[icmpv6rpl_vars.bestCandidate]) {
+            icmpv6rpl_vars.bestCandidate = i;
+        }
+    }
+}
+
 //===== DIO-related
 
 /**
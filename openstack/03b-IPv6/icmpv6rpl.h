@@ -199,6 +199,8 @@ typedef struct {
     uint16_t rankIncrease;                    ///< the cost of the link to the parent, in units of rank
     bool haveParent;                          ///< this router has a route to DAG root
     uint8_t ParentIndex;                      ///< index of Parent in neighbor table (iff haveParent==TRUE)
+    dagrank_t candidateRank[MAXNUMNEIGHBORS]; ///< my rank through each neighbor, MAXDAGRANK if it can't be my parent
+    uint8_t bestCandidate;                    ///< index of the neighbor with the lowest candidateRank
     // actually only here for debug
     icmpv6rpl_dio_ht *incomingDio;            ///< keep it global to be able to debug correctly.
     icmpv6rpl_pio_t *incomingPio;             ///< pio structure incoming
@@ -236,6 +238,10 @@ void icmpv6rpl_killPreferredParent(void);
 
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void);
 
+void icmpv6rpl_updateCandidateParent(uint8_t index);
+
+void icmpv6rpl_indicateNeighborUpdate(uint8_t index);
+
 void icmpv6rpl_indicateRxDIO(OpenQueueEntry_t *msg);
 
 bool icmpv6rpl_daoSent(void);
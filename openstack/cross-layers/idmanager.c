@@ -19,8 +19,6 @@ void idmanager_init(void) {
 
     // reset local variables
     memset(&idmanager_vars, 0, sizeof(idmanager_vars_t));
-    // this is used to not wakeup in non-activeslot
-    idmanager_vars.slotSkip = FALSE;
 
     // isDAGroot
 #if DAGROOT
@@ -84,16 +82,6 @@ void idmanager_setIsDAGroot(bool newRole) {
     ENABLE_INTERRUPTS();
 }
 
-bool idmanager_getIsSlotSkip(void) {
-    bool res;
-    INTERRUPT_DECLARATION();
-
-    DISABLE_INTERRUPTS();
-    res = idmanager_vars.slotSkip;
-    ENABLE_INTERRUPTS();
-    return res;
-}
-
 open_addr_t* idmanager_getMyID(uint8_t type) {
     open_addr_t *res;
 
@@ -216,19 +204,15 @@ void idmanager_triggerAboutRoot(void) {
     switch (input_buffer[0]) {
         case ACTION_YES:
             idmanager_setIsDAGroot(TRUE);
-            idmanager_vars.slotSkip = FALSE;
             break;
         case ACTION_NO:
             idmanager_setIsDAGroot(FALSE);
-            idmanager_vars.slotSkip = TRUE;
             break;
         case ACTION_TOGGLE:
             if (idmanager_getIsDAGroot()) {
                 idmanager_setIsDAGroot(FALSE);
-                idmanager_vars.slotSkip = TRUE;
             } else {
                 idmanager_setIsDAGroot(TRUE);
-                idmanager_vars.slotSkip = FALSE;
             }
             break;
         default:
@@ -42,7 +42,6 @@ typedef struct {
     open_addr_t my16bID;
     open_addr_t my64bID;
     open_addr_t myPrefix;
-    bool slotSkip;
     uint8_t joinKey[16];
     asn_t joinAsn;
 } idmanager_vars_t;
@@ -55,8 +54,6 @@ bool idmanager_getIsDAGroot(void);
 
 void idmanager_setIsDAGroot(bool newRole);
 
-bool idmanager_getIsSlotSkip(void);
-
 open_addr_t* idmanager_getMyID(uint8_t type);
 
 owerror_t idmanager_setMyID(open_addr_t *newID);
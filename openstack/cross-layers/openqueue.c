@@ -7,11 +7,25 @@
 #include "radio.h"
 #include "IEEE802154_security.h"
 #include "sixtop.h"
+#include "neighbors.h"
 
 //=========================== defination =====================================
 
 #define HIGH_PRIORITY_QUEUE_ENTRY 5
 
+#if OPENQUEUE_NUM_FRAME_CHUNKS <= HIGH_PRIORITY_QUEUE_ENTRY
+#error "QUEUELENGTH must leave frame-size chunks beyond the high priority ones."
+#endif
+
+// a pointer into the frame of a packet which moved to another chunk, follows it
+#define OPENQUEUE_RELOCATE(ptr) \
+    if ((ptr) >= oldPacket && (ptr) <= oldPacket + oldSize) { \
+        (ptr) = pkt->payload + ((ptr) - oldPayload); \
+    }
+
+// relayed packets are grouped per IPv6 source, local ones per creator
+#define OPENQUEUE_FLOW_RELAYED 0x8000
+
 //=========================== variables =======================================
 
 openqueue_vars_t openqueue_vars;
@@ -20,10 +34,36 @@ openqueue_vars_t openqueue_vars;
 
 void openqueue_reset_entry(OpenQueueEntry_t *entry);
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-void openqueue_reset_big_entry(OpenQueueBigEntry_t *entry);
+static OpenQueueEntry_t* openqueue_getFreeEntry(uint8_t creator, uint8_t chunkClass);
+static uint8_t openqueue_allocChunk(uint8_t chunkClass);
+static void openqueue_attachChunk(OpenQueueEntry_t *entry, uint8_t chunk);
+static void openqueue_freeChunk(uint8_t *packet, uint16_t packet_size);
+
+static bool openqueue_admit(uint8_t creator, open_addr_t *source);
+#if OPENQUEUE_AQM
+static bool openqueue_aqmDrop(uint8_t creator, open_addr_t *source);
+#if DEADLINE_OPTION
+static bool openqueue_aqmDropExpired(void);
+#endif
+#if OPENQUEUE_AQM == OPENQUEUE_AQM_HEADDROP
+static bool openqueue_aqmDropOldest(void);
+#endif
+#if OPENQUEUE_AQM == OPENQUEUE_AQM_FAIR
+static bool openqueue_aqmDropLongestFlow(uint16_t newFlow);
+static bool openqueue_isQueued(OpenQueueEntry_t *entry);
+static uint16_t openqueue_flowKey(uint8_t creator, open_addr_t *source);
+#endif
+static bool openqueue_isDroppable(OpenQueueEntry_t *entry);
 #endif
 
+static uint8_t openqueue_getIndex(OpenQueueEntry_t *entry);
+static OpenQueueEntry_t* openqueue_getEntry(uint8_t index);
+static bool openqueue_isOlder(uint8_t index, uint8_t other);
+static uint8_t openqueue_neighborTxList(open_addr_t *neighbor);
+static void openqueue_txListInsert(uint8_t index, uint8_t list);
+static void openqueue_txListRemove(uint8_t index);
+static void openqueue_txListMove(uint8_t from, uint8_t to, open_addr_t *neighbor);
+
 //=========================== public ==========================================
 
 //======= admin
@@ -33,15 +73,23 @@ void openqueue_reset_big_entry(OpenQueueBigEntry_t *entry);
 */
 void openqueue_init() {
     uint8_t i;
-    for (i = 0; i < QUEUELENGTH; i++) {
-        openqueue_reset_entry(&(openqueue_vars.queue[i]));
-    }
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
-        openqueue_reset_big_entry(&(openqueue_vars.big_queue[i]));
+    // no metadata is attached, no chunk is used
+    memset(&openqueue_vars.metadata[0], 0, sizeof(openqueue_vars.metadata));
+    memset(&openqueue_vars.chunkIsUsed[0], FALSE, sizeof(openqueue_vars.chunkIsUsed));
+
+    memset(&openqueue_vars.stats, 0, sizeof(openqueue_stats_t));
+    openqueue_vars.allocSeq = 0;
+
+    // no packet is in a TX list
+    memset(&openqueue_vars.txList[0], OPENQUEUE_TXLIST_NONE, sizeof(openqueue_vars.txList));
+    memset(&openqueue_vars.txHead[0], OPENQUEUE_TXLIST_NONE, sizeof(openqueue_vars.txHead));
+    memset(&openqueue_vars.txTail[0], OPENQUEUE_TXLIST_NONE, sizeof(openqueue_vars.txTail));
+
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        openqueue_vars.queue[i].packet = NULL;
+        openqueue_reset_entry(&(openqueue_vars.queue[i]));
     }
-#endif
 }
 
 /**
@@ -63,6 +111,16 @@ bool debugPrint_queue() {
     return TRUE;
 }
 
+/**
+\brief Trigger this module to print its queue management counters, over serial.
+
+\returns TRUE if this function printed something, FALSE otherwise.
+*/
+bool debugPrint_queueStats() {
+    openserial_printStatus(STATUS_QUEUESTATS, (uint8_t * ) & openqueue_vars.stats, sizeof(openqueue_stats_t));
+    return TRUE;
+}
+
 //======= called by any component
 
 /**
@@ -78,7 +136,7 @@ get a new packet buffer to start creating a new packet.
          it could not be allocated (buffer full or not synchronized).
 */
 OpenQueueEntry_t* openqueue_getFreePacketBuffer(uint8_t creator) {
-    uint8_t i;
+    OpenQueueEntry_t *entry;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
@@ -91,22 +149,51 @@ OpenQueueEntry_t* openqueue_getFreePacketBuffer(uint8_t creator) {
     // if you get here, I will try to allocate a buffer for you
 
     // if there is no space left for high priority queue, don't reserve
-    if (openqueue_isHighPriorityEntryEnough() == FALSE && creator > COMPONENT_SIXTOP_RES) {
+    if (creator > COMPONENT_SIXTOP_RES && openqueue_admit(creator, NULL) == FALSE) {
         ENABLE_INTERRUPTS();
         return NULL;
     }
 
-    // walk through queue and find free entry
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].owner == COMPONENT_NULL) {
-            openqueue_vars.queue[i].creator = creator;
-            openqueue_vars.queue[i].owner = COMPONENT_OPENQUEUE;
-            ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
-        }
+    entry = openqueue_getFreeEntry(creator, OPENQUEUE_CHUNK_FRAME);
+    ENABLE_INTERRUPTS();
+    return entry;
+}
+
+/**
+\brief Request a new (free) packet buffer for a short frame.
+
+Same as openqueue_getFreePacketBuffer(), but the frame is held in a small
+chunk of OPENQUEUE_SMALL_CHUNK_SIZE bytes. It is meant for frames which are
+known to be short, such as ACKs and keep-alives. When no small chunk is left,
+a frame-size chunk is used instead. The frame must fit in the small chunk,
+packetfunctions_reserveHeader() refuses a header which would overflow it.
+
+\returns A pointer to the queue entry when it could be allocated, or NULL when
+         it could not be allocated (buffer full or not synchronized).
+*/
+OpenQueueEntry_t* openqueue_getFreeSmallPacketBuffer(uint8_t creator) {
+    OpenQueueEntry_t *entry;
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    // refuse to allocate if we're not in sync
+    if (ieee154e_isSynch() == FALSE && creator > COMPONENT_IEEE802154E) {
+        ENABLE_INTERRUPTS();
+        return NULL;
+    }
+
+    // if there is no space left for high priority queue, don't reserve
+    if (creator > COMPONENT_SIXTOP_RES && openqueue_admit(creator, NULL) == FALSE) {
+        ENABLE_INTERRUPTS();
+        return NULL;
+    }
+
+    entry = openqueue_getFreeEntry(creator, OPENQUEUE_CHUNK_SMALL);
+    if (entry == NULL) {
+        entry = openqueue_getFreeEntry(creator, OPENQUEUE_CHUNK_FRAME);
     }
     ENABLE_INTERRUPTS();
-    return NULL;
+    return entry;
 }
 
 /**
@@ -123,36 +210,17 @@ owerror_t openqueue_freePacketBuffer(OpenQueueEntry_t *pkt) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-    if (pkt->is_big_packet) {
-        for (i = 0; i < BIGQUEUELENGTH; i++) {
-            if ((OpenQueueBigEntry_t *) pkt == &openqueue_vars.big_queue[i]) {
-                if (openqueue_vars.big_queue[i].standard_entry.owner == COMPONENT_NULL) {
-                    // log the error
-                    LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_UNUSED,(errorparameter_t) 0,(errorparameter_t) 0);
-                }
-
-                openqueue_reset_big_entry((OpenQueueBigEntry_t *) pkt);
-                ENABLE_INTERRUPTS();
-                return E_SUCCESS;
-            }
-        }
-    } else {
-#endif
-        for (i = 0; i < QUEUELENGTH; i++) {
-            if (&openqueue_vars.queue[i] == pkt) {
-                if (openqueue_vars.queue[i].owner == COMPONENT_NULL) {
-                    // log the error
-                    LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_UNUSED, (errorparameter_t) 0, (errorparameter_t) 0);
-                }
-                openqueue_reset_entry(&(openqueue_vars.queue[i]));
-                ENABLE_INTERRUPTS();
-                return E_SUCCESS;
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        if (&openqueue_vars.queue[i] == pkt) {
+            if (openqueue_vars.queue[i].owner == COMPONENT_NULL) {
+                // log the error
+                LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_UNUSED, (errorparameter_t) 0, (errorparameter_t) 0);
             }
+            openqueue_reset_entry(&(openqueue_vars.queue[i]));
+            ENABLE_INTERRUPTS();
+            return E_SUCCESS;
         }
-#if OPENWSN_6LO_FRAGMENTATION_C
     }
-#endif
 
     // log the error
     LOG_CRITICAL(COMPONENT_OPENQUEUE, ERR_FREEING_ERROR, (errorparameter_t) 0, (errorparameter_t) 0);
@@ -160,35 +228,108 @@ owerror_t openqueue_freePacketBuffer(OpenQueueEntry_t *pkt) {
     return E_FAIL;
 }
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-OpenQueueEntry_t* openqueue_getFreeBigPacketBuffer(uint8_t creator) {
+/**
+\brief Attach a metadata entry to a packet buffer.
+
+The 6P cell lists and the explicit key source are only needed by a few packets
+at a time, so they are not part of each packet buffer. A packet which needs
+them borrows an entry from a small pool, which is returned when the packet
+buffer is freed. Attaching to a packet which already has metadata returns the
+same, unchanged, entry.
+
+\param pkt A pointer to the previously-allocated packet buffer.
+
+\returns A pointer to the zeroed metadata entry, or NULL when none is left.
+*/
+OpenQueueMetadata_t* openqueue_attachMetadata(OpenQueueEntry_t *pkt) {
     uint8_t i;
 
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    // refuse to allocate if we're not in sync
-    if (ieee154e_isSynch() == FALSE) {
+    if (pkt->metadata != NULL) {
         ENABLE_INTERRUPTS();
-        return NULL;
+        return pkt->metadata;
     }
 
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
-        if (openqueue_vars.big_queue[i].standard_entry.owner == COMPONENT_NULL) {
-
-            openqueue_vars.big_queue[i].standard_entry.creator = creator;
-            openqueue_vars.big_queue[i].standard_entry.owner = COMPONENT_OPENQUEUE;
-            openqueue_vars.big_queue[i].standard_entry.is_big_packet = TRUE;
-
+    for (i = 0; i < OPENQUEUE_NUM_METADATA; i++) {
+        if (openqueue_vars.metadata[i].isUsed == FALSE) {
+            memset(&openqueue_vars.metadata[i], 0, sizeof(OpenQueueMetadata_t));
+            openqueue_vars.metadata[i].isUsed = TRUE;
+            pkt->metadata = &openqueue_vars.metadata[i];
             ENABLE_INTERRUPTS();
-            return &openqueue_vars.big_queue[i].standard_entry;
-
+            return pkt->metadata;
         }
     }
 
     ENABLE_INTERRUPTS();
     return NULL;
 }
+
+/**
+\brief Move the frame of a packet to a chunk of another class.
+
+The packet keeps its queue entry, only the bytes of the frame are copied. They
+end where the frame of a new packet of that class would start, and the pointers
+into the frame follow them.
+
+\param pkt         The packet to move.
+\param chunkClass  The class of the chunk to move it to, OPENQUEUE_CHUNK_*.
+
+\returns E_SUCCESS when the frame was moved, E_FAIL when no chunk is left.
+*/
+owerror_t openqueue_resizePacketBuffer(OpenQueueEntry_t *pkt, uint8_t chunkClass) {
+    uint8_t chunk;
+    uint8_t *oldPacket;
+    uint16_t oldSize;
+    uint8_t *oldPayload;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    chunk = openqueue_allocChunk(chunkClass);
+    if (chunk == OPENQUEUE_NO_CHUNK) {
+        ENABLE_INTERRUPTS();
+        return E_FAIL;
+    }
+
+    oldPacket = pkt->packet;
+    oldSize = pkt->packet_size;
+    oldPayload = pkt->payload;
+
+    openqueue_attachChunk(pkt, chunk);
+    pkt->payload -= pkt->length;
+    memcpy(pkt->payload, oldPayload, pkt->length);
+
+    OPENQUEUE_RELOCATE(pkt->l4_payload);
+    OPENQUEUE_RELOCATE(pkt->l2_payload);
+    OPENQUEUE_RELOCATE(pkt->l2_ASNpayload);
+    OPENQUEUE_RELOCATE(pkt->l2_nextHop_payload);
+    OPENQUEUE_RELOCATE(pkt->l2_FrameCounter);
+
+    openqueue_freeChunk(oldPacket, oldSize);
+
+    ENABLE_INTERRUPTS();
+    return E_SUCCESS;
+}
+
+#if OPENWSN_6LO_FRAGMENTATION_C
+OpenQueueEntry_t* openqueue_getFreeBigPacketBuffer(uint8_t creator) {
+    OpenQueueEntry_t *entry;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    // refuse to allocate if we're not in sync
+    if (ieee154e_isSynch() == FALSE) {
+        ENABLE_INTERRUPTS();
+        return NULL;
+    }
+
+    entry = openqueue_getFreeEntry(creator, OPENQUEUE_CHUNK_BIG);
+    ENABLE_INTERRUPTS();
+    return entry;
+}
 #endif
 
 /**
@@ -200,7 +341,7 @@ void openqueue_removeAllCreatedBy(uint8_t creator) {
     uint8_t i;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (
                 openqueue_vars.queue[i].creator == creator &&
                 openqueue_vars.queue[i].owner != COMPONENT_IEEE802154E
@@ -209,24 +350,55 @@ void openqueue_removeAllCreatedBy(uint8_t creator) {
         }
     }
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
-        if (openqueue_vars.big_queue[i].standard_entry.creator == creator) {
-            openqueue_reset_big_entry(&(openqueue_vars.big_queue[i]));
+    ENABLE_INTERRUPTS();
+}
+
+//======= called by RES
+
+/**
+\brief Add a packet handed to the MAC to the TX list of its next hop.
+
+Called by sixtop when the packet is given to COMPONENT_SIXTOP_TO_IEEE802154E.
+The packet stays in its TX list until it is freed, so a packet returned to
+COMPONENT_SIXTOP_TO_IEEE802154E for a retransmission keeps its place.
+
+\param pkt The packet handed to the MAC.
+*/
+void openqueue_sixtopEnqueue(OpenQueueEntry_t *pkt) {
+    uint8_t index;
+    uint8_t list;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    index = openqueue_getIndex(pkt);
+    openqueue_txListRemove(index);
+
+    if (packetfunctions_isBroadcastMulticast(&(pkt->l2_nextORpreviousHop))) {
+        if (pkt->creator == COMPONENT_SIXTOP) {
+            list = OPENQUEUE_TXLIST_EB;
+        } else if (pkt->creator == COMPONENT_ICMPv6RPL) {
+            list = OPENQUEUE_TXLIST_DIO;
+        } else {
+            // the MAC never picks other broadcast packets
+            list = OPENQUEUE_TXLIST_NONE;
         }
+    } else {
+        list = openqueue_neighborTxList(&(pkt->l2_nextORpreviousHop));
+    }
+
+    if (list != OPENQUEUE_TXLIST_NONE) {
+        openqueue_txListInsert(index, list);
     }
-#endif
 
     ENABLE_INTERRUPTS();
 }
 
-//======= called by RES
-
 OpenQueueEntry_t* openqueue_sixtopGetSentPacket() {
     uint8_t i;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (openqueue_vars.queue[i].owner == COMPONENT_IEEE802154E_TO_SIXTOP &&
             openqueue_vars.queue[i].creator != COMPONENT_IEEE802154E) {
             ENABLE_INTERRUPTS();
@@ -234,16 +406,6 @@ OpenQueueEntry_t* openqueue_sixtopGetSentPacket() {
         }
     }
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
-        if (((OpenQueueEntry_t*)&openqueue_vars.big_queue[i])->owner == COMPONENT_IEEE802154E_TO_SIXTOP &&
-            ((OpenQueueEntry_t*)&openqueue_vars.big_queue[i])->creator != COMPONENT_IEEE802154E) {
-            ENABLE_INTERRUPTS();
-            return (OpenQueueEntry_t*)&openqueue_vars.big_queue[i];
-        }
-    }
-#endif
-
     ENABLE_INTERRUPTS();
     return NULL;
 }
@@ -252,7 +414,7 @@ OpenQueueEntry_t* openqueue_sixtopGetReceivedPacket() {
     uint8_t i;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (openqueue_vars.queue[i].owner == COMPONENT_IEEE802154E_TO_SIXTOP &&
             openqueue_vars.queue[i].creator == COMPONENT_IEEE802154E) {
             ENABLE_INTERRUPTS();
@@ -272,7 +434,7 @@ uint8_t openqueue_getNum6PReq(open_addr_t *neighbor) {
     DISABLE_INTERRUPTS();
 
     num6Prequest = 0;
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (
                 openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
@@ -286,7 +448,51 @@ uint8_t openqueue_getNum6PReq(open_addr_t *neighbor) {
     return num6Prequest;
 }
 
-uint8_t openqueue_getNum6PResp() {
+/**
+\brief Count the packets the MAC has to send to a neighbor.
+
+\param[in] toNeighbor The EUI64 address of the neighbor.
+
+\returns The number of packets queued to that neighbor.
+*/
+uint8_t openqueue_getNumPacketsTo(open_addr_t *toNeighbor) {
+    uint8_t index;
+    uint8_t list;
+    uint8_t numPackets;
+    INTERRUPT_DECLARATION();
+
+    if (toNeighbor->type != ADDR_64B) {
+        return 0;
+    }
+
+    DISABLE_INTERRUPTS();
+
+    numPackets = 0;
+    list = openqueue_neighborTxList(toNeighbor);
+    for (index = openqueue_vars.txHead[list]; index != OPENQUEUE_TXLIST_NONE; index = openqueue_vars.txNext[index]) {
+        if (
+                openqueue_vars.queue[index].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
+                (
+                        list != OPENQUEUE_TXLIST_NOROW ||
+                        packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[index].l2_nextORpreviousHop)
+                )
+                ) {
+            numPackets++;
+        }
+    }
+
+    ENABLE_INTERRUPTS();
+    return numPackets;
+}
+
+/**
+\brief Count the 6P responses waiting in the queue.
+
+\param[in] neighbor The neighbor the responses are to, NULL for any neighbor.
+
+\returns The number of 6P responses in the queue.
+*/
+uint8_t openqueue_getNum6PResp(open_addr_t *neighbor) {
 
     uint8_t i;
     uint8_t num6Presponse;
@@ -295,11 +501,13 @@ uint8_t openqueue_getNum6PResp() {
     DISABLE_INTERRUPTS();
 
     num6Presponse = 0;
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (
                 openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
-                openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_RESPONSE
+                openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_RESPONSE &&
+                (neighbor == NULL ||
+                 packetfunctions_sameAddress(neighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop))
                 ) {
             num6Presponse += 1;
         }
@@ -308,6 +516,54 @@ uint8_t openqueue_getNum6PResp() {
     return num6Presponse;
 }
 
+/**
+\brief Tell whether a queued 6P response grants a given slot offset.
+
+Cells granted in a 6P response are only added to the schedule when the
+response is sent, so they must not be granted again in the meantime.
+
+\param[in] frameID    The slotframe of the cell.
+\param[in] slotOffset The slot offset of the cell.
+
+\returns TRUE if a 6P response in the queue adds a cell at that slot offset.
+*/
+bool openqueue_is6PRespCell(uint8_t frameID, uint16_t slotOffset) {
+
+    uint8_t i;
+    uint8_t j;
+    OpenQueueEntry_t *entry;
+
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        entry = &openqueue_vars.queue[i];
+        if (
+                entry->owner != COMPONENT_SIXTOP_TO_IEEE802154E ||
+                entry->creator != COMPONENT_SIXTOP_RES ||
+                entry->l2_sixtop_messageType != SIXTOP_CELL_RESPONSE ||
+                entry->l2_sixtop_returnCode != IANA_6TOP_RC_SUCCESS ||
+                (entry->l2_sixtop_command != IANA_6TOP_CMD_ADD && entry->l2_sixtop_command != IANA_6TOP_CMD_RELOCATE) ||
+                entry->l2_sixtop_frameID != frameID ||
+                entry->metadata == NULL
+                ) {
+            continue;
+        }
+        for (j = 0; j < CELLLIST_MAX_LEN; j++) {
+            if (
+                    entry->metadata->l2_sixtop_celllist_add[j].isUsed &&
+                    entry->metadata->l2_sixtop_celllist_add[j].slotoffset == slotOffset
+                    ) {
+                ENABLE_INTERRUPTS();
+                return TRUE;
+            }
+        }
+    }
+
+    ENABLE_INTERRUPTS();
+    return FALSE;
+}
+
 void openqueue_remove6PrequestToNeighbor(open_addr_t *neighbor) {
 
     uint8_t i;
@@ -315,7 +571,7 @@ void openqueue_remove6PrequestToNeighbor(open_addr_t *neighbor) {
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (
                 openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
@@ -337,13 +593,16 @@ bool openqueue_isHighPriorityEntryEnough() {
     DISABLE_INTERRUPTS();
 
     numberOfEntry = 0;
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].creator > COMPONENT_SIXTOP_RES) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        if (
+                openqueue_vars.queue[i].creator > COMPONENT_SIXTOP_RES &&
+                openqueue_vars.queue[i].packet_size == OPENQUEUE_FRAME_CHUNK_SIZE
+                ) {
             numberOfEntry++;
         }
     }
 
-    if (numberOfEntry > QUEUELENGTH - HIGH_PRIORITY_QUEUE_ENTRY) {
+    if (numberOfEntry > OPENQUEUE_NUM_FRAME_CHUNKS - HIGH_PRIORITY_QUEUE_ENTRY) {
         ENABLE_INTERRUPTS();
         return FALSE;
     } else {
@@ -352,34 +611,67 @@ bool openqueue_isHighPriorityEntryEnough() {
     }
 }
 
+/**
+\brief Check whether a packet to relay may keep its buffer.
+
+Called by forwarding once it took a received packet over. When only the buffers
+reserved for high priority packets are left, the OPENQUEUE_AQM policy may drop
+another relayed packet to make room for this one.
+
+\param pkt The packet to relay, created by COMPONENT_FORWARDING.
+
+\returns TRUE if the packet can be relayed, FALSE if it has to be dropped.
+*/
+bool openqueue_admitRelayedPacket(OpenQueueEntry_t *pkt) {
+    bool admitted;
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+
+    admitted = openqueue_admit(pkt->creator, &(pkt->l3_sourceAdd));
+
+    ENABLE_INTERRUPTS();
+    return admitted;
+}
+
 OpenQueueEntry_t* openqueue_macGetEBPacket() {
-   uint8_t i;
-   INTERRUPT_DECLARATION();
-   DISABLE_INTERRUPTS();
-   for (i=0;i<QUEUELENGTH;i++) {
-      if (openqueue_vars.queue[i].owner==COMPONENT_SIXTOP_TO_IEEE802154E &&
-          openqueue_vars.queue[i].creator==COMPONENT_SIXTOP              &&
-          packetfunctions_isBroadcastMulticast(&(openqueue_vars.queue[i].l2_nextORpreviousHop))) {
-         ENABLE_INTERRUPTS();
-         return &openqueue_vars.queue[i];
-      }
-   }
-   ENABLE_INTERRUPTS();
-   return NULL;
+    uint8_t index;
+    OpenQueueEntry_t *entry;
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+    for (index = openqueue_vars.txHead[OPENQUEUE_TXLIST_EB]; index != OPENQUEUE_TXLIST_NONE; index = openqueue_vars.txNext[index]) {
+        entry = openqueue_getEntry(index);
+        if (entry->owner == COMPONENT_SIXTOP_TO_IEEE802154E) {
+            ENABLE_INTERRUPTS();
+            return entry;
+        }
+    }
+    ENABLE_INTERRUPTS();
+    return NULL;
 }
 
 OpenQueueEntry_t* openqueue_macGetKaPacket(open_addr_t* toNeighbor) {
-    uint8_t i;
+    uint8_t index;
+    uint8_t list;
+    OpenQueueEntry_t *entry;
     INTERRUPT_DECLARATION();
+
+    if (toNeighbor->type != ADDR_64B) {
+        return NULL;
+    }
+
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-            openqueue_vars.queue[i].creator == COMPONENT_SIXTOP &&
-            toNeighbor->type == ADDR_64B &&
-            packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
+    list = openqueue_neighborTxList(toNeighbor);
+    for (index = openqueue_vars.txHead[list]; index != OPENQUEUE_TXLIST_NONE; index = openqueue_vars.txNext[index]) {
+        entry = openqueue_getEntry(index);
+        if (entry->owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
+            entry->creator == COMPONENT_SIXTOP &&
+            (
+                    list != OPENQUEUE_TXLIST_NOROW ||
+                    packetfunctions_sameAddress(toNeighbor, &entry->l2_nextORpreviousHop)
+            )
                 ) {
             ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
+            return entry;
         }
     }
     ENABLE_INTERRUPTS();
@@ -387,15 +679,15 @@ OpenQueueEntry_t* openqueue_macGetKaPacket(open_addr_t* toNeighbor) {
 }
 
 OpenQueueEntry_t*  openqueue_macGetDIOPacket(){
-    uint8_t i;
+    uint8_t index;
+    OpenQueueEntry_t *entry;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-            openqueue_vars.queue[i].creator == COMPONENT_ICMPv6RPL &&
-            packetfunctions_isBroadcastMulticast(&(openqueue_vars.queue[i].l2_nextORpreviousHop))) {
+    for (index = openqueue_vars.txHead[OPENQUEUE_TXLIST_DIO]; index != OPENQUEUE_TXLIST_NONE; index = openqueue_vars.txNext[index]) {
+        entry = openqueue_getEntry(index);
+        if (entry->owner == COMPONENT_SIXTOP_TO_IEEE802154E) {
             ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
+            return entry;
         }
     }
     ENABLE_INTERRUPTS();
@@ -404,15 +696,22 @@ OpenQueueEntry_t*  openqueue_macGetDIOPacket(){
 
 /**
 \Brief replace the upstream packet nexthop payload by given newNextHop address
+
+The packets move to the TX list of the new next hop, where they are inserted
+by age, so that list stays oldest first.
+
 \param newNextHop.
 */
 void openqueue_updateNextHopPayload(open_addr_t *newNextHop) {
 
     uint8_t i, j;
+    uint8_t list;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    for (i = 0; i < QUEUELENGTH; i++) {
+    list = openqueue_neighborTxList(newNextHop);
+
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (
                 openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 (
@@ -428,6 +727,9 @@ void openqueue_updateNextHopPayload(open_addr_t *newNextHop) {
                 for (j = 0; j < 8; j++) {
                     *((uint8_t *) openqueue_vars.queue[i].l2_nextHop_payload + j) = newNextHop->addr_64b[j];
                 }
+                // move the packet to the TX list of its new next hop
+                openqueue_txListRemove(i);
+                openqueue_txListInsert(i, list);
             }
         }
     }
@@ -435,12 +737,46 @@ void openqueue_updateNextHopPayload(open_addr_t *newNextHop) {
     ENABLE_INTERRUPTS();
 }
 
+/**
+\brief A neighbor took a row of the neighbor table.
+
+Its packets leave OPENQUEUE_TXLIST_NOROW for the TX list of that row.
+
+\param index The row of the neighbor.
+*/
+void openqueue_indicateNeighborAdded(uint8_t index) {
+    open_addr_t neighbor;
+    INTERRUPT_DECLARATION();
+
+    if (neighbors_getNeighborEui64(&neighbor, ADDR_64B, index) == FALSE) {
+        return;
+    }
+
+    DISABLE_INTERRUPTS();
+    openqueue_txListMove(OPENQUEUE_TXLIST_NOROW, index, &neighbor);
+    ENABLE_INTERRUPTS();
+}
+
+/**
+\brief A neighbor lost its row of the neighbor table.
+
+Its packets move to OPENQUEUE_TXLIST_NOROW, before the row is reused.
+
+\param index The row the neighbor had.
+*/
+void openqueue_indicateNeighborRemoved(uint8_t index) {
+    INTERRUPT_DECLARATION();
+    DISABLE_INTERRUPTS();
+    openqueue_txListMove(index, OPENQUEUE_TXLIST_NOROW, NULL);
+    ENABLE_INTERRUPTS();
+}
+
 OpenQueueEntry_t*  openqueue_getPacketByComponent(uint8_t component) {
     uint8_t i;
     INTERRUPT_DECLARATION();
     DISABLE_INTERRUPTS();
 
-    for (i = 0; i < QUEUELENGTH; i++) {
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
         if (openqueue_vars.queue[i].owner == component) {
             ENABLE_INTERRUPTS();
             return &openqueue_vars.queue[i];
@@ -451,71 +787,87 @@ OpenQueueEntry_t*  openqueue_getPacketByComponent(uint8_t component) {
     return NULL;
 }
 
+/**
+\brief Get the next packet to send to a neighbor.
+
+A 6P response is returned first, otherwise the oldest packet to that neighbor.
+Every packet in the TX list of a neighbor table row goes to that neighbor, so
+the oldest one is the head of the list, and only the packets to that neighbor
+are looked at for a 6P response. Finding the row scans the neighbor table,
+not the queue. Packets to a next hop without a row share
+OPENQUEUE_TXLIST_NOROW, where addresses are compared.
+
+\param toNeighbor The neighbor the TX cell is scheduled with.
+
+\returns The packet to send, or NULL if there is none.
+*/
 OpenQueueEntry_t*  openqueue_macGetUnicastPacket(open_addr_t* toNeighbor){
-    uint8_t i;
+    uint8_t index;
+    uint8_t list;
+    OpenQueueEntry_t *entry;
+    OpenQueueEntry_t *oldest;
     INTERRUPT_DECLARATION();
-    DISABLE_INTERRUPTS();
 
-    // first to look the sixtop RES packet
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-                openqueue_vars.queue[i].creator == COMPONENT_SIXTOP_RES &&
-                (
-                        toNeighbor->type == ADDR_64B &&
-                        packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
-                ) &&
-                openqueue_vars.queue[i].l2_sixtop_messageType == SIXTOP_CELL_RESPONSE
-                ) {
-            ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
-        }
+    if (toNeighbor->type != ADDR_64B) {
+        return NULL;
     }
 
-    // if reach here, then looking for other unicast packets
-    for (i = 0; i < QUEUELENGTH; i++) {
-        if (
-                openqueue_vars.queue[i].owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
-                (
-                        toNeighbor->type == ADDR_64B &&
-                        packetfunctions_sameAddress(toNeighbor, &openqueue_vars.queue[i].l2_nextORpreviousHop)
-                )
-                ) {
-            ENABLE_INTERRUPTS();
-            return &openqueue_vars.queue[i];
-        }
-    }
+    DISABLE_INTERRUPTS();
 
-#if OPENWSN_6LO_FRAGMENTATION_C
-    for (i = 0; i < BIGQUEUELENGTH; i++) {
+    oldest = NULL;
+    list = openqueue_neighborTxList(toNeighbor);
+    for (index = openqueue_vars.txHead[list]; index != OPENQUEUE_TXLIST_NONE; index = openqueue_vars.txNext[index]) {
+        entry = openqueue_getEntry(index);
         if (
-                ((OpenQueueEntry_t*)&openqueue_vars.big_queue[i])->owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
+                entry->owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
                 (
-                        toNeighbor->type == ADDR_64B &&
-                        packetfunctions_sameAddress(toNeighbor, &((OpenQueueEntry_t*)&openqueue_vars.big_queue[i])->l2_nextORpreviousHop)
+                        list != OPENQUEUE_TXLIST_NOROW ||
+                        packetfunctions_sameAddress(toNeighbor, &entry->l2_nextORpreviousHop)
                 )
                 ) {
-            ENABLE_INTERRUPTS();
-            return (OpenQueueEntry_t*)&openqueue_vars.big_queue[i];
+            // the sixtop RES packet goes first
+            if (
+                    entry->creator == COMPONENT_SIXTOP_RES &&
+                    entry->l2_sixtop_messageType == SIXTOP_CELL_RESPONSE
+                    ) {
+                ENABLE_INTERRUPTS();
+                return entry;
+            }
+            if (oldest == NULL) {
+                oldest = entry;
+            }
         }
     }
-#endif
+
     ENABLE_INTERRUPTS();
-    return NULL;
+    return oldest;
 }
 
 
 //=========================== private =========================================
 
 void openqueue_reset_entry(OpenQueueEntry_t *entry) {
+    // a free packet is in no TX list
+    openqueue_txListRemove(openqueue_getIndex(entry));
+
     //admin
     entry->creator = COMPONENT_NULL;
     entry->owner = COMPONENT_NULL;
-
-    // Footer is longer if security is used
-    entry->payload = &(entry->packet[IEEE802154_FRAME_SIZE - LENGTH_CRC - IEEE802154_SECURITY_TAG_LEN]);
+    if (entry->metadata != NULL) {
+        entry->metadata->isUsed = FALSE;
+        entry->metadata = NULL;
+    }
+    if (entry->packet != NULL) {
+        openqueue_freeChunk(entry->packet, entry->packet_size);
+        entry->packet = NULL;
+    }
+    entry->packet_size = 0;
+    entry->payload = NULL;
     entry->length = 0;
     entry->is_cjoin_response = FALSE;
+#if DEADLINE_OPTION
+    entry->drop_flag = FALSE;
+#endif
 #if OPENWSN_6LO_FRAGMENTATION_C
     entry->is_big_packet = FALSE;
 #endif
@@ -542,11 +894,465 @@ void openqueue_reset_entry(OpenQueueEntry_t *entry) {
     entry->l2_securityLevel = 0;
 }
 
+/**
+\brief Allocate a free entry, holding a free chunk of the given class.
+
+Called with interrupts disabled.
+
+\returns The entry, or NULL when no entry or no chunk of that class is left.
+*/
+static OpenQueueEntry_t* openqueue_getFreeEntry(uint8_t creator, uint8_t chunkClass) {
+    uint8_t i;
+    uint8_t chunk;
+
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        if (openqueue_vars.queue[i].owner == COMPONENT_NULL) {
+            chunk = openqueue_allocChunk(chunkClass);
+            if (chunk == OPENQUEUE_NO_CHUNK) {
+                return NULL;
+            }
+            openqueue_attachChunk(&openqueue_vars.queue[i], chunk);
+            openqueue_vars.queue[i].creator = creator;
+            openqueue_vars.queue[i].owner = COMPONENT_OPENQUEUE;
+            openqueue_vars.entrySeq[i] = openqueue_vars.allocSeq++;
+            return &openqueue_vars.queue[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+\brief Find a free chunk of the given class.
+
+\returns The index of the chunk, or OPENQUEUE_NO_CHUNK.
+*/
+static uint8_t openqueue_allocChunk(uint8_t chunkClass) {
+    uint8_t first;
+    uint8_t last;
+    uint8_t chunk;
+
+    switch (chunkClass) {
+        case OPENQUEUE_CHUNK_SMALL:
+            first = 0;
+            last = OPENQUEUE_FIRST_FRAME_CHUNK;
+            break;
+        case OPENQUEUE_CHUNK_FRAME:
+            first = OPENQUEUE_FIRST_FRAME_CHUNK;
+            last = OPENQUEUE_FIRST_BIG_CHUNK;
+            break;
+        default:
+            first = OPENQUEUE_FIRST_BIG_CHUNK;
+            last = OPENQUEUE_NUM_ENTRIES;
+            break;
+    }
+
+    for (chunk = first; chunk < last; chunk++) {
+        if (openqueue_vars.chunkIsUsed[chunk] == FALSE) {
+            return chunk;
+        }
+    }
+    return OPENQUEUE_NO_CHUNK;
+}
+
+/**
+\brief Give a chunk to an entry, the payload pointer is set where a new frame starts.
+
+Headers are prepended to the frame, so it starts at the end of the chunk. In
+small and frame-size chunks, room is kept after it for the MIC and the CRC.
+*/
+static void openqueue_attachChunk(OpenQueueEntry_t *entry, uint8_t chunk) {
+    openqueue_vars.chunkIsUsed[chunk] = TRUE;
+
 #if OPENWSN_6LO_FRAGMENTATION_C
-void openqueue_reset_big_entry(OpenQueueBigEntry_t *entry) {
-    openqueue_reset_entry(&(entry->standard_entry));
+    if (chunk >= OPENQUEUE_FIRST_BIG_CHUNK) {
+        entry->packet = openqueue_vars.bigChunk[chunk - OPENQUEUE_FIRST_BIG_CHUNK];
+        entry->packet_size = OPENQUEUE_BIG_CHUNK_SIZE;
+        entry->is_big_packet = TRUE;
+        entry->payload = &(entry->packet[OPENQUEUE_BIG_CHUNK_SIZE]);
+        return;
+    }
+    entry->is_big_packet = FALSE;
+#endif
+
+    if (chunk >= OPENQUEUE_FIRST_FRAME_CHUNK) {
+        entry->packet = openqueue_vars.frameChunk[chunk - OPENQUEUE_FIRST_FRAME_CHUNK];
+        entry->packet_size = OPENQUEUE_FRAME_CHUNK_SIZE;
+    } else {
+        entry->packet = openqueue_vars.smallChunk[chunk];
+        entry->packet_size = OPENQUEUE_SMALL_CHUNK_SIZE;
+    }
+
+    // Footer is longer if security is used
+    entry->payload = &(entry->packet[entry->packet_size - OPENQUEUE_CHUNK_TRAILER_LEN - LENGTH_CRC - IEEE802154_SECURITY_TAG_LEN]);
+}
+
+static void openqueue_freeChunk(uint8_t *packet, uint16_t packet_size) {
+    uint8_t chunk;
+
+    if (packet_size == OPENQUEUE_SMALL_CHUNK_SIZE) {
+        chunk = (uint8_t) ((packet - openqueue_vars.smallChunk[0]) / OPENQUEUE_SMALL_CHUNK_SIZE);
+    } else if (packet_size == OPENQUEUE_FRAME_CHUNK_SIZE) {
+        chunk = OPENQUEUE_FIRST_FRAME_CHUNK +
+                (uint8_t) ((packet - openqueue_vars.frameChunk[0]) / OPENQUEUE_FRAME_CHUNK_SIZE);
+    } else {
+#if OPENWSN_6LO_FRAGMENTATION_C
+        chunk = OPENQUEUE_FIRST_BIG_CHUNK +
+                (uint8_t) ((packet - openqueue_vars.bigChunk[0]) / OPENQUEUE_BIG_CHUNK_SIZE);
+#else
+        return;
+#endif
+    }
+    openqueue_vars.chunkIsUsed[chunk] = FALSE;
+}
+
+/**
+\brief Check whether a packet from a component above COMPONENT_SIXTOP_RES may take a buffer.
+
+Called with interrupts disabled.
+
+\param creator The component the packet comes from.
+\param source  The IPv6 source of a packet to relay, NULL for a new packet.
+
+\returns TRUE if it may, possibly after OPENQUEUE_AQM dropped relayed packets.
+*/
+static bool openqueue_admit(uint8_t creator, open_addr_t *source) {
+    while (openqueue_isHighPriorityEntryEnough() == FALSE) {
+#if OPENQUEUE_AQM
+        if (openqueue_aqmDrop(creator, source) == TRUE) {
+            continue;
+        }
+#endif
+        openqueue_vars.stats.numRefused++;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+#if OPENQUEUE_AQM
+/**
+\brief Drop relayed packets waiting for the MAC, to make room for a new packet.
+
+Expired packets go first, then one packet chosen by the OPENQUEUE_AQM policy.
+*/
+static bool openqueue_aqmDrop(uint8_t creator, open_addr_t *source) {
+#if DEADLINE_OPTION
+    if (openqueue_aqmDropExpired() == TRUE) {
+        return TRUE;
+    }
+#endif
+
+#if OPENQUEUE_AQM == OPENQUEUE_AQM_HEADDROP
+    return openqueue_aqmDropOldest();
+#else
+    return openqueue_aqmDropLongestFlow(openqueue_flowKey(creator, source));
+#endif
+}
+
+/**
+\brief A relayed packet in a frame-size buffer, waiting for the MAC.
+
+Packets being transmitted are owned by the MAC and never dropped.
+*/
+static bool openqueue_isDroppable(OpenQueueEntry_t *entry) {
+    return entry->creator == COMPONENT_FORWARDING &&
+           entry->owner == COMPONENT_SIXTOP_TO_IEEE802154E &&
+           entry->packet_size == OPENQUEUE_FRAME_CHUNK_SIZE;
+}
+
+#if DEADLINE_OPTION
+/**
+\brief Drop the relayed packets past their expiration time which have the drop flag set.
+*/
+static bool openqueue_aqmDropExpired() {
+    uint8_t i;
+    uint8_t asnArray[5];
+    asn_t now;
+    bool dropped;
 
-    // reset pointer to the end op the extended buffer
-    entry->standard_entry.payload = &(entry->standard_entry.packet[IPV6_PACKET_SIZE]);
+    ieee154e_getAsn(asnArray);
+    ieee154e_orderToASNStructure(asnArray, &now);
+
+    dropped = FALSE;
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        if (
+                openqueue_isDroppable(&openqueue_vars.queue[i]) &&
+                openqueue_vars.queue[i].drop_flag == TRUE &&
+                ieee154e_computeAsnDiff(&openqueue_vars.queue[i].l3_deadlineAsn, &now) <= 0
+                ) {
+            openqueue_reset_entry(&openqueue_vars.queue[i]);
+            openqueue_vars.stats.numDropExpired++;
+            dropped = TRUE;
+        }
+    }
+    return dropped;
 }
 #endif
+
+#if OPENQUEUE_AQM == OPENQUEUE_AQM_HEADDROP
+/**
+\brief Drop the oldest relayed packet.
+*/
+static bool openqueue_aqmDropOldest() {
+    uint8_t i;
+    uint8_t victim;
+
+    victim = OPENQUEUE_TXLIST_NONE;
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        if (
+                openqueue_isDroppable(&openqueue_vars.queue[i]) &&
+                (
+                        victim == OPENQUEUE_TXLIST_NONE ||
+                        openqueue_isOlder(i, victim)
+                )
+                ) {
+            victim = i;
+        }
+    }
+
+    if (victim == OPENQUEUE_TXLIST_NONE) {
+        return FALSE;
+    }
+    openqueue_reset_entry(&openqueue_vars.queue[victim]);
+    openqueue_vars.stats.numDropHead++;
+    return TRUE;
+}
+#endif
+
+#if OPENQUEUE_AQM == OPENQUEUE_AQM_FAIR
+
+/**
+\brief Drop the oldest packet of the longest relayed flow.
+
+Nothing is dropped unless that flow holds more buffers than the flow of the
+new packet would, with it. The flows are counted in a single pass over the
+queue, in a hash table of OPENQUEUE_NUM_FLOW_SLOTS slots on the stack.
+
+\param newFlow The flow of the new packet, see openqueue_flowKey().
+*/
+static bool openqueue_aqmDropLongestFlow(uint16_t newFlow) {
+    uint16_t flowKey[OPENQUEUE_NUM_FLOW_SLOTS];
+    uint8_t flowLength[OPENQUEUE_NUM_FLOW_SLOTS];     // 0 when the slot is free
+    uint8_t flowOldest[OPENQUEUE_NUM_FLOW_SLOTS];     // oldest droppable packet of the flow
+    uint8_t i;
+    uint16_t slot;
+    uint8_t newFlowLength;
+    uint8_t victim;
+    uint8_t victimLength;
+    uint16_t flow;
+
+    memset(flowLength, 0, sizeof(flowLength));
+
+    // the new packet counts in its own flow
+    newFlowLength = 1;
+    for (i = 0; i < OPENQUEUE_NUM_ENTRIES; i++) {
+        if (openqueue_isQueued(&openqueue_vars.queue[i]) == FALSE) {
+            continue;
+        }
+        flow = openqueue_flowKey(openqueue_vars.queue[i].creator, &openqueue_vars.queue[i].l3_sourceAdd);
+        if (flow == newFlow) {
+            newFlowLength++;
+            continue;
+        }
+
+        // linear probing, there are at least twice as many slots as entries
+        slot = (flow ^ (flow >> 8)) & (OPENQUEUE_NUM_FLOW_SLOTS - 1);
+        while (flowLength[slot] > 0 && flowKey[slot] != flow) {
+            slot = (slot + 1) & (OPENQUEUE_NUM_FLOW_SLOTS - 1);
+        }
+        if (flowLength[slot] == 0) {
+            flowKey[slot] = flow;
+            flowOldest[slot] = OPENQUEUE_TXLIST_NONE;
+        }
+        flowLength[slot]++;
+
+        if (
+                openqueue_isDroppable(&openqueue_vars.queue[i]) &&
+                (
+                        flowOldest[slot] == OPENQUEUE_TXLIST_NONE ||
+                        openqueue_isOlder(i, flowOldest[slot])
+                )
+                ) {
+            flowOldest[slot] = i;
+        }
+    }
+
+    // longest flow first, its oldest packet
+    victim = OPENQUEUE_TXLIST_NONE;
+    victimLength = 0;
+    for (slot = 0; slot < OPENQUEUE_NUM_FLOW_SLOTS; slot++) {
+        if (flowLength[slot] == 0 || flowOldest[slot] == OPENQUEUE_TXLIST_NONE) {
+            continue;
+        }
+        if (
+                flowLength[slot] > victimLength ||
+                (
+                        flowLength[slot] == victimLength &&
+                        openqueue_isOlder(flowOldest[slot], victim)
+                )
+                ) {
+            victim = flowOldest[slot];
+            victimLength = flowLength[slot];
+        }
+    }
+
+    if (victim == OPENQUEUE_TXLIST_NONE || victimLength <= newFlowLength) {
+        return FALSE;
+    }
+    openqueue_reset_entry(&openqueue_vars.queue[victim]);
+    openqueue_vars.stats.numDropFair++;
+    return TRUE;
+}
+
+/**
+\brief A packet from above COMPONENT_SIXTOP_RES, handed to the MAC.
+*/
+static bool openqueue_isQueued(OpenQueueEntry_t *entry) {
+    return entry->creator > COMPONENT_SIXTOP_RES &&
+           (
+                   entry->owner == COMPONENT_SIXTOP_TO_IEEE802154E ||
+                   entry->owner == COMPONENT_IEEE802154E
+           );
+}
+
+/**
+\brief The flow a packet belongs to.
+
+Relayed packets are told apart by the last two bytes of their IPv6 source,
+packets created by this mote by their creator.
+*/
+static uint16_t openqueue_flowKey(uint8_t creator, open_addr_t *source) {
+    if (creator != COMPONENT_FORWARDING || source == NULL) {
+        return creator;
+    }
+    switch (source->type) {
+        case ADDR_16B:
+            return OPENQUEUE_FLOW_RELAYED | ((source->addr_16b[0] << 8) | source->addr_16b[1]);
+        case ADDR_64B:
+            return OPENQUEUE_FLOW_RELAYED | ((source->addr_64b[6] << 8) | source->addr_64b[7]);
+        case ADDR_128B:
+            return OPENQUEUE_FLOW_RELAYED | ((source->addr_128b[14] << 8) | source->addr_128b[15]);
+        default:
+            return OPENQUEUE_FLOW_RELAYED;
+    }
+}
+#endif
+#endif
+
+/**
+\brief Position of an entry in the TX lists.
+*/
+static uint8_t openqueue_getIndex(OpenQueueEntry_t *entry) {
+    return (uint8_t) (entry - &openqueue_vars.queue[0]);
+}
+
+static OpenQueueEntry_t* openqueue_getEntry(uint8_t index) {
+    return &openqueue_vars.queue[index];
+}
+
+/**
+\brief Whether an entry was allocated before another one.
+*/
+static bool openqueue_isOlder(uint8_t index, uint8_t other) {
+    return (uint16_t) (openqueue_vars.allocSeq - openqueue_vars.entrySeq[index]) >
+           (uint16_t) (openqueue_vars.allocSeq - openqueue_vars.entrySeq[other]);
+}
+
+/**
+\brief TX list holding the unicast packets to a neighbor.
+
+The list of its neighbor table row, OPENQUEUE_TXLIST_NOROW if it has none.
+*/
+static uint8_t openqueue_neighborTxList(open_addr_t *neighbor) {
+    uint8_t index;
+
+    if (neighbor->type != ADDR_64B) {
+        return OPENQUEUE_TXLIST_NOROW;
+    }
+    index = neighbors_getNeighborIndex(neighbor);
+    if (index == MAXNUMNEIGHBORS) {
+        return OPENQUEUE_TXLIST_NOROW;
+    }
+    return index;
+}
+
+/**
+\brief Insert an entry in a TX list, after the entries allocated before it.
+
+Packets mostly reach the MAC in the order they were allocated, so the entry
+is usually appended without walking the list.
+*/
+static void openqueue_txListInsert(uint8_t index, uint8_t list) {
+    uint8_t previous;
+    uint8_t next;
+
+    previous = openqueue_vars.txTail[list];
+    next = OPENQUEUE_TXLIST_NONE;
+    if (previous != OPENQUEUE_TXLIST_NONE && openqueue_isOlder(index, previous)) {
+        // stops at the tail at the latest, which is younger
+        previous = OPENQUEUE_TXLIST_NONE;
+        next = openqueue_vars.txHead[list];
+        while (openqueue_isOlder(next, index)) {
+            previous = next;
+            next = openqueue_vars.txNext[next];
+        }
+    }
+
+    openqueue_vars.txList[index] = list;
+    openqueue_vars.txNext[index] = next;
+    if (previous == OPENQUEUE_TXLIST_NONE) {
+        openqueue_vars.txHead[list] = index;
+    } else {
+        openqueue_vars.txNext[previous] = index;
+    }
+    if (next == OPENQUEUE_TXLIST_NONE) {
+        openqueue_vars.txTail[list] = index;
+    }
+}
+
+static void openqueue_txListRemove(uint8_t index) {
+    uint8_t list;
+    uint8_t previous;
+
+    list = openqueue_vars.txList[index];
+    if (list == OPENQUEUE_TXLIST_NONE) {
+        return;
+    }
+    openqueue_vars.txList[index] = OPENQUEUE_TXLIST_NONE;
+
+    if (openqueue_vars.txHead[list] == index) {
+        openqueue_vars.txHead[list] = openqueue_vars.txNext[index];
+        previous = OPENQUEUE_TXLIST_NONE;
+    } else {
+        previous = openqueue_vars.txHead[list];
+        while (openqueue_vars.txNext[previous] != index) {
+            previous = openqueue_vars.txNext[previous];
+        }
+        openqueue_vars.txNext[previous] = openqueue_vars.txNext[index];
+    }
+    if (openqueue_vars.txTail[list] == index) {
+        openqueue_vars.txTail[list] = previous;
+    }
+}
+
+/**
+\brief Move the entries of a TX list to another one, keeping both oldest first.
+
+\param from     The list the entries leave.
+\param to       The list they join.
+\param neighbor Only the entries to that next hop move, all of them if NULL.
+*/
+static void openqueue_txListMove(uint8_t from, uint8_t to, open_addr_t *neighbor) {
+    uint8_t index;
+    uint8_t next;
+
+    for (index = openqueue_vars.txHead[from]; index != OPENQUEUE_TXLIST_NONE; index = next) {
+        next = openqueue_vars.txNext[index];
+        if (
+                neighbor == NULL ||
+                packetfunctions_sameAddress(neighbor, &openqueue_vars.queue[index].l2_nextORpreviousHop)
+                ) {
+            openqueue_txListRemove(index);
+            openqueue_txListInsert(index, to);
+        }
+    }
+}
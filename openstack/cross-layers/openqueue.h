@@ -26,6 +26,88 @@
 #define BIGQUEUELENGTH  0
 #endif
 
+// the frame of a packet is held in a chunk, taken from one of three classes:
+// - OPENQUEUE_NUM_SMALL_CHUNKS small chunks, for short frames such as ACKs
+//   and keep-alives
+// - QUEUELENGTH frame-size chunks, which fit any IEEE802.15.4 frame
+// - BIGQUEUELENGTH big chunks, which fit a full IPv6 packet to fragment
+// there is one queue entry per chunk, the small chunks come on top of the
+// QUEUELENGTH packet buffers
+#define OPENQUEUE_CHUNK_SMALL         0
+#define OPENQUEUE_CHUNK_FRAME         1
+#define OPENQUEUE_CHUNK_BIG           2
+
+#define OPENQUEUE_FRAME_CHUNK_SIZE    (1 + 1 + 125 + 2 + 1)  // 1B spi address, 1B length, 125B data, 2B CRC, 1B LQI
+#define OPENQUEUE_CHUNK_TRAILER_LEN   (OPENQUEUE_FRAME_CHUNK_SIZE - IEEE802154_FRAME_SIZE)
+#define OPENQUEUE_BIG_CHUNK_SIZE      IPV6_PACKET_SIZE
+
+#ifndef OPENQUEUE_SMALL_CHUNK_SIZE
+#define OPENQUEUE_SMALL_CHUNK_SIZE    48
+#endif
+
+#ifndef OPENQUEUE_NUM_SMALL_CHUNKS
+#define OPENQUEUE_NUM_SMALL_CHUNKS    4
+#endif
+
+#define OPENQUEUE_NUM_FRAME_CHUNKS    QUEUELENGTH
+#define OPENQUEUE_FIRST_FRAME_CHUNK   OPENQUEUE_NUM_SMALL_CHUNKS
+#define OPENQUEUE_FIRST_BIG_CHUNK     (OPENQUEUE_NUM_SMALL_CHUNKS + QUEUELENGTH)
+#define OPENQUEUE_NUM_ENTRIES         (OPENQUEUE_NUM_SMALL_CHUNKS + QUEUELENGTH + BIGQUEUELENGTH)
+#define OPENQUEUE_NO_CHUNK            0xff
+
+#if OPENQUEUE_NUM_SMALL_CHUNKS < 1
+#error "openqueue needs at least one small chunk."
+#endif
+
+#if OPENQUEUE_SMALL_CHUNK_SIZE >= OPENQUEUE_FRAME_CHUNK_SIZE
+#error "small chunks must be shorter than frame-size chunks."
+#endif
+
+// packets handed to the MAC are kept in TX lists, oldest first: unicast
+// packets in the list of the neighbor table row of their next hop, or in
+// OPENQUEUE_TXLIST_NOROW while it has none, EBs and broadcast DIOs in a list
+// of their own
+#define OPENQUEUE_TXLIST_NOROW        MAXNUMNEIGHBORS
+#define OPENQUEUE_TXLIST_EB           (MAXNUMNEIGHBORS + 1)
+#define OPENQUEUE_TXLIST_DIO          (MAXNUMNEIGHBORS + 2)
+#define OPENQUEUE_NUM_TXLISTS         (MAXNUMNEIGHBORS + 3)
+#define OPENQUEUE_TXLIST_NONE         0xff
+
+// rarely used metadata (6P cell lists, explicit key source) is not part of the
+// packet buffers, a packet which needs it borrows one of these entries: one
+// per 6P response sixtop may queue, plus one for a received frame with an
+// explicit key source
+#ifndef OPENQUEUE_NUM_METADATA
+#define OPENQUEUE_NUM_METADATA        (SIXTOP_MAX_TRANSACTIONS + 1)
+#endif
+
+#if OPENQUEUE_NUM_METADATA < SIXTOP_MAX_TRANSACTIONS
+#error "openqueue needs a metadata entry for each of the SIXTOP_MAX_TRANSACTIONS 6P responses."
+#endif
+
+// active queue management policies, see OPENQUEUE_AQM in config.h
+#define OPENQUEUE_AQM_NONE            0
+#define OPENQUEUE_AQM_HEADDROP        1
+#define OPENQUEUE_AQM_FAIR            2
+
+// slots of the hash table the fair policy counts the flows in, a power of 2
+// at least twice the number of entries
+#if OPENQUEUE_NUM_ENTRIES <= 8
+#define OPENQUEUE_NUM_FLOW_SLOTS      16
+#elif OPENQUEUE_NUM_ENTRIES <= 16
+#define OPENQUEUE_NUM_FLOW_SLOTS      32
+#elif OPENQUEUE_NUM_ENTRIES <= 32
+#define OPENQUEUE_NUM_FLOW_SLOTS      64
+#elif OPENQUEUE_NUM_ENTRIES <= 64
+#define OPENQUEUE_NUM_FLOW_SLOTS      128
+#else
+#define OPENQUEUE_NUM_FLOW_SLOTS      256
+#endif
+
+#if OPENQUEUE_NUM_ENTRIES >= OPENQUEUE_TXLIST_NONE
+#error "openqueue supports at most 254 packet buffers."
+#endif
+
 //=========================== typedef =========================================
 
 typedef struct {
@@ -33,13 +115,33 @@ typedef struct {
     uint8_t owner;
 } debugOpenQueueEntry_t;
 
+BEGIN_PACK
+typedef struct {
+    uint16_t numRefused;                        // packets refused, only the high priority buffers were left
+    uint16_t numDropExpired;                    // relayed packets dropped past their expiration time
+    uint16_t numDropHead;                       // oldest relayed packets dropped by head-drop
+    uint16_t numDropFair;                       // relayed packets dropped from the longest flow
+} openqueue_stats_t;
+END_PACK
+
 //=========================== module variables ================================
 
 typedef struct {
-    OpenQueueEntry_t queue[QUEUELENGTH];
+    OpenQueueEntry_t queue[OPENQUEUE_NUM_ENTRIES];
+    uint8_t smallChunk[OPENQUEUE_NUM_SMALL_CHUNKS][OPENQUEUE_SMALL_CHUNK_SIZE];
+    uint8_t frameChunk[OPENQUEUE_NUM_FRAME_CHUNKS][OPENQUEUE_FRAME_CHUNK_SIZE];
 #if OPENWSN_6LO_FRAGMENTATION_C
-    OpenQueueBigEntry_t big_queue[BIGQUEUELENGTH];
+    uint8_t bigChunk[BIGQUEUELENGTH][OPENQUEUE_BIG_CHUNK_SIZE];
 #endif
+    bool chunkIsUsed[OPENQUEUE_NUM_ENTRIES];    // small chunks, then frame-size chunks, then big chunks
+    OpenQueueMetadata_t metadata[OPENQUEUE_NUM_METADATA];
+    uint8_t txList[OPENQUEUE_NUM_ENTRIES];      // TX list each entry is in, OPENQUEUE_TXLIST_NONE if none
+    uint8_t txNext[OPENQUEUE_NUM_ENTRIES];      // next entry in the same TX list
+    uint8_t txHead[OPENQUEUE_NUM_TXLISTS];      // oldest entry of each TX list
+    uint8_t txTail[OPENQUEUE_NUM_TXLISTS];      // newest entry of each TX list
+    uint16_t allocSeq;                          // incremented for each packet buffer allocated
+    uint16_t entrySeq[OPENQUEUE_NUM_ENTRIES];   // value of allocSeq when each entry was allocated
+    openqueue_stats_t stats;
 } openqueue_vars_t;
 
 //=========================== prototypes ======================================
@@ -49,31 +151,54 @@ void openqueue_init(void);
 
 bool debugPrint_queue(void);
 
+bool debugPrint_queueStats(void);
+
 // called by any component
 OpenQueueEntry_t* openqueue_getFreePacketBuffer(uint8_t creator);
 
+OpenQueueEntry_t* openqueue_getFreeSmallPacketBuffer(uint8_t creator);
+
 #if OPENWSN_6LO_FRAGMENTATION_C
 OpenQueueEntry_t* openqueue_getFreeBigPacketBuffer(uint8_t creator);
 #endif
 
 owerror_t openqueue_freePacketBuffer(OpenQueueEntry_t *pkt);
 
+OpenQueueMetadata_t* openqueue_attachMetadata(OpenQueueEntry_t *pkt);
+
+owerror_t openqueue_resizePacketBuffer(OpenQueueEntry_t *pkt, uint8_t chunkClass);
+
 void openqueue_removeAllCreatedBy(uint8_t creator);
 
 bool openqueue_isHighPriorityEntryEnough(void);
 
+// called by forwarding
+bool openqueue_admitRelayedPacket(OpenQueueEntry_t *pkt);
+
 // called by ICMPv6
 void openqueue_updateNextHopPayload(open_addr_t *newNextHop);
 
+// called by neighbors
+void openqueue_indicateNeighborAdded(uint8_t index);
+
+void openqueue_indicateNeighborRemoved(uint8_t index);
+
 // called by res
+void openqueue_sixtopEnqueue(OpenQueueEntry_t *pkt);
+
 OpenQueueEntry_t* openqueue_sixtopGetSentPacket(void);
 
 OpenQueueEntry_t* openqueue_sixtopGetReceivedPacket(void);
 
-uint8_t openqueue_getNum6PResp(void);
+uint8_t openqueue_getNum6PResp(open_addr_t *neighbor);
+
+bool openqueue_is6PRespCell(uint8_t frameID, uint16_t slotOffset);
 
 uint8_t openqueue_getNum6PReq(open_addr_t *neighbor);
 
+// called by MSF
+uint8_t openqueue_getNumPacketsTo(open_addr_t *toNeighbor);
+
 void openqueue_remove6PrequestToNeighbor(open_addr_t *neighbor);
 
 // called by IEEE80215E
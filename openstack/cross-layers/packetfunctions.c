@@ -6,6 +6,17 @@
 #include "idmanager.h"
 #include "radio.h"
 
+//=========================== define ==========================================
+
+// end of the part of its chunk a frame can occupy
+#if OPENWSN_6LO_FRAGMENTATION_C
+#define PACKETFUNCTIONS_FRAME_END(pkt) \
+    (&(pkt)->packet[(pkt)->packet_size - ((pkt)->is_big_packet ? 0 : OPENQUEUE_CHUNK_TRAILER_LEN)])
+#else
+#define PACKETFUNCTIONS_FRAME_END(pkt) \
+    (&(pkt)->packet[(pkt)->packet_size - OPENQUEUE_CHUNK_TRAILER_LEN])
+#endif
+
 //=========================== variables =======================================
 
 //=========================== prototypes ======================================
@@ -298,87 +309,39 @@ owerror_t packetfunctions_reserveHeader(OpenQueueEntry_t **pkt, uint16_t header_
     int16_t available_bytes;
     available_bytes = IEEE802154_FRAME_SIZE - LENGTH_CRC - IEEE802154_SECURITY_TAG_LEN;
 
+    // a frame in a small chunk is known to be short, it is not moved to a larger chunk
+    if (
+            (*pkt)->packet_size == OPENQUEUE_SMALL_CHUNK_SIZE &&
+            (*pkt)->payload - (*pkt)->packet < header_length
+            ) {
+        LOG_ERROR(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_LONG,
+                  (errorparameter_t) (*pkt)->length,
+                  (errorparameter_t) header_length);
+        return E_FAIL;
+    }
+
 #if OPENWSN_6LO_FRAGMENTATION_C
     if ((*pkt)->is_big_packet == FALSE && ((*pkt)->length + header_length) > available_bytes) {
-        // CASE 1: small packet exceeding it boundaries, try copy to big packet.
+        // CASE 1: small packet exceeding it boundaries, try moving it to a big chunk
 
         // below the fragmentation layer, we cannot use big packets
         if ((*pkt)->owner < COMPONENT_FRAG) {
             return E_FAIL;
         }
 
-        OpenQueueEntry_t *bpkt;
-        if ((bpkt = openqueue_getFreeBigPacketBuffer((*pkt)->creator)) == NULL) {
-            return E_FAIL;
-        }
-
-        memcpy(bpkt, (*pkt), sizeof(OpenQueueEntry_t));
-
-        // reset some packet metadata
-        bpkt->length = 0;
-        bpkt->is_big_packet = TRUE;
-        bpkt->payload = &(((OpenQueueBigEntry_t *) bpkt)->packet_remainder[IPV6_PACKET_SIZE - IEEE802154_FRAME_SIZE]);
-
-        // copy contents from small packet to new packet
-        if (packetfunctions_reserveHeader(&bpkt, (*pkt)->length) == E_FAIL) {
-            openqueue_freePacketBuffer(bpkt);
-            return E_FAIL;
-        }
-        memcpy(bpkt->payload, (*pkt)->payload, (*pkt)->length);
-        bpkt->l4_payload = bpkt->payload + ((*pkt)->payload - (*pkt)->l4_payload);
-
-        // now reserve the original requested allocation
-        if (packetfunctions_reserveHeader(&bpkt, header_length) == E_FAIL) {
-            openqueue_freePacketBuffer(bpkt);
+        // the packet keeps its entry, only the frame is copied
+        if (openqueue_resizePacketBuffer((*pkt), OPENQUEUE_CHUNK_BIG) == E_FAIL) {
             return E_FAIL;
         }
 
         LOG_VERBOSE(COMPONENT_PACKETFUNCTIONS, ERR_COPY_TO_BPKT, (*pkt)->length + header_length, available_bytes);
-
-        // release normal OpenQueueEntry
-        openqueue_freePacketBuffer((*pkt));
-
-        // set pointer
-        (*pkt) = bpkt;
-    } else if ((*pkt)->is_big_packet == FALSE && (*pkt)->length + header_length <= available_bytes){
-        // CASE 2: within boundaries small packet, do normal allocation
-        (*pkt)->payload -= header_length;
-        (*pkt)->length += header_length;
-
-        // check for buffer overflow on the left and on the right
-        if ((uint8_t * )((*pkt)->payload) < (uint8_t * )((*pkt)->packet) ||
-            (*pkt)->payload + (*pkt)->length > &(*pkt)->packet[IEEE802154_FRAME_SIZE]) {
-            LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_LONG,
-                         (errorparameter_t) (*pkt)->length,
-                         (errorparameter_t) header_length);
-            return E_FAIL;
-        }
-
     } else if ((*pkt)->is_big_packet == TRUE && (*pkt)->length + header_length > IPV6_PACKET_SIZE) {
-        // CASE 3: is big packet already and exceeding, must fail
+        // CASE 2: is big packet already and exceeding, must fail
         LOG_ERROR(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_LONG,
                 (errorparameter_t) (*pkt)->length,
                 (errorparameter_t) header_length);
         return E_FAIL;
-    } else if ((*pkt)->is_big_packet == TRUE && (*pkt)->length + header_length <= IPV6_PACKET_SIZE) {
-        // CASE 4: is big packet and allocating normally
-        (*pkt)->payload -= header_length;
-        (*pkt)->length += header_length;
-
-        // check for buffer overflow on the left and on the right
-        if ((uint8_t * )((*pkt)->payload) < (uint8_t * )((*pkt)->packet) ||
-            (*pkt)->payload + (*pkt)->length >
-            &(((OpenQueueBigEntry_t *) (*pkt))->packet_remainder[IPV6_PACKET_SIZE - IEEE802154_FRAME_SIZE])) {
-            LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_LONG,
-                         (errorparameter_t) (*pkt)->length,
-                         (errorparameter_t) header_length);
-            return E_FAIL;
-        }
-    } else {
-        return E_FAIL;
     }
-
-    return E_SUCCESS;
 #else
     // CRC is allocated with the reserveFooter call, so here the packet should never be greater than 125 bytes
     if ((*pkt)->length + header_length > available_bytes) {
@@ -387,13 +350,14 @@ owerror_t packetfunctions_reserveHeader(OpenQueueEntry_t **pkt, uint16_t header_
                   (errorparameter_t) header_length);
         return E_FAIL;
     }
+#endif
 
     (*pkt)->payload -= header_length;
     (*pkt)->length += header_length;
 
     // check for buffer overflow on the left and on the right
     if ((uint8_t * )((*pkt)->payload) < (uint8_t * )((*pkt)->packet) ||
-        (*pkt)->payload + (*pkt)->length > &(*pkt)->packet[IEEE802154_FRAME_SIZE]) {
+        (*pkt)->payload + (*pkt)->length > PACKETFUNCTIONS_FRAME_END(*pkt)) {
         LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_LONG,
                      (errorparameter_t) (*pkt)->length,
                      (errorparameter_t) header_length);
@@ -401,7 +365,6 @@ owerror_t packetfunctions_reserveHeader(OpenQueueEntry_t **pkt, uint16_t header_
     }
 
     return E_SUCCESS;
-#endif
 }
 
 void packetfunctions_tossHeader(OpenQueueEntry_t **pkt, uint16_t header_length) {
@@ -409,68 +372,25 @@ void packetfunctions_tossHeader(OpenQueueEntry_t **pkt, uint16_t header_length)
     int16_t available_bytes;
     available_bytes = IEEE802154_FRAME_SIZE - LENGTH_CRC - IEEE802154_SECURITY_TAG_LEN;
 
-    if ((*pkt)->is_big_packet == FALSE) {
-        // CASE 1: is a small packet, just toss bytes
-        if ((uint8_t * )((*pkt)->payload + header_length) > &((*pkt)->packet[IEEE802154_FRAME_SIZE]) ||
-            (*pkt)->length - header_length < 0) {
-            LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_SHORT,
-                         (errorparameter_t) (*pkt)->length,
-                         (errorparameter_t) header_length);
-            return;
-        }
-
-        (*pkt)->payload += header_length;
-        (*pkt)->length -= header_length;
-    } else {
-        // CASE 2: is a big packet
-        if ((uint8_t * )((*pkt)->payload + header_length) >
-            &(((OpenQueueBigEntry_t *) (*pkt))->packet_remainder[IPV6_PACKET_SIZE - IEEE802154_FRAME_SIZE]) ||
-            (*pkt)->length - header_length < 0) {
-            LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_SHORT,
-                         (errorparameter_t) (*pkt)->length,
-                         (errorparameter_t) header_length);
-            return;
-
-        }
-        if ((*pkt)->length - header_length <= available_bytes){
-            // update length and payload pointer
-            (*pkt)->payload += header_length;
-            (*pkt)->length -= header_length;
-
-            // try moving to a smaller packet
-            OpenQueueEntry_t *spkt;
-            if ((spkt = openqueue_getFreePacketBuffer((*pkt)->creator)) == NULL) {
-                return;
-            }
-
-            memcpy(spkt, (*pkt), sizeof(OpenQueueEntry_t));
-
-            spkt->length = 0;
-            spkt->is_big_packet = FALSE;
-            spkt->payload = &spkt->packet[available_bytes];
-
-            if (packetfunctions_reserveHeader(&spkt, (*pkt)->length) == E_FAIL) {
-                openqueue_freePacketBuffer(spkt);
-                return;
-            }
+    if ((uint8_t * )((*pkt)->payload + header_length) > PACKETFUNCTIONS_FRAME_END(*pkt) ||
+        (*pkt)->length - header_length < 0) {
+        LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_SHORT,
+                     (errorparameter_t) (*pkt)->length,
+                     (errorparameter_t) header_length);
+        return;
+    }
 
-            memcpy(spkt->payload, (*pkt)->payload, (*pkt)->length);
-            spkt->l4_payload = spkt->payload + ((*pkt)->payload - (*pkt)->l4_payload);
+    (*pkt)->payload += header_length;
+    (*pkt)->length -= header_length;
 
+    // a big packet which became short enough moves back to a frame-size chunk
+    if ((*pkt)->is_big_packet == TRUE && (*pkt)->length <= available_bytes) {
+        if (openqueue_resizePacketBuffer((*pkt), OPENQUEUE_CHUNK_FRAME) == E_SUCCESS) {
             LOG_VERBOSE(COMPONENT_PACKETFUNCTIONS, ERR_COPY_TO_SPKT, (*pkt)->length, available_bytes);
-
-            // release OpenQueueBigEntry
-            openqueue_freePacketBuffer((*pkt));
-
-            // set pointer
-            (*pkt) = spkt;
-        } else {
-            (*pkt)->payload += header_length;
-            (*pkt)->length -= header_length;
         }
     }
 #else
-    if ((uint8_t * )((*pkt)->payload + header_length) > &(*pkt)->packet[IEEE802154_FRAME_SIZE] ||
+    if ((uint8_t * )((*pkt)->payload + header_length) > PACKETFUNCTIONS_FRAME_END(*pkt) ||
         (*pkt)->length - header_length < 0) {
         LOG_CRITICAL(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_SHORT,
                      (errorparameter_t) (*pkt)->length,
@@ -486,7 +406,7 @@ owerror_t packetfunctions_reserveFooter(OpenQueueEntry_t **pkt, uint16_t footer_
     (*pkt)->length += footer_length;
 
     // function is only called from the MAC layer, there the packets should never be bigger than IEEE802154_FRAME_SIZE
-    if ((*pkt)->length > IEEE802154_FRAME_SIZE) {
+    if ((*pkt)->length > IEEE802154_FRAME_SIZE || (*pkt)->payload + (*pkt)->length > PACKETFUNCTIONS_FRAME_END(*pkt)) {
         LOG_ERROR(COMPONENT_PACKETFUNCTIONS, ERR_PACKET_TOO_LONG,
                   (errorparameter_t) (*pkt)->length,
                   (errorparameter_t) footer_length);
@@ -508,29 +428,26 @@ void packetfunctions_tossFooter(OpenQueueEntry_t **pkt, uint16_t footer_length)
 }
 
 
-//======= packet duplication
-// function duplicates a frame from one OpenQueueEntry structure to the other,
-// updating pointers to the new memory location. Used to make a local copy of
-// the frame before transmission (where it can possibly be encrypted). 
-void packetfunctions_duplicatePacket(OpenQueueEntry_t *dst, OpenQueueEntry_t *src) {
-    // make a copy of the frame
+//======= frame duplication
+// function copies the octets of a frame from one OpenQueueEntry structure to the
+// other, along with the metadata needed to secure it. Used to make a local copy
+// of the frame before transmission, where it can be encrypted while the frame in
+// the queue remains untouched for retransmissions. The rest of the metadata is
+// not copied, it is only valid in src.
+void packetfunctions_duplicateFrame(OpenQueueEntry_t *dst, OpenQueueEntry_t *src) {
 
-    memcpy(dst, src, sizeof(OpenQueueEntry_t));
+    // the frame starts at the beginning of the chunk of dst, the rest of the chunk
+    // is left for the MIC and the CRC
+    dst->payload = dst->packet;
+    dst->length = src->length;
+    memcpy(dst->payload, src->payload, src->length);
 
-    // Calculate where payload starts in the buffer
-    dst->payload = &dst->packet[src->payload - src->packet]; // update pointers
-
-    // update l2_FrameCounter pointer
-    dst->l2_FrameCounter = dst->payload + (src->l2_FrameCounter - src->payload);
-
-    // update l2_ASNpayload pointer
-    dst->l2_ASNpayload = dst->payload + (src->l2_ASNpayload - src->payload);
+    dst->l2_frameType = src->l2_frameType;
+    dst->l2_securityLevel = src->l2_securityLevel;
+    dst->l2_authenticationLength = src->l2_authenticationLength;
 
     // update l2_payload pointer
     dst->l2_payload = dst->payload + (src->l2_payload - src->payload);
-
-    // update l4_payload pointer
-    dst->l4_payload = dst->payload + (src->l4_payload - src->payload);
 }
 
 //======= CRC calculation
@@ -52,8 +52,8 @@ owerror_t packetfunctions_reserveFooter(OpenQueueEntry_t **pkt, uint16_t footer_
 
 void packetfunctions_tossFooter(OpenQueueEntry_t **pkt, uint16_t footer_length);
 
-// packet duplication
-void packetfunctions_duplicatePacket(OpenQueueEntry_t *dst, OpenQueueEntry_t *src);
+// frame duplication
+void packetfunctions_duplicateFrame(OpenQueueEntry_t *dst, OpenQueueEntry_t *src);
 
 // calculate CRC
 void packetfunctions_calculateCRC(OpenQueueEntry_t *msg);
@@ -124,6 +124,7 @@ void oscore_init_security_context(oscore_security_context_t *ctx,
                           AES_CCM_16_64_128,
                           OSCOAP_DERIVATION_TYPE_KEY,
                           AES_CCM_16_64_128_KEY_LEN);
+    aes128_ctx_init(&ctx->senderCtx, ctx->senderKey);
     ctx->sequenceNumber = 0;
 
     // recipient context
@@ -142,6 +143,7 @@ void oscore_init_security_context(oscore_security_context_t *ctx,
                           AES_CCM_16_64_128,
                           OSCOAP_DERIVATION_TYPE_KEY,
                           AES_CCM_16_64_128_KEY_LEN);
+    aes128_ctx_init(&ctx->recipientCtx, ctx->recipientKey);
 
     ctx->window.bitArray = 0x01; // LSB set
     ctx->window.rightEdge = 0;
@@ -266,14 +268,14 @@ owerror_t oscore_protect_message(
 			   context->commonIV,
 			   AES_CCM_16_64_128_IV_LEN);
 
-    encStatus = aes128_ccms_enc(aad,
-                                aadLen,
-                                payload,
-                                &payloadLen,
-                                nonce,
-                                2, // L=2 in 15.4 std
-                                context->senderKey,
-                                AES_CCM_16_64_128_TAG_LEN);
+    encStatus = aes128_ccms_ctx_enc(aad,
+                                    aadLen,
+                                    payload,
+                                    &payloadLen,
+                                    nonce,
+                                    2, // L=2 in 15.4 std
+                                    &context->senderCtx,
+                                    AES_CCM_16_64_128_TAG_LEN);
 
     if (encStatus != E_SUCCESS) {
         return E_FAIL;
@@ -373,14 +375,14 @@ owerror_t oscore_unprotect_message(
 			   context->commonIV,
 			   AES_CCM_16_64_128_IV_LEN);
 
-    decStatus = aes128_ccms_dec(aad,
-                                aadLen,
-                                ciphertext,
-                                &ciphertextLen,
-                                nonce,
-                                2,
-                                context->recipientKey,
-                                AES_CCM_16_64_128_TAG_LEN);
+    decStatus = aes128_ccms_ctx_dec(aad,
+                                    aadLen,
+                                    ciphertext,
+                                    &ciphertextLen,
+                                    nonce,
+                                    2,
+                                    &context->recipientCtx,
+                                    AES_CCM_16_64_128_TAG_LEN);
 
     if (decStatus != E_SUCCESS) {
         LOG_ERROR(COMPONENT_OSCORE, ERR_DECRYPTION_FAILED, (errorparameter_t) 0, (errorparameter_t) 0);
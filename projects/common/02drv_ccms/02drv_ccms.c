@@ -0,0 +1,332 @@
+/**
+\brief This is a program which verifies the software CCM* implementation
+       against a suite of test vectors.
+
+Since the driver modules for different platforms have the same declaration, you
+can use this project with any platform.
+
+Every vector is run through:
+- aes128_ccms_enc() and aes128_ccms_dec();
+- the incremental interface (aes128_ccms_init(), aes128_ccms_update_a(),
+  aes128_ccms_update_m(), aes128_ccms_final()), handing the data over in
+  pieces of several lengths, in both directions;
+- aes128_ccms_dec() with a corrupted tag, which must be rejected.
+
+Vectors are from TI's example implementation, IEEE802.15.4-2011 Annex C and
+RFC3610. The last one is a maximum-length 802.15.4 frame, as secured by the
+implementation which computed the CBC-MAC and the CTR encryption in two
+separate passes.
+
+Load this program on your boards. Radio LED will stay on indefinitely if all
+tests passed. If there was an error, we use the Error LED to signal.
+*/
+
+#include "stdint.h"
+#include "stdio.h"
+#include "string.h"
+// bsp modules required
+#include "board.h"
+#include "leds.h"
+// driver modules required
+#include "aes128.h"
+#include "ccms.h"
+
+//=========================== defines =========================================
+
+#define CCMS_TEST_MAX_A      26
+#define CCMS_TEST_MAX_M      98
+#define CCMS_TEST_MAX_MAC    16
+
+typedef struct {
+    uint8_t key[16];
+    uint8_t nonce[13];
+    uint8_t len_mac;
+    uint8_t len_a;
+    uint8_t len_m;
+    uint8_t a[CCMS_TEST_MAX_A];
+    uint8_t m[CCMS_TEST_MAX_M];
+    uint8_t expected[CCMS_TEST_MAX_M + CCMS_TEST_MAX_MAC]; // ciphertext followed by tag
+} ccms_vector_t;
+
+// lengths of the pieces handed over to the incremental interface
+static const uint8_t ccms_piece_lens[] = {1, 5, 16, 0xff};
+
+static const ccms_vector_t ccms_vectors[] = {
+    { /* TI, no authentication only data and no tag */
+        { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, /* key */
+        { 0x00, 0x00, 0xf0, 0xe0, 0xd0, 0xc0, 0xb0, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x05 }, /* nonce */
+        0, /* len_mac */
+        0, /* len_a */
+        20, /* len_m */
+        { 0x00 }, /* a */
+        { 0x14, 0xaa, 0xbb, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+          0x0c, 0x0d, 0x0e, 0x0f }, /* m */
+        { 0x92, 0xe8, 0xad, 0xca, 0x53, 0x81, 0xbf, 0xd0, 0x5b, 0xdd, 0xf3, 0x61, 0x09, 0x09, 0x82, 0xe6,
+          0x2c, 0x61, 0x01, 0x4e } /* expected */
+    },
+    { /* TI, 4-octet tag */
+        { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, /* key */
+        { 0x00, 0x00, 0xf0, 0xe0, 0xd0, 0xc0, 0xb0, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x05 }, /* nonce */
+        4, /* len_mac */
+        15, /* len_a */
+        20, /* len_m */
+        { 0x69, 0x98, 0x03, 0x33, 0x63, 0xbb, 0xaa, 0x01, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x03 }, /* a */
+        { 0x14, 0xaa, 0xbb, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+          0x0c, 0x0d, 0x0e, 0x0f }, /* m */
+        { 0x92, 0xe8, 0xad, 0xca, 0x53, 0x81, 0xbf, 0xd0, 0x5b, 0xdd, 0xf3, 0x61, 0x09, 0x09, 0x82, 0xe6,
+          0x2c, 0x61, 0x01, 0x4e, 0x7b, 0x34, 0x4f, 0x09 } /* expected */
+    },
+    { /* IEEE802.15.4-2011 Annex C, authentication only (MIC-64) */
+        { 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf }, /* key */
+        { 0xac, 0xde, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x05, 0x02 }, /* nonce */
+        8, /* len_mac */
+        26, /* len_a */
+        0, /* len_m */
+        { 0x08, 0xd0, 0x84, 0x21, 0x43, 0x01, 0x00, 0x00, 0x00, 0x00, 0x48, 0xde, 0xac, 0x02, 0x05, 0x00,
+          0x00, 0x00, 0x55, 0xcf, 0x00, 0x00, 0x51, 0x52, 0x53, 0x54 }, /* a */
+        { 0x00 }, /* m */
+        { 0x22, 0x3b, 0xc1, 0xec, 0x84, 0x1a, 0xb5, 0x53 } /* expected */
+    },
+    { /* RFC3610, packet vector #1 */
+        { 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf }, /* key */
+        { 0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5 }, /* nonce */
+        8, /* len_mac */
+        8, /* len_a */
+        23, /* len_m */
+        { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }, /* a */
+        { 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+          0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e }, /* m */
+        { 0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2, 0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+          0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84, 0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0 } /* expected */
+    },
+    { /* RFC3610, packet vector #2 */
+        { 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf }, /* key */
+        { 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5 }, /* nonce */
+        8, /* len_mac */
+        8, /* len_a */
+        24, /* len_m */
+        { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }, /* a */
+        { 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+          0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }, /* m */
+        { 0x72, 0xc9, 0x1a, 0x36, 0xe1, 0x35, 0xf8, 0xcf, 0x29, 0x1c, 0xa8, 0x94, 0x08, 0x5c, 0x87, 0xe3,
+          0xcc, 0x15, 0xc4, 0x39, 0xc9, 0xe4, 0x3a, 0x3b, 0xa0, 0x91, 0xd5, 0x6e, 0x10, 0x40, 0x09, 0x16 } /* expected */
+    },
+    { /* maximum-length frame (ENC-MIC-32), a and m are filled in by ccms_fillFrame() */
+        { 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf }, /* key */
+        { 0xac, 0xde, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x05, 0x06 }, /* nonce */
+        4, /* len_mac */
+        23, /* len_a */
+        98, /* len_m */
+        { 0x00 }, /* a */
+        { 0x00 }, /* m */
+        { 0xb4, 0x00, 0xd7, 0x03, 0xb1, 0x3c, 0xbe, 0x0d, 0x6b, 0x2a, 0xae, 0x08, 0xff, 0x00, 0xef, 0xf4,
+          0x53, 0xc8, 0xf2, 0x00, 0xb6, 0x52, 0x0c, 0x21, 0x8d, 0x27, 0x59, 0xdf, 0xd7, 0xb7, 0xbe, 0x32,
+          0x46, 0xb1, 0xc3, 0x76, 0x0a, 0x05, 0xdb, 0xfe, 0x5a, 0xb4, 0x5d, 0x2c, 0xc6, 0xc2, 0xc6, 0x2d,
+          0x4d, 0x22, 0x11, 0x81, 0x25, 0x04, 0xc3, 0x92, 0xa5, 0x68, 0xcc, 0x0a, 0x6e, 0x41, 0x3d, 0xc3,
+          0x16, 0x72, 0x04, 0xa7, 0x9c, 0x5d, 0xdf, 0x29, 0x73, 0x76, 0x8e, 0x05, 0x32, 0xbd, 0x28, 0x17,
+          0xe5, 0x80, 0x0c, 0xd3, 0xfe, 0x3d, 0x0a, 0x86, 0xde, 0x5d, 0xd0, 0x12, 0x84, 0x97, 0x11, 0xf7,
+          0x6c, 0xf5, 0xe9, 0x72, 0x36, 0xff } /* expected */
+    },
+};
+
+#define CCMS_FRAME_VECTOR    (sizeof(ccms_vectors) / sizeof(ccms_vectors[0]) - 1)
+
+//=========================== variables =======================================
+
+typedef struct {
+    aes128_ctx_t        ctx;
+    aes128_ccms_state_t state;
+    uint8_t             a[CCMS_TEST_MAX_A];
+    uint8_t             m[CCMS_TEST_MAX_M + CCMS_TEST_MAX_MAC];
+    uint8_t             numFailed;
+} app_vars_t;
+
+app_vars_t app_vars;
+
+//=========================== prototypes ======================================
+
+void    ccms_load(uint8_t index);
+void    ccms_fillFrame(void);
+uint8_t ccms_runOneShot(const ccms_vector_t *v);
+uint8_t ccms_runIncremental(const ccms_vector_t *v, uint8_t piece_len, bool encrypt);
+uint8_t ccms_runCorrupted(const ccms_vector_t *v);
+uint8_t ccms_feed(uint8_t *buf, uint8_t len, uint8_t piece_len, bool is_a);
+
+//=========================== main ============================================
+
+/**
+\brief The program starts executing here.
+*/
+int mote_main(void) {
+    uint8_t i;
+    uint8_t j;
+
+    memset(&app_vars, 0, sizeof(app_vars_t));
+
+    board_init();
+
+    leds_all_off();
+
+    for (i = 0; i < sizeof(ccms_vectors) / sizeof(ccms_vectors[0]); i++) {
+        aes128_ctx_init(&app_vars.ctx, (uint8_t *) ccms_vectors[i].key);
+
+        ccms_load(i);
+        app_vars.numFailed += ccms_runOneShot(&ccms_vectors[i]);
+
+        for (j = 0; j < sizeof(ccms_piece_lens); j++) {
+            ccms_load(i);
+            app_vars.numFailed += ccms_runIncremental(&ccms_vectors[i], ccms_piece_lens[j], TRUE);
+            ccms_load(i);
+            app_vars.numFailed += ccms_runIncremental(&ccms_vectors[i], ccms_piece_lens[j], FALSE);
+        }
+
+        ccms_load(i);
+        app_vars.numFailed += ccms_runCorrupted(&ccms_vectors[i]);
+    }
+
+    if (app_vars.numFailed) {
+        leds_error_on();
+    } else {
+        leds_radio_on();
+    }
+
+    while (1) {
+        board_sleep();
+    }
+}
+
+//=========================== private =========================================
+
+/**
+\brief Copy the plaintext of a vector into the work buffers.
+*/
+void ccms_load(uint8_t index) {
+    memcpy(app_vars.a, ccms_vectors[index].a, CCMS_TEST_MAX_A);
+    memcpy(app_vars.m, ccms_vectors[index].m, CCMS_TEST_MAX_M);
+    if (index == CCMS_FRAME_VECTOR) {
+        ccms_fillFrame();
+    }
+}
+
+void ccms_fillFrame(void) {
+    uint8_t i;
+
+    for (i = 0; i < ccms_vectors[CCMS_FRAME_VECTOR].len_a; i++) {
+        app_vars.a[i] = (uint8_t)(i * 7 + 1);
+    }
+    for (i = 0; i < ccms_vectors[CCMS_FRAME_VECTOR].len_m; i++) {
+        app_vars.m[i] = (uint8_t)((ccms_vectors[CCMS_FRAME_VECTOR].len_a + i) * 7 + 1);
+    }
+}
+
+/**
+\brief Encrypt and decrypt the vector with the one-shot functions.
+
+\returns The number of failed checks.
+*/
+uint8_t ccms_runOneShot(const ccms_vector_t *v) {
+    uint8_t plaintext[CCMS_TEST_MAX_M];
+    uint8_t len_m;
+    uint8_t failed;
+
+    failed = 0;
+    memcpy(plaintext, app_vars.m, CCMS_TEST_MAX_M);
+
+    len_m = v->len_m;
+    if (aes128_ccms_enc(app_vars.a, v->len_a, app_vars.m, &len_m, (uint8_t *) v->nonce, 2,
+                        (uint8_t *) v->key, v->len_mac) != E_SUCCESS ||
+        len_m != v->len_m + v->len_mac ||
+        memcmp(app_vars.m, v->expected, len_m) != 0) {
+        failed++;
+    }
+
+    if (aes128_ccms_dec(app_vars.a, v->len_a, app_vars.m, &len_m, (uint8_t *) v->nonce, 2,
+                        (uint8_t *) v->key, v->len_mac) != E_SUCCESS ||
+        len_m != v->len_m ||
+        memcmp(app_vars.m, plaintext, len_m) != 0) {
+        failed++;
+    }
+
+    return failed;
+}
+
+/**
+\brief Run the vector through the incremental interface, piece by piece.
+
+The inverse transformation starts from the expected ciphertext.
+
+\returns The number of failed checks.
+*/
+uint8_t ccms_runIncremental(const ccms_vector_t *v, uint8_t piece_len, bool encrypt) {
+    uint8_t plaintext[CCMS_TEST_MAX_M];
+
+    memcpy(plaintext, app_vars.m, CCMS_TEST_MAX_M);
+    if (encrypt == FALSE) {
+        memcpy(app_vars.m, v->expected, v->len_m + v->len_mac);
+    }
+
+    if (aes128_ccms_init(&app_vars.state, &app_vars.ctx, (uint8_t *) v->nonce, 2,
+                         v->len_a, v->len_m, v->len_mac, encrypt) != E_SUCCESS) {
+        return 1;
+    }
+
+    if (ccms_feed(app_vars.a, v->len_a, piece_len, TRUE) != 0 ||
+        ccms_feed(app_vars.m, v->len_m, piece_len, FALSE) != 0) {
+        return 1;
+    }
+
+    if (aes128_ccms_final(&app_vars.state, &app_vars.m[v->len_m]) != E_SUCCESS) {
+        return 1;
+    }
+
+    if (encrypt) {
+        return memcmp(app_vars.m, v->expected, v->len_m + v->len_mac) == 0 ? 0 : 1;
+    }
+    return memcmp(app_vars.m, plaintext, v->len_m) == 0 ? 0 : 1;
+}
+
+/**
+\brief Verify that a frame with a corrupted tag is rejected.
+
+\returns The number of failed checks.
+*/
+uint8_t ccms_runCorrupted(const ccms_vector_t *v) {
+    uint8_t len_m;
+
+    if (v->len_mac == 0) {
+        return 0;
+    }
+
+    memcpy(app_vars.m, v->expected, v->len_m + v->len_mac);
+    app_vars.m[v->len_m + v->len_mac - 1] ^= 0x01;
+    len_m = v->len_m + v->len_mac;
+
+    if (aes128_ccms_dec(app_vars.a, v->len_a, app_vars.m, &len_m, (uint8_t *) v->nonce, 2,
+                        (uint8_t *) v->key, v->len_mac) != E_FAIL) {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+\brief Hand a buffer over to the incremental interface in pieces of piece_len octets.
+
+\returns The number of pieces which were refused.
+*/
+uint8_t ccms_feed(uint8_t *buf, uint8_t len, uint8_t piece_len, bool is_a) {
+    uint8_t done;
+    uint8_t piece;
+    uint8_t failed;
+
+    failed = 0;
+    for (done = 0; done < len; done += piece) {
+        piece = len - done < piece_len ? len - done : piece_len;
+        if (is_a) {
+            failed += aes128_ccms_update_a(&app_vars.state, &buf[done], piece) == E_SUCCESS ? 0 : 1;
+        } else {
+            failed += aes128_ccms_update_m(&app_vars.state, &buf[done], piece) == E_SUCCESS ? 0 : 1;
+        }
+    }
+
+    return failed;
+}
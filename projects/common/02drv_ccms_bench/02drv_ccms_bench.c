@@ -0,0 +1,159 @@
+/**
+\brief This is a program which benchmarks the software CCM* implementation.
+
+Since the driver modules for different platforms have the same declaration, you
+can use this project with any platform.
+
+This application secures BENCH_NUM_FRAMES maximum-length frames (IEEE802.15.4
+header authenticated, payload encrypted, 4-octet tag), the way
+IEEE802154_security does it, once with each of:
+- aes128_ccms_enc(), which expands the key at the beginning of every frame;
+- aes128_ccms_ctx_enc(), with a key context expanded once beforehand.
+
+It also encrypts BENCH_NUM_BLOCKS single blocks with aes128_enc(), which
+expands the key for every block, and with aes128_ctx_enc(). The former is what
+CCM* used to do for each of the ~18 blocks of a frame.
+
+The time spent in each variant is accumulated in app_vars, in sctimer ticks.
+Both variants must produce the same ciphertext, app_vars.numMismatches counts
+the frames where they do not. When the benchmark is done, the error LED is
+switched on and the results can be read out with a debugger.
+
+Build it once per AES implementation, i.e. byte-oriented software, table-driven
+software and the crypto engine of the board:
+   scons board=<board> toolchain=<toolchain> drv_ccms_bench
+   scons board=<board> toolchain=<toolchain> boardopt=aes-ttable drv_ccms_bench
+   scons board=<board> toolchain=<toolchain> boardopt=hw-crypto drv_ccms_bench
+With the crypto engine, the one-shot CCM* functions and aes128_ctx_enc() use the
+hardware, while aes128_enc() remains in software.
+*/
+
+#include "stdint.h"
+#include "stdio.h"
+#include "string.h"
+// bsp modules required
+#include "board.h"
+#include "leds.h"
+#include "sctimer.h"
+// driver modules required
+#include "aes128.h"
+#include "ccms.h"
+
+//=========================== defines =========================================
+
+#define BENCH_NUM_FRAMES     200
+#define BENCH_NUM_BLOCKS     2000
+#define BENCH_LEN_A          23       // header and auxiliary security header
+#define BENCH_LEN_M          98       // payload, leaves room for tag and CRC
+#define BENCH_LEN_MAC        4
+
+static const uint8_t bench_key[16] = {
+    0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+    0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+
+//=========================== variables =======================================
+
+typedef struct {
+    aes128_ctx_t     ctx;
+    uint8_t          frame[BENCH_LEN_A + BENCH_LEN_M + BENCH_LEN_MAC];
+    uint8_t          frameCtx[BENCH_LEN_A + BENCH_LEN_M + BENCH_LEN_MAC];
+    uint8_t          nonce[13];
+    uint8_t          block[16];
+    // results, in sctimer ticks
+    uint32_t         ticksCtxInit;
+    uint32_t         ticksFrameKey;
+    uint32_t         ticksFrameCtx;
+    uint32_t         ticksBlockKey;
+    uint32_t         ticksBlockCtx;
+    uint16_t         numMismatches;
+} app_vars_t;
+
+app_vars_t app_vars;
+
+//=========================== prototypes ======================================
+
+void bench_fillFrame(uint8_t *frame, uint16_t seqNum);
+
+//=========================== main ============================================
+
+/**
+\brief The program starts executing here.
+*/
+int mote_main(void) {
+    PORT_TIMER_WIDTH start;
+    uint16_t         i;
+    uint8_t          len_m;
+
+    memset(&app_vars, 0, sizeof(app_vars_t));
+
+    board_init();
+
+    start = sctimer_readCounter();
+    aes128_ctx_init(&app_vars.ctx, (uint8_t *) bench_key);
+    app_vars.ticksCtxInit = (PORT_TIMER_WIDTH)(sctimer_readCounter() - start);
+
+    for (i = 0; i < BENCH_NUM_FRAMES; i++) {
+        // the nonce changes with the ASN
+        app_vars.nonce[12] = (uint8_t) i;
+        app_vars.nonce[11] = (uint8_t)(i >> 8);
+
+        bench_fillFrame(app_vars.frame, i);
+        len_m = BENCH_LEN_M;
+        start = sctimer_readCounter();
+        aes128_ccms_enc(app_vars.frame,
+                        BENCH_LEN_A,
+                        &app_vars.frame[BENCH_LEN_A],
+                        &len_m,
+                        app_vars.nonce,
+                        2,
+                        (uint8_t *) bench_key,
+                        BENCH_LEN_MAC);
+        app_vars.ticksFrameKey += (PORT_TIMER_WIDTH)(sctimer_readCounter() - start);
+
+        bench_fillFrame(app_vars.frameCtx, i);
+        len_m = BENCH_LEN_M;
+        start = sctimer_readCounter();
+        aes128_ccms_ctx_enc(app_vars.frameCtx,
+                            BENCH_LEN_A,
+                            &app_vars.frameCtx[BENCH_LEN_A],
+                            &len_m,
+                            app_vars.nonce,
+                            2,
+                            &app_vars.ctx,
+                            BENCH_LEN_MAC);
+        app_vars.ticksFrameCtx += (PORT_TIMER_WIDTH)(sctimer_readCounter() - start);
+
+        if (memcmp(app_vars.frame, app_vars.frameCtx, sizeof(app_vars.frame)) != 0) {
+            app_vars.numMismatches++;
+        }
+    }
+
+    start = sctimer_readCounter();
+    for (i = 0; i < BENCH_NUM_BLOCKS; i++) {
+        aes128_enc(app_vars.block, (uint8_t *) bench_key);
+    }
+    app_vars.ticksBlockKey = (PORT_TIMER_WIDTH)(sctimer_readCounter() - start);
+
+    start = sctimer_readCounter();
+    for (i = 0; i < BENCH_NUM_BLOCKS; i++) {
+        aes128_ctx_enc(app_vars.block, &app_vars.ctx);
+    }
+    app_vars.ticksBlockCtx = (PORT_TIMER_WIDTH)(sctimer_readCounter() - start);
+
+    // done
+    leds_error_on();
+    while (1) {
+        board_sleep();
+    }
+}
+
+//=========================== private =========================================
+
+void bench_fillFrame(uint8_t *frame, uint16_t seqNum) {
+    uint8_t i;
+
+    for (i = 0; i < BENCH_LEN_A + BENCH_LEN_M; i++) {
+        frame[i] = (uint8_t)(seqNum + i);
+    }
+}
@@ -101,7 +101,7 @@ open_addr_t* idmanager_getMyID(uint8_t type) {
     return &app_vars.addr;
 }
 
-void scheduler_push_task(task_cbt task_cb, task_prio_t prio){}
+owerror_t scheduler_push_task(task_cbt task_cb, task_prio_t prio){ return E_SUCCESS; }
 
 void ieee154e_getAsn(uint8_t* array) {
    array[0]   = 0x00;
@@ -184,3 +184,9 @@ bool debugPrint_joined(void) {
 bool debugPrint_msf(void) {
     return FALSE;
 }
+bool debugPrint_taskProfile(void) {
+    return FALSE;
+}
+bool debugPrint_queueStats(void) {
+    return FALSE;
+}
@@ -0,0 +1,175 @@
+/**
+\brief This is a program which benchmarks the "opentimers" driver module.
+
+Since the driver modules for different platforms have the same declaration, you
+can use this project with any platform.
+
+This application creates all the general purpose timers opentimers can hold,
+arms them with pseudo-random durations and then replays BENCH_NUM_ROUNDS timer
+interrupts back-to-back, with interrupts disabled. Simulated time jumps from
+one compare value to the next, so the run does not depend on the durations.
+After each interrupt, the timers which fired are re-armed relative to the
+compare value which fired them.
+
+The time spent scheduling, in the interrupt and cancelling is accumulated in
+app_vars, in sctimer ticks. Individual calls are usually shorter than a tick,
+so the totals are only meaningful over many rounds. When the benchmark is
+done, the error LED is switched on and the results can be read out with a
+debugger.
+
+Build it with many timers, and once with and once without the heap engine:
+   scons board=<board> toolchain=<toolchain> stackcfg=max-timers:200 drv_opentimers_bench
+   scons board=<board> toolchain=<toolchain> stackcfg=max-timers:200,timers-heap drv_opentimers_bench
+
+drv_opentimers_bench_host builds it as a native program which prints the
+results, see projects/python/opentimers_bench_host.c.
+*/
+
+#include "stdint.h"
+#include "stdio.h"
+#include "string.h"
+// bsp modules required
+#include "board.h"
+#include "leds.h"
+#include "sctimer.h"
+// driver modules required
+#include "opentimers.h"
+// kernel modules required
+#include "scheduler.h"
+
+//=========================== defines =========================================
+
+#define BENCH_NUM_TIMERS     (MAX_NUM_TIMERS-TIMER_NUMBER_NON_GENERAL)
+#define BENCH_NUM_ROUNDS     2000
+#define BENCH_MIN_TICKS      328      // 10ms @ 32kHz
+#define BENCH_MAX_TICKS      16384    // 500ms @ 32kHz
+
+//=========================== variables =======================================
+
+typedef struct {
+    opentimers_id_t  timerIds[BENCH_NUM_TIMERS];
+    uint16_t         random;
+    // results, in sctimer ticks
+    uint32_t         numScheduled;
+    uint32_t         ticksSchedule;
+    uint32_t         numFired;
+    uint32_t         ticksIsr;
+    PORT_TIMER_WIDTH maxTicksIsr;
+    uint32_t         ticksCancel;
+} app_vars_t;
+
+app_vars_t app_vars;
+
+//=========================== prototypes ======================================
+
+void     opentimers_timer_callback(void);
+void     timer_cb(opentimers_id_t id);
+uint32_t bench_randomDuration(void);
+
+//=========================== main ============================================
+
+/**
+\brief The program starts executing here.
+*/
+int mote_main(void) {
+    PORT_TIMER_WIDTH now;
+    PORT_TIMER_WIDTH start;
+    PORT_TIMER_WIDTH duration;
+    uint16_t         round;
+    uint16_t         i;
+
+    INTERRUPT_DECLARATION();
+
+    memset(&app_vars,0,sizeof(app_vars_t));
+    app_vars.random = 0xace1;
+
+    board_init();
+    opentimers_init();
+
+    // the interrupts are replayed by hand
+    DISABLE_INTERRUPTS();
+
+    for (i=0;i<BENCH_NUM_TIMERS;i++) {
+        app_vars.timerIds[i] = opentimers_create(TIMER_GENERAL_PURPOSE, TASKPRIO_NONE);
+    }
+
+    now = opentimers_getValue();
+    for (i=0;i<BENCH_NUM_TIMERS;i++) {
+        start = sctimer_readCounter();
+        opentimers_scheduleAbsolute(
+            app_vars.timerIds[i],           // id
+            bench_randomDuration(),         // duration
+            now,                            // reference
+            TIME_TICS,                      // time_type
+            timer_cb                        // callback
+        );
+        app_vars.ticksSchedule += (PORT_TIMER_WIDTH)(sctimer_readCounter()-start);
+        app_vars.numScheduled++;
+    }
+
+    for (round=0;round<BENCH_NUM_ROUNDS;round++) {
+        // time jumps to the next compare value
+        now = opentimers_getCurrentCompareValue();
+
+        start    = sctimer_readCounter();
+        opentimers_timer_callback();
+        duration = sctimer_readCounter()-start;
+        app_vars.ticksIsr += duration;
+        if (duration>app_vars.maxTicksIsr) {
+            app_vars.maxTicksIsr = duration;
+        }
+
+        // re-arm the timers which fired
+        for (i=0;i<BENCH_NUM_TIMERS;i++) {
+            if (opentimers_isRunning(app_vars.timerIds[i])==FALSE) {
+                start = sctimer_readCounter();
+                opentimers_scheduleAbsolute(
+                    app_vars.timerIds[i],   // id
+                    bench_randomDuration(), // duration
+                    now,                    // reference
+                    TIME_TICS,              // time_type
+                    timer_cb                // callback
+                );
+                app_vars.ticksSchedule += (PORT_TIMER_WIDTH)(sctimer_readCounter()-start);
+                app_vars.numScheduled++;
+            }
+        }
+    }
+
+    start = sctimer_readCounter();
+    for (i=0;i<BENCH_NUM_TIMERS;i++) {
+        opentimers_cancel(app_vars.timerIds[i]);
+    }
+    app_vars.ticksCancel = (PORT_TIMER_WIDTH)(sctimer_readCounter()-start);
+
+    ENABLE_INTERRUPTS();
+
+    // done
+    leds_error_on();
+    while(1) {
+        board_sleep();
+    }
+}
+
+//=========================== callbacks =======================================
+
+void timer_cb(opentimers_id_t id) {
+}
+
+//=========================== private =========================================
+
+uint32_t bench_randomDuration(void) {
+    // 16-bit Galois LFSR
+    app_vars.random = (app_vars.random>>1) ^ (-(app_vars.random&1) & 0xb400);
+    return BENCH_MIN_TICKS+(app_vars.random%(BENCH_MAX_TICKS-BENCH_MIN_TICKS));
+}
+
+//=========================== stub functions ==================================
+
+/**
+\brief Expired timers are counted rather than executed.
+*/
+owerror_t scheduler_push_task(task_cbt cb, task_prio_t prio) {
+    app_vars.numFired++;
+    return E_SUCCESS;
+}
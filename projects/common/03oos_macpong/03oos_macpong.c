@@ -203,6 +203,10 @@ void icmpv6rpl_setMyDAGrank(dagrank_t rank) { return; }
 
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void) { return; }
 
+void icmpv6rpl_updateCandidateParent(uint8_t index) { return; }
+
+void icmpv6rpl_indicateNeighborUpdate(uint8_t index) { return; }
+
 void icmpv6echo_setIsReplyEnabled(bool isEnabled) { return; }
 
 
@@ -228,6 +228,10 @@ void icmpv6rpl_writeDODAGid(uint8_t *dodagid) { return; }
 
 void icmpv6rpl_updateMyDAGrankAndParentSelection(void) { return; }
 
+void icmpv6rpl_updateCandidateParent(uint8_t index) { return; }
+
+void icmpv6rpl_indicateNeighborUpdate(uint8_t index) { return; }
+
 bool icmpv6rpl_getPreferredParentEui64(open_addr_t *neighbor) { return TRUE; }
 
 void icmpv6echo_setIsReplyEnabled(bool isEnabled) { return; }
@@ -0,0 +1,82 @@
+/**
+\brief Host build of the 02drv_opentimers_bench project.
+
+The benchmark and opentimers are compiled as they are, without objectification,
+against the stub BSP below, into a native program rather than a Python
+extension module:
+   scons board=python toolchain=gcc stackcfg=max-timers:200 drv_opentimers_bench_host
+   scons board=python toolchain=gcc stackcfg=max-timers:200,timers-heap drv_opentimers_bench_host
+
+The sctimer counter runs on the monotonic clock of the host, one tick per
+microsecond, so the totals of the benchmark are in microseconds. They are
+printed when the benchmark is done.
+*/
+
+#include "time.h"
+#include "stdlib.h"
+
+// the benchmark itself, its app_vars are printed at the end
+#include "02drv_opentimers_bench.c"
+
+//=========================== main ============================================
+
+int main(void) {
+    return mote_main();
+}
+
+//=========================== board ===========================================
+
+void board_init(void) {
+}
+
+/**
+\brief Called once the benchmark is done, prints the results and exits.
+*/
+void board_sleep(void) {
+    printf("timers:    %d, rounds: %d\n", BENCH_NUM_TIMERS, BENCH_NUM_ROUNDS);
+    printf("schedule:  %u calls, %u us\n", app_vars.numScheduled, app_vars.ticksSchedule);
+    printf("interrupt: %u timers fired, %u us, at most %u us\n", app_vars.numFired, app_vars.ticksIsr, app_vars.maxTicksIsr);
+    printf("cancel:    %d calls, %u us\n", BENCH_NUM_TIMERS, app_vars.ticksCancel);
+    exit(0);
+}
+
+void board_reset(void) {
+    exit(1);
+}
+
+//=========================== leds ============================================
+
+void leds_error_on(void) {
+}
+
+void leds_error_blink(void) {
+}
+
+//=========================== debugpins =======================================
+
+void debugpins_isr_set(void) {
+}
+
+void debugpins_isr_clr(void) {
+}
+
+//=========================== sctimer =========================================
+
+void sctimer_set_callback(sctimer_cbt cb) {
+}
+
+void sctimer_setCompare(PORT_TIMER_WIDTH val) {
+}
+
+PORT_TIMER_WIDTH sctimer_readCounter(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (PORT_TIMER_WIDTH) (now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+void sctimer_enable(void) {
+}
+
+void sctimer_disable(void) {
+}
@@ -0,0 +1,174 @@
+/**
+\brief Host test of the placement of the MSF autonomous cells.
+
+Places the autonomous cells of networks of 200 motes, 4 production batches of
+50 sequential EUI64s each, with msf_hashFunction_getSlotoffset() and
+msf_hashFunction_getChanneloffset(). Over TEST_NUM_NETWORKS networks, fewer
+motes must share their autonomous cell with another mote than with the
+placements MSF used before: the last two bytes of the EUI64, and the plain
+SAX hash of RFC9033 with both offsets taken from its low bits. Placed at
+random, about 23 motes out of 200 would.
+
+msf.c is linked with --gc-sections, so only the hash functions are kept:
+   scons board=python toolchain=gcc test_msf_hash
+*/
+
+#include "stdio.h"
+#include "string.h"
+#include "opendefs.h"
+#include "schedule.h"
+#include "msf.h"
+#include "IEEE802154E.h"
+
+//=========================== defines =========================================
+
+#define TEST_NUM_NETWORKS    16
+#define TEST_NUM_BATCHES     4
+#define TEST_BATCH_SIZE      50
+#define TEST_NUM_MOTES       (TEST_NUM_BATCHES * TEST_BATCH_SIZE)
+#define TEST_NUM_SLOTS       (SLOTFRAME_LENGTH - SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS)
+
+//=========================== variables =======================================
+
+typedef struct {
+    uint16_t slotOffset;
+    uint8_t  channelOffset;
+} cell_t;
+
+typedef struct {
+    uint16_t random;
+    uint8_t  batchStart[TEST_NUM_BATCHES][LENGTH_ADDR64b]; // first EUI64 of each batch, the other ones follow
+} test_vars_t;
+
+test_vars_t test_vars;
+
+//=========================== prototypes ======================================
+
+static void     test_newNetwork(void);
+static void     test_eui64(open_addr_t *address, uint8_t mote);
+static void     test_placeLastBytes(open_addr_t *address, cell_t *cell);
+static void     test_placeSax(open_addr_t *address, cell_t *cell);
+static void     test_placeMsf(open_addr_t *address, cell_t *cell);
+static uint16_t test_numColliding(void (*place)(open_addr_t *, cell_t *));
+
+//=========================== main ============================================
+
+int main(void) {
+    uint8_t  network;
+    uint16_t lastBytes;
+    uint16_t sax;
+    uint16_t msf;
+
+    memset(&test_vars, 0, sizeof(test_vars_t));
+    test_vars.random = 0xace1;
+
+    lastBytes = 0;
+    sax       = 0;
+    msf       = 0;
+    for (network = 0; network < TEST_NUM_NETWORKS; network++) {
+        test_newNetwork();
+        lastBytes += test_numColliding(test_placeLastBytes);
+        sax       += test_numColliding(test_placeSax);
+        msf       += test_numColliding(test_placeMsf);
+    }
+
+    printf("motes sharing their autonomous cell, out of %d in %d networks:\n",
+           TEST_NUM_NETWORKS * TEST_NUM_MOTES, TEST_NUM_NETWORKS);
+    printf("   last two bytes: %d\n", lastBytes);
+    printf("   RFC9033 SAX:    %d\n", sax);
+    printf("   MSF:            %d\n", msf);
+
+    if (msf >= lastBytes || msf >= sax) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
+
+//=========================== private =========================================
+
+/**
+\brief Draw the first EUI64 of each batch of a new network.
+*/
+static void test_newNetwork(void) {
+    uint8_t batch;
+    uint8_t i;
+
+    for (batch = 0; batch < TEST_NUM_BATCHES; batch++) {
+        for (i = 0; i < LENGTH_ADDR64b; i++) {
+            // 16-bit Galois LFSR
+            test_vars.random = (test_vars.random >> 1) ^ (-(test_vars.random & 1) & 0xb400);
+            test_vars.batchStart[batch][i] = (uint8_t) test_vars.random;
+        }
+    }
+}
+
+static void test_eui64(open_addr_t *address, uint8_t mote) {
+    uint8_t i;
+
+    address->type = ADDR_64B;
+    memcpy(address->addr_64b, test_vars.batchStart[mote / TEST_BATCH_SIZE], LENGTH_ADDR64b);
+    for (i = 0; i < mote % TEST_BATCH_SIZE; i++) {
+        // increment as a big-endian number
+        if (++address->addr_64b[7] == 0 && ++address->addr_64b[6] == 0) {
+            address->addr_64b[5]++;
+        }
+    }
+}
+
+static void test_placeLastBytes(open_addr_t *address, cell_t *cell) {
+    uint16_t moteId;
+
+    moteId = (address->addr_64b[6] << 8) + address->addr_64b[7];
+    cell->slotOffset    = SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS + moteId % TEST_NUM_SLOTS;
+    cell->channelOffset = moteId % NUM_CHANNELS;
+}
+
+static void test_placeSax(open_addr_t *address, cell_t *cell) {
+    uint8_t  i;
+    uint16_t hash;
+
+    hash = 0;
+    for (i = 0; i < LENGTH_ADDR64b; i++) {
+        hash ^= (hash << SAX_LEFT_SHIFT) + (hash >> SAX_RIGHT_SHIFT) + address->addr_64b[i];
+    }
+    cell->slotOffset    = SCHEDULE_MINIMAL_6TISCH_ACTIVE_CELLS + hash % TEST_NUM_SLOTS;
+    cell->channelOffset = hash % NUM_CHANNELS;
+}
+
+static void test_placeMsf(open_addr_t *address, cell_t *cell) {
+    cell->slotOffset    = msf_hashFunction_getSlotoffset(address);
+    cell->channelOffset = msf_hashFunction_getChanneloffset(address);
+}
+
+/**
+\brief Count the motes whose autonomous cell is also the one of another mote.
+*/
+static uint16_t test_numColliding(void (*place)(open_addr_t *, cell_t *)) {
+    open_addr_t address;
+    cell_t      cells[TEST_NUM_MOTES];
+    uint8_t     i;
+    uint8_t     j;
+    uint16_t    numColliding;
+
+    for (i = 0; i < TEST_NUM_MOTES; i++) {
+        test_eui64(&address, i);
+        place(&address, &cells[i]);
+    }
+
+    numColliding = 0;
+    for (i = 0; i < TEST_NUM_MOTES; i++) {
+        for (j = 0; j < TEST_NUM_MOTES; j++) {
+            if (
+                i != j &&
+                cells[i].slotOffset == cells[j].slotOffset &&
+                cells[i].channelOffset == cells[j].channelOffset
+            ) {
+                numColliding++;
+                break;
+            }
+        }
+    }
+    return numColliding;
+}
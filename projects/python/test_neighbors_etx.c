@@ -0,0 +1,168 @@
+/**
+\brief Host test of the ETX estimator of the neighbor table.
+
+Drives neighbors_indicateTx() and neighbors_indicateRx() for a single neighbor
+and checks the estimate against the EWMA computed by hand:
+- the seed from the RSSI and the ETX_FRESH_ALPHA weight of the first samples
+- the ETX_ALPHA weight once the link is no longer fresh
+- the RSSI of received packets raising the estimate, never lowering it
+- the link metric going to 65535 after ETX_MAX_NOACK unacknowledged packets,
+  and back after an ACK
+- the MINIMAL_NUM_TX gate on the rank through the neighbor
+
+neighbors.c is included to reach its neighbors_vars, and linked with
+--gc-sections. The few functions of the rest of the stack it still calls are
+stubbed below:
+   scons board=python toolchain=gcc test_neighbors_etx
+*/
+
+#include "stdio.h"
+
+// the module under test, its neighbors_vars are checked
+#include "neighbors.c"
+
+//=========================== defines =========================================
+
+#define TEST_STRONG_RSSI     -60
+#define TEST_WEAK_RSSI       -90
+
+//=========================== variables =======================================
+
+typedef struct {
+    open_addr_t neighbor;
+    asn_t       asn;
+    uint8_t     numFailed;
+} test_vars_t;
+
+test_vars_t test_vars;
+
+//=========================== prototypes ======================================
+
+static void     test_check(bool condition, const char *description);
+static uint16_t test_ewma(uint16_t etx, uint16_t sample, uint8_t alpha);
+static void     test_tx(uint8_t numTxAttempts, bool was_finally_acked);
+static void     test_rx(int8_t rssi);
+
+//=========================== main ============================================
+
+int main(void) {
+    uint16_t expected;
+    uint8_t  i;
+
+    memset(&test_vars, 0, sizeof(test_vars_t));
+    test_vars.neighbor.type = ADDR_64B;
+    memcpy(test_vars.neighbor.addr_64b, "\x14\x15\x92\x00\x00\x00\x00\x01", LENGTH_ADDR64b);
+
+    neighbors_init();
+    test_rx(TEST_STRONG_RSSI);
+    test_check(neighbors_vars.neighbors[0].used == TRUE, "neighbor registered");
+
+    // seeded from the RSSI, then weighted with ETX_FRESH_ALPHA
+    expected = ETX_STRONG_RSSI * ETX_DIVISOR;
+    test_check(
+            neighbors_getLinkMetric(0) == (3 * ETX_STRONG_RSSI - 2) * MINHOPRANKINCREASE,
+            "fresh link metric seeded from the RSSI"
+    );
+    for (i = 0; i < ETX_FRESH_SAMPLES; i++) {
+        test_tx(1, TRUE);
+        expected = test_ewma(expected, ETX_DIVISOR, ETX_FRESH_ALPHA);
+        test_check(neighbors_vars.linkEstimates[0].etx == expected, "fresh samples weighted with ETX_FRESH_ALPHA");
+    }
+
+    // then weighted with ETX_ALPHA
+    test_tx(3, TRUE);
+    expected = test_ewma(expected, 3 * ETX_DIVISOR, ETX_ALPHA);
+    test_check(neighbors_vars.linkEstimates[0].etx == expected, "later samples weighted with ETX_ALPHA");
+    test_check(
+            neighbors_getLinkMetric(0) == ((3 * (uint32_t) expected - 2 * ETX_DIVISOR) * MINHOPRANKINCREASE) / ETX_DIVISOR,
+            "link metric is OF0 of the estimate"
+    );
+
+    // a strong signal does not lower the estimate, a weak one raises it
+    test_rx(TEST_STRONG_RSSI);
+    test_check(neighbors_vars.linkEstimates[0].etx == expected, "strong RSSI leaves the estimate");
+    test_rx(TEST_WEAK_RSSI);
+    expected = test_ewma(expected, DEFAULTLINKCOST * ETX_DIVISOR, ETX_RSSI_ALPHA);
+    test_check(neighbors_vars.linkEstimates[0].etx == expected, "weak RSSI raises the estimate");
+
+    // the link cost is infinite after ETX_MAX_NOACK packets in a row were lost
+    test_check(neighbors_reachedMinimalTransmission(0) == FALSE, "no rank before MINIMAL_NUM_TX");
+    for (i = 0; i < ETX_MAX_NOACK; i++) {
+        test_check(neighbors_getLinkMetric(0) < 65535, "link usable before ETX_MAX_NOACK losses");
+        test_tx(2, FALSE);
+        expected = test_ewma(expected, ETX_NOACK_PENALTY * ETX_DIVISOR, ETX_ALPHA);
+        test_check(neighbors_vars.linkEstimates[0].etx == expected, "lost packet counted as ETX_NOACK_PENALTY");
+    }
+    test_check(neighbors_getLinkMetric(0) == 65535, "link unusable after ETX_MAX_NOACK losses");
+    test_check(neighbors_reachedMinimalTransmission(0) == TRUE, "dead link ranked before MINIMAL_NUM_TX");
+
+    // an ACK makes the link usable again, the rank then waits for MINIMAL_NUM_TX
+    while (neighbors_vars.neighbors[0].numTx < MINIMAL_NUM_TX) {
+        test_tx(1, TRUE);
+    }
+    test_check(neighbors_getLinkMetric(0) < 65535, "link usable again after an ACK");
+    test_check(neighbors_reachedMinimalTransmission(0) == FALSE, "no rank at MINIMAL_NUM_TX");
+    test_tx(1, TRUE);
+    test_check(neighbors_reachedMinimalTransmission(0) == TRUE, "rank used after MINIMAL_NUM_TX");
+
+    if (test_vars.numFailed > 0) {
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
+
+//=========================== private =========================================
+
+static void test_check(bool condition, const char *description) {
+    if (condition == FALSE) {
+        printf("failed: %s\n", description);
+        test_vars.numFailed++;
+    }
+}
+
+/**
+\brief The EWMA of neighbors.c, in 1/ETX_DIVISOR.
+*/
+static uint16_t test_ewma(uint16_t etx, uint16_t sample, uint8_t alpha) {
+    return (uint16_t)(((uint32_t) etx * alpha + (uint32_t) sample * (100 - alpha)) / 100);
+}
+
+static void test_tx(uint8_t numTxAttempts, bool was_finally_acked) {
+    neighbors_indicateTx(&test_vars.neighbor, numTxAttempts, TRUE, was_finally_acked, &test_vars.asn);
+}
+
+static void test_rx(int8_t rssi) {
+    neighbors_indicateRx(&test_vars.neighbor, rssi, &test_vars.asn, FALSE, 0, FALSE);
+}
+
+//=========================== stubs ===========================================
+
+bool packetfunctions_isBroadcastMulticast(open_addr_t *address) {
+    return FALSE;
+}
+
+bool packetfunctions_sameAddress(open_addr_t *address_1, open_addr_t *address_2) {
+    return memcmp(address_1, address_2, sizeof(open_addr_t)) == 0;
+}
+
+void icmpv6rpl_updateCandidateParent(uint8_t index) {
+}
+
+void icmpv6rpl_indicateNeighborUpdate(uint8_t index) {
+}
+
+void openqueue_indicateNeighborAdded(uint8_t index) {
+}
+
+owerror_t openserial_printLog(
+        uint8_t log_level,
+        uint8_t calling_component,
+        uint8_t error_code,
+        errorparameter_t arg1,
+        errorparameter_t arg2
+) {
+    printf("log: component %d, error %d (%d, %d)\n", calling_component, error_code, arg1, arg2);
+    return E_SUCCESS;
+}